@@ -0,0 +1,83 @@
+/*
+ * Replay HAL for the protocol benchmarks.
+ *
+ * Implements the sensirion_i2c_hal API without touching /dev/i2c-*:
+ * reads are served round-robin from a pool of pre-built frames and
+ * writes are only counted, so the benchmark measures the protocol layer
+ * and nothing else.
+ */
+#include "bench_hal.h"
+#include "sensirion_i2c_hal.h"
+
+#include <string.h>
+#include <time.h>
+
+static const uint8_t* pool;
+static size_t pool_frame_len;
+static size_t pool_frames;
+static size_t cursor;
+
+uint64_t bench_hal_bytes_written;
+
+void bench_hal_load(const uint8_t* frames, size_t frame_len, size_t count) {
+    pool = frames;
+    pool_frame_len = frame_len;
+    pool_frames = count;
+    cursor = 0;
+}
+
+void sensirion_i2c_hal_init(void) {
+}
+
+void sensirion_i2c_hal_sleep_usec(uint32_t useconds) {
+    (void)useconds;
+}
+
+uint64_t sensirion_i2c_hal_get_time_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+int8_t sensirion_i2c_hal_write(uint8_t address, const uint8_t* data,
+                               uint16_t count) {
+    (void)address;
+    (void)data;
+    bench_hal_bytes_written += count;
+    return 0;
+}
+
+int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
+    (void)address;
+    if (!pool || count > pool_frame_len) return -1;
+    memcpy(data, pool + cursor * pool_frame_len, count);
+    if (++cursor == pool_frames) cursor = 0;
+    return 0;
+}
+
+/* Single replay pool; the bus handle is ignored. */
+int8_t sensirion_i2c_hal_write_fd(int fd, uint8_t address, const uint8_t* data,
+                                  uint16_t count) {
+    (void)fd;
+    return sensirion_i2c_hal_write(address, data, count);
+}
+
+int8_t sensirion_i2c_hal_read_fd(int fd, uint8_t address, uint8_t* data,
+                                 uint16_t count) {
+    (void)fd;
+    return sensirion_i2c_hal_read(address, data, count);
+}
+
+int8_t sensirion_i2c_hal_transfer_fd(int fd, sensirion_i2c_hal_msg_t* msgs,
+                                     uint16_t count) {
+    (void)fd;
+    for (uint16_t i = 0; i < count; i++) {
+        sensirion_i2c_hal_msg_t* m = &msgs[i];
+        int8_t err = m->read
+                         ? sensirion_i2c_hal_read(m->address, m->data, m->count)
+                         : sensirion_i2c_hal_write(m->address, m->data,
+                                                   m->count);
+        if (err) return err;
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef BENCH_HAL_H
+#define BENCH_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Serve sensirion_i2c_hal_read() from count frames of frame_len bytes,
+ * cycling. The buffer must outlive the benchmark. */
+void bench_hal_load(const uint8_t* frames, size_t frame_len, size_t count);
+
+/* Bytes passed to sensirion_i2c_hal_write() so far. */
+extern uint64_t bench_hal_bytes_written;
+
+#endif
@@ -0,0 +1,353 @@
+/*
+ * Acquisition load test against the simulated I2C bus.
+ *
+ * Puts the default sensor set on each of N virtual buses, opens each bus
+ * and drives one driver instance per sensor through data-ready + read
+ * sweeps in simulated time, with optional transfer latency and injected
+ * NACK/CRC faults. Reports how many samples came back, what the drivers
+ * flagged, and the host cost per sample.
+ *
+ * With -B the sweep is batched instead: every device on every bus gets
+ * its command, the longest execution time is waited out once, and each
+ * bus's answers come back in one sensirion_i2c_read_data_batch_fd() call.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "i2c_mock.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sensirion_i2c_hal.h"
+#include "scd30_i2c.h"
+#include "sen44_i2c.h"
+#include "sen5x_i2c.h"
+#include "sen66_i2c.h"
+#include "sfa3x_i2c.h"
+
+#define DEFAULT_BUSES 250
+#define DEFAULT_SECONDS 60
+#define SWEEP_USEC 1000000
+
+typedef struct {
+    uint64_t samples;
+    uint64_t not_ready;
+    uint64_t crc_errors;
+    uint64_t bus_errors;
+} load_counts_t;
+
+static void count(load_counts_t* c, int16_t err) {
+    if (err == NO_ERROR) c->samples++;
+    else if (err == CRC_ERROR) c->crc_errors++;
+    else c->bus_errors++;
+}
+
+typedef struct {
+    scd30_dev_t scd30;
+    sen44_dev_t sen44;
+    sen5x_dev_t sen5x;
+    sen66_dev_t sen66;
+    sfa3x_dev_t sfa3x;
+} bus_devs_t;
+
+/* SEN44 and SEN5x share 0x69, so odd buses carry a SEN44 instead. */
+static void populate(unsigned buses) {
+    for (unsigned b = 0; b < buses; b++) {
+        i2c_mock_add_sensor(b, SCD30_I2C_ADDR_61, I2C_MOCK_SCD30);
+        i2c_mock_add_sensor(b, 0x69, b & 1 ? I2C_MOCK_SEN44 : I2C_MOCK_SEN5X);
+        i2c_mock_add_sensor(b, SEN66_I2C_ADDR_6B, I2C_MOCK_SEN66);
+        i2c_mock_add_sensor(b, SFA3X_I2C_ADDR_5D, I2C_MOCK_SFA3X);
+    }
+}
+
+static int start_all(bus_devs_t* devs, unsigned buses) {
+    for (unsigned b = 0; b < buses; b++) {
+        bus_devs_t* d = &devs[b];
+        int fd = sensirion_i2c_hal_open_bus(b);
+        if (fd < 0) return -1;
+
+        scd30_dev_init(&d->scd30, fd, SCD30_I2C_ADDR_61);
+        sen44_dev_init(&d->sen44, fd, 0x69);
+        sen5x_dev_init(&d->sen5x, fd, 0x69);
+        sen66_dev_init(&d->sen66, fd, SEN66_I2C_ADDR_6B);
+        sfa3x_dev_init(&d->sfa3x, fd, SFA3X_I2C_ADDR_5D);
+
+        scd30_dev_start_periodic_measurement(&d->scd30, 0);
+        if (b & 1) sen44_dev_start_measurement(&d->sen44);
+        else sen5x_dev_start_measurement(&d->sen5x);
+        sen66_dev_start_continuous_measurement(&d->sen66);
+        sfa3x_dev_start_continuous_measurement(&d->sfa3x);
+    }
+    return 0;
+}
+
+static void sweep_bus(bus_devs_t* d, unsigned b, load_counts_t* c) {
+    uint16_t ready16;
+    bool ready;
+    uint8_t padding;
+    int16_t err = scd30_dev_get_data_ready(&d->scd30, &ready16);
+    if (err != NO_ERROR) {
+        count(c, err);
+    } else if (!ready16) {
+        c->not_ready++;
+    } else {
+        float co2, t, rh;
+        count(c, scd30_dev_read_measurement_data(&d->scd30, &co2, &t, &rh));
+    }
+
+    if (b & 1) {
+        int16_t voc, rh, t;
+        uint16_t pm1, pm25, pm4, pm10;
+        err = sen44_dev_read_data_ready(&d->sen44, &ready);
+        if (err != NO_ERROR) count(c, err);
+        else if (!ready) c->not_ready++;
+        else
+            count(c, sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+                         &d->sen44, &pm1, &pm25, &pm4, &pm10, &voc, &rh, &t));
+    } else {
+        uint16_t pm1, pm25, pm4, pm10;
+        int16_t rh, t, voc, nox;
+        err = sen5x_dev_read_data_ready(&d->sen5x, &ready);
+        if (err != NO_ERROR) count(c, err);
+        else if (!ready) c->not_ready++;
+        else
+            count(c, sen5x_dev_read_measured_values_as_integers(
+                         &d->sen5x, &pm1, &pm25, &pm4, &pm10, &rh, &t, &voc,
+                         &nox));
+    }
+
+    err = sen66_dev_get_data_ready(&d->sen66, &padding, &ready);
+    if (err != NO_ERROR) {
+        count(c, err);
+    } else if (!ready) {
+        c->not_ready++;
+    } else {
+        uint16_t pm1, pm25, pm4, pm10, co2;
+        int16_t rh, t, voc, nox;
+        count(c, sen66_dev_read_measured_values_as_integers(
+                     &d->sen66, &pm1, &pm25, &pm4, &pm10, &rh, &t, &voc, &nox,
+                     &co2));
+    }
+
+    int16_t hcho, rh, t;
+    count(c, sfa3x_dev_read_measured_values_as_integers(&d->sfa3x, &hcho, &rh,
+                                                         &t));
+}
+
+/* ---------- Batched sweep (-B) ---------- */
+
+#define BATCH_DEVS 4
+#define BATCH_WORDS 9  /* SEN66 values, the longest answer */
+
+/* What the drivers send, per bus slot. ready_cmd 0: no data-ready flag,
+ * read every sweep. The flag is the low byte of the answer on all four. */
+typedef struct {
+    uint8_t address;
+    uint16_t ready_cmd;
+    uint32_t ready_usec;
+    uint16_t read_cmd;
+    uint16_t read_len;
+    uint32_t read_usec;
+} batch_dev_t;
+
+static const batch_dev_t batch_devs[2][BATCH_DEVS] = {
+    {
+        {SCD30_I2C_ADDR_61, 0x202, 10000, 0x300, 12, 10000},
+        {0x69, 0x202, 20000, 0x3C4, 16, 20000}, /* SEN5x */
+        {SEN66_I2C_ADDR_6B, 0x202, 20000, 0x300, 18, 20000},
+        {SFA3X_I2C_ADDR_5D, 0, 0, 0x327, 6, 5000},
+    },
+    {
+        {SCD30_I2C_ADDR_61, 0x202, 10000, 0x300, 12, 10000},
+        {0x69, 0x202, 5000, 0x374, 14, 10000}, /* SEN44 */
+        {SEN66_I2C_ADDR_6B, 0x202, 20000, 0x300, 18, 20000},
+        {SFA3X_I2C_ADDR_5D, 0, 0, 0x327, 6, 5000},
+    },
+};
+
+typedef struct {
+    int fd;
+    uint8_t buf[BATCH_DEVS][BATCH_WORDS * 3];
+    sensirion_i2c_read_req_t reqs[BATCH_DEVS];
+    uint8_t slot[BATCH_DEVS];
+    uint16_t n;
+    bool read[BATCH_DEVS];  /* due for a values read this sweep */
+} batch_bus_t;
+
+/* Send cmd to slot i of bus b and queue a read of len bytes. Returns the
+ * command's execution time, or 0 if the write failed. */
+static uint32_t batch_send(batch_bus_t* bb, unsigned b, unsigned i,
+                           uint16_t cmd, uint16_t len, uint32_t usec,
+                           load_counts_t* c) {
+    const batch_dev_t* dev = &batch_devs[b & 1][i];
+    uint16_t off = sensirion_i2c_add_command16_to_buffer(bb->buf[i], 0, cmd);
+    int16_t err = sensirion_i2c_write_data_fd(bb->fd, dev->address, bb->buf[i], off);
+    if (err != NO_ERROR) {
+        count(c, err);
+        return 0;
+    }
+    bb->reqs[bb->n] = (sensirion_i2c_read_req_t){
+        .address = dev->address,
+        .buffer = bb->buf[i],
+        .expected_data_length = len,
+    };
+    bb->slot[bb->n++] = (uint8_t)i;
+    return usec;
+}
+
+static void sweep_batched(batch_bus_t* bbs, unsigned buses, load_counts_t* c) {
+    uint32_t wait = 0;
+
+    /* data-ready flags */
+    for (unsigned b = 0; b < buses; b++) {
+        batch_bus_t* bb = &bbs[b];
+        bb->n = 0;
+        for (unsigned i = 0; i < BATCH_DEVS; i++) {
+            const batch_dev_t* dev = &batch_devs[b & 1][i];
+            bb->read[i] = dev->ready_cmd == 0;
+            if (bb->read[i]) continue;
+            uint32_t usec = batch_send(bb, b, i, dev->ready_cmd, 2, dev->ready_usec, c);
+            if (usec > wait) wait = usec;
+        }
+    }
+    sensirion_i2c_hal_sleep_usec(wait);
+    for (unsigned b = 0; b < buses; b++) {
+        batch_bus_t* bb = &bbs[b];
+        sensirion_i2c_read_data_batch_fd(bb->fd, bb->reqs, bb->n);
+        for (unsigned k = 0; k < bb->n; k++) {
+            if (bb->reqs[k].error != NO_ERROR) count(c, bb->reqs[k].error);
+            else if (!bb->reqs[k].buffer[1]) c->not_ready++;
+            else bb->read[bb->slot[k]] = true;
+        }
+    }
+
+    /* values of the devices that have them */
+    wait = 0;
+    for (unsigned b = 0; b < buses; b++) {
+        batch_bus_t* bb = &bbs[b];
+        bb->n = 0;
+        for (unsigned i = 0; i < BATCH_DEVS; i++) {
+            const batch_dev_t* dev = &batch_devs[b & 1][i];
+            if (!bb->read[i]) continue;
+            uint32_t usec = batch_send(bb, b, i, dev->read_cmd, dev->read_len,
+                                       dev->read_usec, c);
+            if (usec > wait) wait = usec;
+        }
+    }
+    sensirion_i2c_hal_sleep_usec(wait);
+    for (unsigned b = 0; b < buses; b++) {
+        batch_bus_t* bb = &bbs[b];
+        sensirion_i2c_read_data_batch_fd(bb->fd, bb->reqs, bb->n);
+        for (unsigned k = 0; k < bb->n; k++) count(c, bb->reqs[k].error);
+    }
+}
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [-b buses] [-s seconds] [-l latency_us] "
+            "[-e nack_ppm] [-c crc_ppm] [-B]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    unsigned buses = DEFAULT_BUSES;
+    unsigned seconds = DEFAULT_SECONDS;
+    int batched = 0;
+    i2c_mock_config_t cfg = {.seed = 1, .virtual_time = 1};
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:s:l:e:c:Bh")) != -1) {
+        switch (opt) {
+        case 'b':
+            buses = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            seconds = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            cfg.latency_usec = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'e':
+            cfg.nack_ppm = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            cfg.crc_ppm = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'B':
+            batched = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (buses == 0) buses = DEFAULT_BUSES;
+
+    i2c_mock_configure(&cfg);
+    populate(buses);
+    sensirion_i2c_hal_init();
+
+    bus_devs_t* devs = calloc(buses, sizeof(*devs));
+    if (!devs || start_all(devs, buses) < 0) {
+        fprintf(stderr, "cannot set up %u buses\n", buses);
+        return 1;
+    }
+    batch_bus_t* bbs = NULL;
+    if (batched) {
+        bbs = calloc(buses, sizeof(*bbs));
+        if (!bbs) {
+            fprintf(stderr, "cannot set up %u buses\n", buses);
+            return 1;
+        }
+        for (unsigned b = 0; b < buses; b++) bbs[b].fd = devs[b].scd30.fd;
+    }
+
+    load_counts_t c = {0};
+    uint64_t t0 = host_ns();
+    uint64_t end = sensirion_i2c_hal_get_time_usec() + (uint64_t)seconds * 1000000;
+    unsigned sweeps = 0;
+    uint64_t bus_usec = 0;
+
+    while (sensirion_i2c_hal_get_time_usec() < end) {
+        uint64_t sweep_start = sensirion_i2c_hal_get_time_usec();
+        if (batched) sweep_batched(bbs, buses, &c);
+        else
+            for (unsigned b = 0; b < buses; b++) sweep_bus(&devs[b], b, &c);
+        sweeps++;
+
+        uint64_t spent = sensirion_i2c_hal_get_time_usec() - sweep_start;
+        bus_usec += spent;
+        if (spent < SWEEP_USEC) sensirion_i2c_hal_sleep_usec(SWEEP_USEC - spent);
+    }
+    uint64_t dt = host_ns() - t0;
+
+    i2c_mock_stats_t st;
+    i2c_mock_get_stats(&st);
+
+    printf("%u sensors on %u buses, %u %ssweeps over %u simulated s\n",
+           buses * 4, buses, sweeps, batched ? "batched " : "", seconds);
+    printf("simulated bus time per sweep %.1f ms (driver command delays)\n",
+           sweeps ? bus_usec / 1000.0 / sweeps : 0.0);
+    printf("samples %llu, not ready %llu, crc errors %llu, bus errors %llu\n",
+           (unsigned long long)c.samples, (unsigned long long)c.not_ready,
+           (unsigned long long)c.crc_errors, (unsigned long long)c.bus_errors);
+    printf("injected: %llu nacks, %llu bad crc words; %llu transfers, "
+           "%llu bytes\n",
+           (unsigned long long)st.nacks, (unsigned long long)st.crc_faults,
+           (unsigned long long)(st.writes + st.reads),
+           (unsigned long long)st.bytes);
+    printf("host time %.3f s, %.0f ns per sample\n", dt / 1e9,
+           c.samples ? (double)dt / (double)c.samples : 0.0);
+    free(bbs);
+    free(devs);
+    return 0;
+}
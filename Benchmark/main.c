@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#include "bench_hal.h"
+#include "influx_line.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sample_ring.h"
+
+/* Synthetic inputs are drawn from small pools that stay in cache, so the
+ * numbers reflect the code rather than memory bandwidth. */
+#define POOL_SIZE      4096
+#define POOL_MASK      (POOL_SIZE - 1)
+#define FRAME_FLOATS   3                          /* SCD30 measurement */
+#define FRAME_DATA     (FRAME_FLOATS * 4)
+#define FRAME_WIRE     (FRAME_FLOATS * 6)
+#define DEFAULT_OPS    4000000ULL
+#define DEFAULT_OUTPUT "bench-results.json"
+#define RING_SAMPLES   (1u << 16)                 /* ~18 h at 1 Hz */
+
+typedef struct {
+    const char* name;
+    size_t bytes_per_op;    /* wire/payload bytes handled per op; 0: run()
+                               returns the bytes it produced */
+    uint32_t (*run)(uint64_t ops);
+} bench_t;
+
+typedef struct {
+    const char* name;
+    uint64_t ops;
+    double ns_per_op;
+    double bytes_per_sec;
+} bench_result_t;
+
+static uint8_t words[POOL_SIZE * SENSIRION_WORD_SIZE];
+static float floats[POOL_SIZE];
+static uint8_t frames[POOL_SIZE * FRAME_WIRE];
+static sample_ring_t ring;
+static volatile uint32_t sink;
+
+/* ---------- Input generation ---------- */
+
+static uint32_t xorshift32(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static void build_pools(void) {
+    uint32_t seed = 0x5EED1234u;
+
+    for (size_t i = 0; i < sizeof(words); i++)
+        words[i] = (uint8_t)xorshift32(&seed);
+
+    /* plausible sensor range: 0..5000 */
+    for (size_t i = 0; i < POOL_SIZE; i++)
+        floats[i] = (float)(xorshift32(&seed) % 5000000u) / 1000.0f;
+
+    for (size_t f = 0; f < POOL_SIZE; f++) {
+        uint16_t off = 0;
+        for (int k = 0; k < FRAME_FLOATS; k++)
+            off = sensirion_i2c_add_float_to_buffer(
+                &frames[f * FRAME_WIRE], off, floats[(f * 7 + k) & POOL_MASK]);
+    }
+    bench_hal_load(frames, FRAME_WIRE, POOL_SIZE);
+
+    for (uint32_t i = 0; i < RING_SAMPLES; i++)
+        sample_ring_append(&ring, (uint64_t)i * 1000000, (uint16_t)i, SAMPLE_OK);
+}
+
+/* ---------- Benchmarks ---------- */
+
+static uint32_t run_crc_bitwise(uint64_t ops) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < ops; i++)
+        acc += sensirion_i2c_generate_crc_bitwise(
+            &words[(i & POOL_MASK) * SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    return acc;
+}
+
+static uint32_t run_crc_table(uint64_t ops) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < ops; i++)
+        acc += sensirion_i2c_generate_crc(
+            &words[(i & POOL_MASK) * SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    return acc;
+}
+
+static uint32_t run_crc_word(uint64_t ops) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < ops; i++)
+        acc += sensirion_i2c_generate_crc_word(
+            &words[(i & POOL_MASK) * SENSIRION_WORD_SIZE]);
+    return acc;
+}
+
+static uint32_t run_add_float(uint64_t ops) {
+    uint8_t buf[6];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        sensirion_i2c_add_float_to_buffer(buf, 0, floats[i & POOL_MASK]);
+        acc += buf[2] ^ buf[5];
+    }
+    return acc;
+}
+
+static uint32_t run_read_inplace(uint64_t ops) {
+    uint8_t buf[FRAME_WIRE];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        if (sensirion_i2c_read_data_inplace(0x61, buf, FRAME_DATA) != NO_ERROR)
+            return 0;
+        acc += buf[0];
+    }
+    return acc;
+}
+
+static uint32_t run_bytes_to_float(uint64_t ops) {
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < ops; i++)
+        acc += sensirion_common_bytes_to_float(
+            &words[(i & (POOL_MASK >> 1)) * 4]);
+    return (uint32_t)acc;
+}
+
+static uint32_t run_ring_append(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++)
+        sample_ring_append(&ring, i * 1000000, (uint16_t)floats[i & POOL_MASK],
+                           SAMPLE_OK);
+    return ring.raw[0];
+}
+
+/* One op is one sample read back through a zero-copy window. */
+static uint32_t run_ring_scan(uint64_t ops) {
+    uint32_t acc = 0;
+    while (ops > 0) {
+        uint32_t n = ops < RING_SAMPLES ? (uint32_t)ops : RING_SAMPLES;
+        sample_span_t spans[2];
+        unsigned k = sample_ring_last(&ring, n, spans);
+        for (unsigned j = 0; j < k; j++)
+            for (uint32_t i = 0; i < spans[j].len; i++) acc += spans[j].raw[i];
+        ops -= n;
+    }
+    return acc;
+}
+
+/* A SEN66 sample as line protocol, the way the Influx apps used to build
+ * it (ticks scaled to float, %.2f per field) and with the encoder. Both
+ * return the bytes produced. */
+#define LP_TS 1792268907259ULL
+
+static uint32_t run_lp_snprintf(uint64_t ops) {
+    char line[512];
+    uint32_t bytes = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        const uint8_t* w = &words[(i & (POOL_MASK >> 3)) * 16];
+        int n = snprintf(line, sizeof(line),
+                         "sen66 pm1=%.2f,pm2_5=%.2f,pm4=%.2f,pm10=%.2f,"
+                         "humidity=%.2f,temperature=%.2f,voc=%.2f,nox=%.2f,"
+                         "co2=%u %llu",
+                         w[0] / 10.0f, w[1] / 10.0f, w[2] / 10.0f,
+                         w[3] / 10.0f, (w[4] * 40) / 100.0f,
+                         (int16_t)(w[5] * 20 - 2000) / 200.0f, w[6] / 10.0f,
+                         w[7] / 10.0f, (unsigned)(w[8] * 4),
+                         LP_TS + i);
+        bytes += (uint32_t)n;
+    }
+    return bytes;
+}
+
+static uint32_t run_lp_encoder(uint64_t ops) {
+    static const char* const fields[] = {"pm1", "pm2_5", "pm4", "pm10",
+                                         "humidity", "temperature", "voc",
+                                         "nox", "co2"};
+    static const uint16_t scale[] = {10, 10, 10, 10, 100, 200, 10, 10, 1};
+    static const uint8_t decimals[] = {1, 1, 1, 1, 2, 2, 1, 1, 0};
+    char line[512];
+    influx_line_t lp;
+    uint32_t bytes = 0;
+
+    influx_line_init(&lp, line, sizeof(line));
+    for (uint64_t i = 0; i < ops; i++) {
+        const uint8_t* w = &words[(i & (POOL_MASK >> 3)) * 16];
+        int32_t v[9] = {w[0], w[1], w[2], w[3], w[4] * 40,
+                        w[5] * 20 - 2000, w[6], w[7], w[8] * 4};
+        influx_line_reset(&lp);
+        influx_line_begin(&lp, "sen66");
+        for (int k = 0; k < 9; k++)
+            influx_line_field_fixed(&lp, fields[k], v[k], scale[k], decimals[k]);
+        influx_line_end(&lp, LP_TS + i);
+        bytes += (uint32_t)lp.len;
+    }
+    return bytes;
+}
+
+static const bench_t benches[] = {
+    {"crc8_bitwise", SENSIRION_WORD_SIZE, run_crc_bitwise},
+    {"crc8_table", SENSIRION_WORD_SIZE, run_crc_table},
+    {"crc8_word", SENSIRION_WORD_SIZE, run_crc_word},
+    {"add_float_to_buffer", 6, run_add_float},
+    {"read_data_inplace", FRAME_WIRE, run_read_inplace},
+    {"bytes_to_float", 4, run_bytes_to_float},
+    {"ring_append", 11, run_ring_append},
+    {"ring_scan", 2, run_ring_scan},
+    {"lp_snprintf", 0, run_lp_snprintf},
+    {"lp_encoder", 0, run_lp_encoder},
+};
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+/* ---------- Timing / output ---------- */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void run_bench(const bench_t* b, uint64_t ops, bench_result_t* r) {
+    sink = b->run(ops / 16);  /* warm-up */
+
+    uint64_t t0 = now_ns();
+    uint32_t produced = b->run(ops);
+    uint64_t dt = now_ns() - t0;
+    if (dt == 0) dt = 1;
+    sink = produced;
+    double bytes = b->bytes_per_op ? (double)b->bytes_per_op * (double)ops
+                                   : (double)produced;
+
+    r->name = b->name;
+    r->ops = ops;
+    r->ns_per_op = (double)dt / (double)ops;
+    r->bytes_per_sec = bytes * 1e9 / (double)dt;
+}
+
+static int write_json(const char* path, const bench_result_t* res, size_t n,
+                      uint64_t ops) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror("bench output");
+        return -1;
+    }
+
+    struct utsname u;
+    uname(&u);
+    fprintf(f, "{\n  \"host\": \"%s\",\n  \"machine\": \"%s\",\n", u.nodename,
+            u.machine);
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "  \"timestamp\": %lld,\n  \"ops\": %llu,\n",
+            (long long)time(NULL), (unsigned long long)ops);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(f,
+                "    {\"name\": \"%s\", \"ns_per_op\": %.3f, "
+                "\"bytes_per_sec\": %.0f}%s\n",
+                res[i].name, res[i].ns_per_op, res[i].bytes_per_sec,
+                i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-n ops] [-o results.json] [filter]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    uint64_t ops = DEFAULT_OPS;
+    const char* out = DEFAULT_OUTPUT;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:o:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            ops = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    const char* filter = optind < argc ? argv[optind] : NULL;
+    if (ops == 0) ops = DEFAULT_OPS;
+
+    if (sensirion_i2c_crc_self_test() != NO_ERROR) {
+        fprintf(stderr, "CRC self-test failed, not benchmarking\n");
+        return 1;
+    }
+    if (sample_ring_init(&ring, RING_SAMPLES, NULL) != 0) {
+        perror("sample ring");
+        return 1;
+    }
+    build_pools();
+
+    bench_result_t results[NUM_BENCHES];
+    size_t n = 0;
+
+    printf("%-22s %12s %14s\n", "benchmark", "ns/op", "MB/s");
+    for (size_t i = 0; i < NUM_BENCHES; i++) {
+        if (filter && !strstr(benches[i].name, filter)) continue;
+        run_bench(&benches[i], ops, &results[n]);
+        printf("%-22s %12.2f %14.1f\n", results[n].name, results[n].ns_per_op,
+               results[n].bytes_per_sec / 1e6);
+        n++;
+    }
+
+    if (write_json(out, results, n, ops) != 0) return 1;
+    printf("Results written to %s\n", out);
+    return 0;
+}
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+#Checking for Updates and installing Essential tools
+sudo apt update -y
+sudo apt install build-essential libcurl4-openssl-dev zlib1g-dev -y
+
+#Running Makefile
+make clean
+make
+
@@ -0,0 +1,397 @@
+/*
+ * Acquisition daemon: one process owns the bus, reads each sensor once
+ * per sample period and fans every sample out to the enabled sinks
+ * (InfluxDB v2, InfluxDB 1.8, Meshtastic, stdout, anomaly alarms, local
+ * history files). Each sink queues and batches on its own, so a slow
+ * radio or a down influxd never holds up the others. The sample history
+ * and the anomaly detectors live in a ring file, so a restart resumes
+ * where the last run stopped.
+ *
+ *   sensors-daemon [-s influx2,influx1,mesh,stdout,anomaly,tsdb] [-p mesh-serial-port] [-t]
+ *                  [-r ring-file | -n]
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "anomaly_sink.h"
+#include "influx_sink.h"
+#include "mesh_sink.h"
+#include "ring_file.h"
+#include "sample_ring.h"
+#include "sample_sink.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c_hal.h"
+#include "sfa3x_i2c.h"
+#include "scd30_i2c.h"
+#include "sen44_i2c.h"
+#include "sen66_i2c.h"
+#include "sen5x_i2c.h"
+#include "event_loop.h"
+#include "sensor_bringup.h"
+#include "sensor_sched.h"
+#include "sensor_ticks.h"
+#include "tsdb_sink.h"
+
+/* Sinks enabled without -s */
+#define DEFAULT_SINKS          "influx2,stdout"
+
+/* --- InfluxDB v2 --- */
+#define INFLUX2_URL    "http://localhost:8086/api/v2/write?org=biome&bucket=sensors&precision=ms"
+#define INFLUX2_TOKEN  "HTq0xrUjYmAy5wV6lbNGWJ3Hnt_X64yIeGnkV8Eh4JoaGb4YHLbqaSIkSUrLlp1LcHroh8pY9EfDLtDjtfaTpQ=="
+#define INFLUX2_SPOOL_DIR      "sensors-daemon.influx2.spool"
+
+/* --- InfluxDB 1.8 (no auth, database=sensors) --- */
+#define INFLUX1_URL    "http://127.0.0.1:8086/write?db=sensors&precision=ms"
+#define INFLUX1_SPOOL_DIR      "sensors-daemon.influx1.spool"
+
+/* Shared by both Influx sinks: one POST per tick, see Influxdb/main.c */
+#define INFLUXDB_TICK_MS       1000
+#define INFLUXDB_BATCH_TICKS   1
+#define INFLUXDB_BATCH_BYTES   16384
+#define INFLUXDB_BATCH_AGE_MS  10000
+#define INFLUXDB_GZIP_LEVEL    6
+#define INFLUXDB_GZIP_MIN_BYTES 1024
+#define INFLUXDB_QUEUE_LINES   1024
+#define INFLUXDB_QUEUE_POLICY  INFLUX_QUEUE_SPILL
+#define INFLUXDB_SPOOL_SEGMENT (1024 * 1024)
+#define INFLUXDB_SPOOL_MAX_SEG 64
+#define INFLUXDB_SPOOL_SYNC_MS 10000
+
+/* --- Meshtastic --- */
+#define MESH_PORT              "/dev/ttyACM0"
+#define MESH_PERIOD_MS         (120 * 1000)  /* 2 minutes */
+#define MESH_QUEUE_MSGS        32
+#define MESH_KEYFRAME_EVERY    10            /* full report every 20 minutes */
+
+/* --- Anomaly alarms: per-channel baseline over ~5 minutes at 1 Hz --- */
+#define ANOMALY_ALPHA          0.003f
+#define ANOMALY_WARMUP         300
+#define ANOMALY_NOISE_TICKS    2.0f
+
+/* --- Local history: one compressed file per sensor, a block per 15 minutes --- */
+#define TSDB_DIR               "sensors-daemon.tsdb"
+#define TSDB_BLOCK_MS          (15 * 60 * 1000)
+
+/* Retry step while a sample is late, and the longest single sleep */
+#define SENSOR_POLL_MS         50
+#define SENSOR_MAX_SLEEP_MS    1000
+
+/* SEN55 temperature compensation, applied at start-up */
+#define SEN5X_TEMP_OFFSET      0.0f
+
+/* Samples kept per channel: an hour at 1 Hz. Through the ring file it
+ * also covers the tsdb block a crash loses. */
+#define SAMPLE_HISTORY         3600
+
+/* --- Ring file: the history above and the detectors, across restarts --- */
+#define RING_FILE              "sensors-daemon.ring"
+#define RING_SYNC_MS           60000             /* what a power cut can lose */
+#define RING_MAX_AGE_MS        (60 * 60 * 1000)  /* older detector state starts cold */
+
+static volatile sig_atomic_t running = 1;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+static sample_store_t store;
+static sensor_ticks_t sfa3x_ticks, scd30_ticks, sen44_ticks, sen66_ticks, sen5x_ticks;
+static sample_sink_set_t sinks;
+static influx_sink_t influx2, influx1;
+static mesh_sink_t mesh;
+static anomaly_sink_t anomalies;
+static tsdb_sink_t history;
+static ring_file_t ring;
+static const char* ring_path = RING_FILE;
+static const char* mesh_port = MESH_PORT;
+static int mesh_text;
+
+/* --- v2 bucket: field names and device tag as Influxdb/main.c writes them --- */
+static const char* const sfa3x_fields[] = {"hcho", "humidity", "temp"};
+static const char* const scd30_fields[] = {"co2", "temp", "humidity"};
+static const char* const sen44_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                           "voc", "hum", "temp"};
+static const char* const sen66_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                           "hum", "temp", "voc", "nox", "co2"};
+static const char* const sen5x_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                           "hum", "temp", "voc", "nox"};
+static const influx_sink_fields_t influx2_fields[] = {
+    {"sfa3x", sfa3x_fields}, {"scd30", scd30_fields}, {"sen44", sen44_fields},
+    {"sen66", sen66_fields}, {"sen55", sen5x_fields}, {NULL, NULL},
+};
+
+static influx_sender_config_t influx_sender_config(const char* url, const char* token,
+                                                   const char* spool_dir) {
+    influx_sender_config_t cfg = {
+        .writer = {
+            .url = url,
+            .token = token,
+            .timeout_ms = 2000L,
+            .max_bytes = INFLUXDB_BATCH_BYTES,
+            .max_ticks = INFLUXDB_BATCH_TICKS,
+            .max_age_ms = INFLUXDB_BATCH_AGE_MS,
+            .gzip_level = INFLUXDB_GZIP_LEVEL,
+            .gzip_min_bytes = INFLUXDB_GZIP_MIN_BYTES,
+        },
+        .queue_lines = INFLUXDB_QUEUE_LINES,
+        .policy = INFLUXDB_QUEUE_POLICY,
+        .spool = {
+            .dir = spool_dir,
+            .segment_bytes = INFLUXDB_SPOOL_SEGMENT,
+            .max_segments = INFLUXDB_SPOOL_MAX_SEG,
+            .sync_bytes = 64 * 1024,
+            .sync_interval_ms = INFLUXDB_SPOOL_SYNC_MS,
+            .replay_bytes = 256 * 1024,
+        },
+        .replay_batches = 4,
+    };
+    return cfg;
+}
+
+enum { SINK_INFLUX2, SINK_INFLUX1, SINK_MESH, SINK_STDOUT, SINK_ANOMALY, SINK_TSDB, SINK_COUNT };
+static const char* const sink_names[SINK_COUNT] = {"influx2", "influx1", "mesh", "stdout",
+                                                   "anomaly", "tsdb"};
+
+/* Start one sink and register it. Returns 0, or -1. */
+static int add_sink(int which) {
+    switch (which) {
+    case SINK_INFLUX2: {
+        influx_sink_config_t cfg = {
+            .sender = influx_sender_config(INFLUX2_URL, INFLUX2_TOKEN, INFLUX2_SPOOL_DIR),
+            .device_tag = "device",
+            .fields = influx2_fields,
+        };
+        if (influx_sink_start(&influx2, &cfg) != 0) return -1;
+        return sample_sink_set_add(&sinks, &influx_sink_ops, &influx2);
+    }
+    case SINK_INFLUX1: {
+        influx_sink_config_t cfg = {
+            .sender = influx_sender_config(INFLUX1_URL, NULL, INFLUX1_SPOOL_DIR),
+        };
+        if (influx_sink_start(&influx1, &cfg) != 0) return -1;
+        return sample_sink_set_add(&sinks, &influx_sink_ops, &influx1);
+    }
+    case SINK_MESH: {
+        mesh_sink_config_t cfg = {
+            .port = mesh_port,
+            .period_ms = MESH_PERIOD_MS,
+            .queue_msgs = MESH_QUEUE_MSGS,
+            .keyframe_every = MESH_KEYFRAME_EVERY,
+            .text = mesh_text,
+        };
+        if (mesh_sink_start(&mesh, &cfg) != 0) return -1;
+        return sample_sink_set_add(&sinks, &mesh_sink_ops, &mesh);
+    }
+    case SINK_ANOMALY: {
+        anomaly_sink_config_t cfg = {
+            .alpha = ANOMALY_ALPHA,
+            .warmup = ANOMALY_WARMUP,
+            .noise_ticks = ANOMALY_NOISE_TICKS,
+            .state = ring.state,
+        };
+        anomaly_sink_init(&anomalies, &cfg);
+        return sample_sink_set_add(&sinks, &anomaly_sink_ops, &anomalies);
+    }
+    case SINK_TSDB: {
+        tsdb_sink_config_t cfg = {
+            .dir = TSDB_DIR,
+            .block_ms = TSDB_BLOCK_MS,
+        };
+        if (tsdb_sink_start(&history, &cfg) != 0) return -1;
+        return sample_sink_set_add(&sinks, &tsdb_sink_ops, &history);
+    }
+    default:
+        return sample_sink_set_add(&sinks, &sample_sink_stdout_ops, NULL);
+    }
+}
+
+/* Comma-separated sink names; a repeated name is started once. */
+static int add_sinks(const char* list) {
+    char buf[128];
+    unsigned started = 0;
+    snprintf(buf, sizeof(buf), "%s", list);
+
+    char* save = NULL;
+    for (char* name = strtok_r(buf, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+        int which = 0;
+        while (which < SINK_COUNT && strcmp(name, sink_names[which]) != 0) which++;
+        if (which == SINK_COUNT) {
+            fprintf(stderr, "Unknown sink '%s'\n", name);
+            return -1;
+        }
+        if (started & (1u << which)) continue;
+        if (add_sink(which) != 0) {
+            fprintf(stderr, "Sink '%s' failed to start\n", name);
+            return -1;
+        }
+        started |= 1u << which;
+    }
+    return sinks.count ? 0 : -1;
+}
+
+/* A tick closes a second of samples on every sink */
+static void end_tick(void* ctx, uint64_t expirations) {
+    (void)ctx;
+    (void)expirations;
+    sample_sink_set_tick(&sinks);
+}
+
+/* SEN55 start step: temperature offset first, then measure */
+static int16_t start_sen5x(void* ctx) {
+    (void)ctx;
+    sen5x_set_temperature_offset_simple(SEN5X_TEMP_OFFSET);
+    return sen5x_start_measurement();
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [-s sinks] [-p port] [-t] [-r file | -n]\n"
+            "  -s  comma-separated: influx2, influx1, mesh, stdout, anomaly, tsdb\n"
+            "      (default %s)\n"
+            "  -p  serial port of the Meshtastic node (default %s)\n"
+            "  -t  mesh: a text message per sensor instead of one binary report\n"
+            "  -r  ring file for the history and detector state (default %s)\n"
+            "  -n  no ring file: start cold and keep nothing\n",
+            prog, DEFAULT_SINKS, MESH_PORT, RING_FILE);
+}
+
+int main(int argc, char** argv) {
+    const char* sink_list = DEFAULT_SINKS;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:p:tr:nh")) != -1) {
+        switch (opt) {
+        case 's': sink_list = optarg; break;
+        case 'p': mesh_port = optarg; break;
+        case 't': mesh_text = 1; break;
+        case 'r': ring_path = optarg; break;
+        case 'n': ring_path = NULL; break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    /* --- Raw-tick channels with the default field names --- */
+    sample_store_init(&store, SAMPLE_HISTORY);
+    if (sensor_ticks_add_sfa3x(&sfa3x_ticks, &store, "sfa3x", NULL, NULL) != 0 ||
+        sensor_ticks_add_scd30(&scd30_ticks, &store, "scd30", NULL, NULL) != 0 ||
+        sensor_ticks_add_sen44(&sen44_ticks, &store, "sen44", NULL, NULL) != 0 ||
+        sensor_ticks_add_sen66(&sen66_ticks, &store, "sen66", NULL, NULL) != 0 ||
+        sensor_ticks_add_sen5x(&sen5x_ticks, &store, "sen55", NULL, NULL) != 0) {
+        fprintf(stderr, "Sample store: out of memory\n");
+        return 1;
+    }
+
+    /* --- Ring file: the channels' history and the detectors from the last run --- */
+    if (ring_path) {
+        ring_file_config_t cfg = {
+            .path = ring_path,
+            .sync_ms = RING_SYNC_MS,
+            .max_age_ms = RING_MAX_AGE_MS,
+            .state_bytes = sizeof(anomaly_state_t) * SAMPLE_STORE_MAX,
+        };
+        if (ring_file_open(&ring, &cfg, &store) != 0)
+            fprintf(stderr, "%s: %s, history starts empty\n", ring_path, strerror(errno));
+        else if (ring.resumed)
+            printf("Resumed %s, saved %llu s ago, detectors %s\n", ring_path,
+                   (unsigned long long)(ring.age_ms / 1000), ring.warm ? "warm" : "cold");
+    }
+
+    /* --- Sinks, then the ring file's tick after theirs --- */
+    sample_sink_set_init(&sinks);
+    if (add_sinks(sink_list) != 0 ||
+        (ring.map && sample_sink_set_add(&sinks, &ring_file_sink_ops, &ring) != 0)) {
+        sample_sink_set_stop(&sinks);
+        ring_file_close(&ring);
+        return 1;
+    }
+    printf("Sinks:");
+    for (unsigned i = 0; i < sinks.count; i++) printf(" %s", sinks.sinks[i].ops->name);
+    printf("\n");
+
+    /* --- I2C init --- */
+    sensirion_i2c_hal_init();
+
+    /* --- Sensor bring-up: all resets at once, each sensor starts when ready --- */
+    sfa3x_init(SFA3X_I2C_ADDR_5D);
+    scd30_init(SCD30_I2C_ADDR_61);
+    sen66_init(SEN66_I2C_ADDR_6B);
+
+    sensor_bringup_t bringup;
+    sensor_bringup_init(&bringup);
+    sensor_bringup_add(&bringup, "SFA3X", sensor_bringup_sfa3x_reset,
+                       SFA3X_DEVICE_RESET_USEC, sensor_bringup_sfa3x_start, NULL);
+    sensor_bringup_add(&bringup, "SCD30", sensor_bringup_scd30_reset,
+                       SCD30_SOFT_RESET_USEC, sensor_bringup_scd30_start, NULL);
+    sensor_bringup_add(&bringup, "SEN44", sensor_bringup_sen44_reset,
+                       SEN44_DEVICE_RESET_USEC, sensor_bringup_sen44_start, NULL);
+    sensor_bringup_add(&bringup, "SEN66", sensor_bringup_sen66_reset,
+                       SEN66_DEVICE_RESET_USEC, sensor_bringup_sen66_start, NULL);
+    sensor_bringup_add(&bringup, "SEN55", sensor_bringup_sen5x_reset,
+                       SEN5X_DEVICE_RESET_USEC, start_sen5x, NULL);
+    int failed = sensor_bringup_run(&bringup);
+    if (failed) fprintf(stderr, "%d sensor(s) failed to start\n", failed);
+
+    printf("Starting multi-sensor measurement loop...\n");
+
+    /* --- Every sample goes to the sinks --- */
+    sensor_ticks_t* all[] = {&sfa3x_ticks, &scd30_ticks, &sen44_ticks, &sen66_ticks, &sen5x_ticks};
+    for (unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        all[i]->on_sample = sample_sink_set_publish;
+        all[i]->user = &sinks;
+    }
+
+    /* --- Data-ready scheduling (SFA3X has no flag, read per interval) --- */
+    sensor_sched_t sched;
+    sensor_sched_init(&sched, SENSOR_POLL_MS, SENSOR_MAX_SLEEP_MS);
+    sensor_sched_add(&sched, "SFA3X", 1000, NULL, sensor_ticks_read_sfa3x, &sfa3x_ticks);
+    sensor_sched_add(&sched, "SCD30", 2000, sensor_ticks_ready_scd30,
+                     sensor_ticks_read_scd30, &scd30_ticks);
+    sensor_sched_add(&sched, "SEN44", 1000, sensor_ticks_ready_sen44,
+                     sensor_ticks_read_sen44, &sen44_ticks);
+    sensor_sched_add(&sched, "SEN66", 1000, sensor_ticks_ready_sen66,
+                     sensor_ticks_read_sen66, &sen66_ticks);
+    sensor_sched_add(&sched, "SEN55", 1000, sensor_ticks_ready_sen5x,
+                     sensor_ticks_read_sen5x, &sen5x_ticks);
+
+    /* --- Event loop: sensor deadlines and the sink tick on absolute timers --- */
+    sample_clock_sync(&sinks.clock);
+    event_loop_t loop;
+    if (event_loop_init(&loop) != 0 || sensor_sched_attach(&sched, &loop) != 0) {
+        perror("event loop");
+        return 1;
+    }
+    int tick = event_loop_add_timer(&loop, end_tick, NULL);
+    if (tick < 0 || event_loop_arm_periodic(&loop, tick, INFLUXDB_TICK_MS * 1000ULL) != 0) {
+        perror("tick timer");
+        return 1;
+    }
+
+    int first_pending = 1;
+    while (running) {
+        event_loop_run_once(&loop, -1);
+        if (first_pending) {
+            first_pending = sensor_bringup_report(&bringup, &sched, stdout);
+        }
+    }
+    event_loop_close(&loop);
+
+    printf("Stopping measurements...\n");
+    sfa3x_stop_measurement();
+    scd30_stop_periodic_measurement();
+    sen44_stop_measurement();
+    sen66_stop_measurement();
+    sen5x_stop_measurement();
+    sample_sink_set_stop(&sinks);
+    sample_store_free(&store);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Reads the history the daemon's tsdb sink keeps (tsdb.h).
+ *
+ *   ./tsdb-query -i sensors-daemon.tsdb/sen66.tsdb        what is in it
+ *   ./tsdb-query -f -3600 sensors-daemon.tsdb/sen66.tsdb  the last hour, CSV
+ *   ./tsdb-query -s -f 1760000000 -t 1760086400 f.tsdb co2 pm2_5
+ *
+ * -f and -t are Unix seconds, or seconds before the newest row when
+ * negative. Without fields, every column is printed. CSV rows are
+ * "time,<field>,..." with the time in Unix ms and unknown values left
+ * empty; -s prints count, min, mean and max per field instead.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sample_ring.h"
+#include "tsdb.h"
+
+typedef struct {
+    const tsdb_reader_t* r;
+    unsigned fields[TSDB_MAX_COLUMNS];
+    unsigned count;
+    int summary;
+    /* -s */
+    uint64_t n[TSDB_MAX_COLUMNS];
+    int32_t min[TSDB_MAX_COLUMNS], max[TSDB_MAX_COLUMNS];
+    double sum[TSDB_MAX_COLUMNS];
+} query_t;
+
+static sample_channel_t channel_of(const tsdb_column_t* c) {
+    sample_channel_t ch = {
+        .field = c->field,
+        .scale = c->scale ? c->scale : 1,
+        .decimals = c->decimals,
+        .flags = c->flags,
+    };
+    return ch;
+}
+
+static void on_row(void* ctx, uint64_t t_ms, const uint16_t* raw) {
+    query_t* q = ctx;
+    char buf[32];
+
+    if (!q->summary) printf("%llu", (unsigned long long)t_ms);
+    for (unsigned i = 0; i < q->count; i++) {
+        unsigned c = q->fields[i];
+        sample_channel_t ch = channel_of(&q->r->column[c]);
+        int known = sample_channel_status(&ch, raw[c]) == SAMPLE_OK;
+
+        if (!q->summary) {
+            if (known) sample_channel_format(&ch, raw[c], buf, sizeof(buf));
+            printf(",%s", known ? buf : "");
+            continue;
+        }
+        if (!known) continue;
+        int32_t v = sample_channel_value(&ch, raw[c]);
+        if (q->n[i] == 0 || v < q->min[i]) q->min[i] = v;
+        if (q->n[i] == 0 || v > q->max[i]) q->max[i] = v;
+        q->sum[i] += v;
+        q->n[i]++;
+    }
+    if (!q->summary) printf("\n");
+}
+
+static void print_info(const tsdb_reader_t* r, const char* path) {
+    uint64_t first, last, rows = tsdb_reader_rows(r);
+    tsdb_reader_range(r, &first, &last);
+    printf("%s: %u blocks, %llu rows, %zu bytes (%.2f per row)\n", path, r->blocks,
+           (unsigned long long)rows, r->size, rows ? (double)r->size / (double)rows : 0.0);
+    printf("time: %llu .. %llu (%.1f days)\n", (unsigned long long)first,
+           (unsigned long long)last, (double)(last - first) / 86400000.0);
+    if (r->damaged) printf("damaged: %llu bytes skipped\n", (unsigned long long)r->damaged);
+    printf("columns:");
+    for (unsigned i = 0; i < r->columns; i++)
+        printf(" %s%s", r->column[i].field, i + 1 < r->columns ? "," : "\n");
+}
+
+/* Unix seconds, or seconds before newest_ms when negative, in ms */
+static uint64_t parse_time(const char* s, uint64_t newest_ms) {
+    long long v = strtoll(s, NULL, 10);
+    if (v >= 0) return (uint64_t)v * 1000;
+    uint64_t back = (uint64_t)(-v) * 1000;
+    return back < newest_ms ? newest_ms - back : 0;
+}
+
+int main(int argc, char** argv) {
+    const char *from_arg = NULL, *to_arg = NULL;
+    int info = 0, summary = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:ish")) != -1) {
+        switch (opt) {
+        case 'f': from_arg = optarg; break;
+        case 't': to_arg = optarg; break;
+        case 'i': info = 1; break;
+        case 's': summary = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-i] [-s] [-f from] [-t to] file.tsdb [field ...]\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "%s: no file given\n", argv[0]);
+        return 2;
+    }
+
+    const char* path = argv[optind];
+    tsdb_reader_t r;
+    if (tsdb_reader_open(&r, path) != 0) {
+        fprintf(stderr, "%s: %s\n", path, errno == EINVAL ? "not a tsdb file" : strerror(errno));
+        return 1;
+    }
+    if (info) {
+        print_info(&r, path);
+        tsdb_reader_close(&r);
+        return 0;
+    }
+
+    query_t q = {.r = &r, .summary = summary};
+    uint32_t mask = 0;
+    for (int i = optind + 1; i < argc; i++) {
+        int c = tsdb_reader_column(&r, argv[i]);
+        if (c < 0) {
+            fprintf(stderr, "%s: no field '%s'\n", path, argv[i]);
+            tsdb_reader_close(&r);
+            return 1;
+        }
+        q.fields[q.count++] = (unsigned)c;
+        mask |= 1u << c;
+        if (q.count == TSDB_MAX_COLUMNS) break;
+    }
+    if (q.count == 0) {
+        for (unsigned c = 0; c < r.columns; c++) q.fields[q.count++] = c;
+        mask = (1u << r.columns) - 1;
+    }
+
+    uint64_t first, last;
+    tsdb_reader_range(&r, &first, &last);
+    uint64_t from = from_arg ? parse_time(from_arg, last) : 0;
+    uint64_t to = to_arg ? parse_time(to_arg, last) : UINT64_MAX;
+
+    if (!summary) {
+        printf("time");
+        for (unsigned i = 0; i < q.count; i++) printf(",%s", r.column[q.fields[i]].field);
+        printf("\n");
+    }
+    uint64_t rows = tsdb_reader_scan(&r, from, to, mask, on_row, &q);
+
+    if (summary) {
+        printf("%llu rows\n", (unsigned long long)rows);
+        for (unsigned i = 0; i < q.count; i++) {
+            sample_channel_t ch = channel_of(&r.column[q.fields[i]]);
+            char lo[32], hi[32];
+            if (q.n[i] == 0) {
+                printf("%s: no values\n", ch.field);
+                continue;
+            }
+            sample_format_fixed(q.min[i], ch.scale, ch.decimals, lo, sizeof(lo));
+            sample_format_fixed(q.max[i], ch.scale, ch.decimals, hi, sizeof(hi));
+            printf("%s: %llu values, min %s, mean %.*f, max %s\n", ch.field,
+                   (unsigned long long)q.n[i], lo, ch.decimals + 1,
+                   q.sum[i] / (double)q.n[i] / ch.scale, hi);
+        }
+    }
+    if (r.damaged) fprintf(stderr, "%s: %llu damaged bytes skipped\n", path,
+                           (unsigned long long)r.damaged);
+    if (r.corrupt) fprintf(stderr, "%s: %llu corrupt blocks skipped\n", path,
+                           (unsigned long long)r.corrupt);
+    tsdb_reader_close(&r);
+    return 0;
+}
@@ -5,19 +5,58 @@
 #include <time.h>
 #include <signal.h>
 #include <curl/curl.h>
-#include <math.h> // for isnan
+#include <ctype.h>
 
+#include "influx_line.h"
+#include "influx_sender.h"
+#include "sensirion_common.h"
 #include "sensirion_i2c_hal.h"
 #include "sfa3x_i2c.h"
 #include "scd30_i2c.h"
 #include "sen44_i2c.h"
 #include "sen66_i2c.h"
 #include "sen5x_i2c.h"
+#include "event_loop.h"
+#include "sample_clock.h"
+#include "sample_ring.h"
+#include "sensor_bringup.h"
+#include "sensor_sched.h"
+#include "sensor_ticks.h"
 
 /* --- InfluxDB configuration --- */
-#define INFLUXDB_URL    "http://localhost:8086/api/v2/write?org=biome&bucket=sensors&precision=s"
+#define INFLUXDB_URL    "http://localhost:8086/api/v2/write?org=biome&bucket=sensors&precision=ms"
 #define INFLUXDB_TOKEN  "HTq0xrUjYmAy5wV6lbNGWJ3Hnt_X64yIeGnkV8Eh4JoaGb4YHLbqaSIkSUrLlp1LcHroh8pY9EfDLtDjtfaTpQ=="
 
+/* One POST per tick by default; raise BATCH_TICKS to gather several */
+#define INFLUXDB_TICK_MS       1000
+#define INFLUXDB_BATCH_TICKS   1
+#define INFLUXDB_BATCH_BYTES   16384
+#define INFLUXDB_BATCH_AGE_MS  10000
+
+/* gzip batches from this size on (0 to disable); pays off when influxd is remote */
+#define INFLUXDB_GZIP_LEVEL    6
+#define INFLUXDB_GZIP_MIN_BYTES 1024
+
+/* Lines buffered between the sensor loop and the sender thread */
+#define INFLUXDB_QUEUE_LINES   1024
+#define INFLUXDB_QUEUE_POLICY  INFLUX_QUEUE_SPILL
+
+/* Unsent batches survive influxd restarts here (relative to WorkingDirectory) */
+#define INFLUXDB_SPOOL_DIR     "sensors-db.spool"
+#define INFLUXDB_SPOOL_SEGMENT (1024 * 1024)
+#define INFLUXDB_SPOOL_MAX_SEG 64
+#define INFLUXDB_SPOOL_SYNC_MS 10000
+
+/* Retry step while a sample is late, and the longest single sleep */
+#define SENSOR_POLL_MS         50
+#define SENSOR_MAX_SLEEP_MS    1000
+
+/* SEN55 temperature compensation, applied at start-up */
+#define SEN5X_TEMP_OFFSET      0.0f
+
+/* Samples kept per channel: an hour at 1 Hz */
+#define SAMPLE_HISTORY         3600
+
 static volatile sig_atomic_t running = 1;
 
 /* Timestamp "YYYY-MM-DD HH:MM:SS" */
@@ -37,23 +76,90 @@ static void handle_signal(int sig) {
     running = 0;
 }
 
-/* --- InfluxDB HTTP write --- */
+static influx_sender_t influx;
+
+/* Samples are stamped with HAL (monotonic) time when read and converted
+ * to Unix ms with the offset taken at the last tick. */
+static sample_clock_t sample_clock;
+
+/* Per-channel sample history, filled with raw ticks by the readers */
+static sample_store_t store;
+static sensor_ticks_t sfa3x_ticks, scd30_ticks, sen44_ticks, sen66_ticks, sen5x_ticks;
+
 static void influxdb_write(const char* line) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return;
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: text/plain; charset=utf-8");
-    headers = curl_slist_append(headers, "Authorization: Token " INFLUXDB_TOKEN);
-    curl_easy_setopt(curl, CURLOPT_URL, INFLUXDB_URL);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, line);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 2000L);
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        fprintf(stderr, "InfluxDB write failed: %s\n", curl_easy_strerror(res));
+    influx_sender_push(&influx, line);
+}
+
+/* --- Sample output (called after every read) --- */
+
+/* One "--- time ---" header per second in which samples arrived. */
+static void print_header(void) {
+    static time_t last;
+    time_t now = time(NULL);
+    if (now == last) return;
+    last = now;
+
+    char timestamp[32];
+    get_local_timestamp(timestamp, sizeof(timestamp));
+    printf("\n--- %s ---\n", timestamp);
+}
+
+/* Console label: the measurement name in capitals */
+static void print_label(const char* name) {
+    for (; *name; name++) putchar(toupper((unsigned char)*name));
+    printf(" ->");
+}
+
+/* One line per sample, encoded from the raw ticks, tagged with the
+ * device name. Values the sensor reported as unknown are left out of
+ * the line. */
+static void publish(const sensor_ticks_t* t, void* user) {
+    const char* device = user;
+    static char line[INFLUX_SENDER_LINE_MAX];
+    char value[16];
+    influx_line_t lp;
+    influx_line_init(&lp, line, sizeof(line));
+    influx_line_begin(&lp, t->name);
+    influx_line_tag(&lp, "device", device);
+
+    print_header();
+    print_label(t->name);
+    for (unsigned i = 0; i < t->count; i++) {
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        uint16_t raw = sensor_ticks_raw(t, i);
+        if (sensor_ticks_status(t, i) != SAMPLE_OK) {
+            printf("%s %s: unknown", i ? "," : "", c->field);
+            continue;
+        }
+        sample_channel_format(c, raw, value, sizeof(value));
+        printf("%s %s: %s", i ? "," : "", c->field, value);
+        influx_line_field_fixed(&lp, c->field, sample_channel_value(c, raw),
+                                c->scale, c->decimals);
     }
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    printf("\n");
+
+    uint64_t ts = sample_clock_wall_ms(&sample_clock, t->t_usec);
+    if (influx_line_end(&lp, ts) == 0) influxdb_write(line);
+}
+
+static void set_device(sensor_ticks_t* t, const char* device) {
+    t->on_sample = publish;
+    t->user = (void*)device;
+}
+
+/* A tick is a second of samples; POSTs only if some arrived */
+static void end_tick(void* ctx, uint64_t expirations) {
+    (void)ctx;
+    (void)expirations;
+    influx_sender_end_tick(&influx);
+    sample_clock_sync(&sample_clock);
+}
+
+/* SEN55 start step: temperature offset first, then measure */
+static int16_t start_sen5x(void* ctx) {
+    (void)ctx;
+    sen5x_set_temperature_offset_simple(SEN5X_TEMP_OFFSET);
+    return sen5x_start_measurement();
 }
 
 int main(void) {
@@ -61,123 +167,118 @@ int main(void) {
     signal(SIGINT, handle_signal);
     signal(SIGTERM, handle_signal);
 
+    /* --- InfluxDB writer --- */
+    influx_sender_config_t influx_cfg = {
+        .writer = {
+            .url = INFLUXDB_URL,
+            .token = INFLUXDB_TOKEN,
+            .timeout_ms = 2000L,
+            .max_bytes = INFLUXDB_BATCH_BYTES,
+            .max_ticks = INFLUXDB_BATCH_TICKS,
+            .max_age_ms = INFLUXDB_BATCH_AGE_MS,
+            .gzip_level = INFLUXDB_GZIP_LEVEL,
+            .gzip_min_bytes = INFLUXDB_GZIP_MIN_BYTES,
+        },
+        .queue_lines = INFLUXDB_QUEUE_LINES,
+        .policy = INFLUXDB_QUEUE_POLICY,
+        .spool = {
+            .dir = INFLUXDB_SPOOL_DIR,
+            .segment_bytes = INFLUXDB_SPOOL_SEGMENT,
+            .max_segments = INFLUXDB_SPOOL_MAX_SEG,
+            .sync_bytes = 64 * 1024,
+            .sync_interval_ms = INFLUXDB_SPOOL_SYNC_MS,
+            .replay_bytes = 256 * 1024,
+        },
+        .replay_batches = 4,
+    };
+    if (influx_sender_start(&influx, &influx_cfg) != 0) {
+        fprintf(stderr, "InfluxDB sender start failed\n");
+        return 1;
+    }
+
     /* --- I2C init --- */
     sensirion_i2c_hal_init();
 
-    /* --- SFA3X --- */
+    /* --- Sensor bring-up: all resets at once, each sensor starts when ready --- */
     sfa3x_init(SFA3X_I2C_ADDR_5D);
-    sfa3x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    sfa3x_start_continuous_measurement();
-
-    /* --- SCD30 --- */
     scd30_init(SCD30_I2C_ADDR_61);
-    scd30_stop_periodic_measurement();
-    scd30_soft_reset();
-    sensirion_i2c_hal_sleep_usec(2000000);
-    scd30_start_periodic_measurement(0);
-
-    /* --- SEN44 --- */
-    sen44_device_reset();
-    sen44_start_measurement();
-
-    /* --- SEN66 --- */
     sen66_init(SEN66_I2C_ADDR_6B);
-    sen66_device_reset();
-    sensirion_i2c_hal_sleep_usec(1200000);
-    sen66_start_continuous_measurement();
 
-    /* --- SEN55 (SEN5x) --- */
-    sen5x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    float sen5x_temp_offset = 0.0f;
-    sen5x_set_temperature_offset_simple(sen5x_temp_offset);
-    sen5x_start_measurement();
+    sensor_bringup_t bringup;
+    sensor_bringup_init(&bringup);
+    sensor_bringup_add(&bringup, "SFA3X", sensor_bringup_sfa3x_reset,
+                       SFA3X_DEVICE_RESET_USEC, sensor_bringup_sfa3x_start, NULL);
+    sensor_bringup_add(&bringup, "SCD30", sensor_bringup_scd30_reset,
+                       SCD30_SOFT_RESET_USEC, sensor_bringup_scd30_start, NULL);
+    sensor_bringup_add(&bringup, "SEN44", sensor_bringup_sen44_reset,
+                       SEN44_DEVICE_RESET_USEC, sensor_bringup_sen44_start, NULL);
+    sensor_bringup_add(&bringup, "SEN66", sensor_bringup_sen66_reset,
+                       SEN66_DEVICE_RESET_USEC, sensor_bringup_sen66_start, NULL);
+    sensor_bringup_add(&bringup, "SEN55", sensor_bringup_sen5x_reset,
+                       SEN5X_DEVICE_RESET_USEC, start_sen5x, NULL);
+    int failed = sensor_bringup_run(&bringup);
+    if (failed) fprintf(stderr, "%d sensor(s) failed to start\n", failed);
 
     printf("Starting multi-sensor measurement loop...\n");
 
-    while (running) {
-        sensirion_i2c_hal_sleep_usec(1000000);
-        char timestamp[32];
-        get_local_timestamp(timestamp, sizeof(timestamp));
-        printf("\n--- %s ---\n", timestamp);
-
-        /* --- SFA3X --- */
-        float hcho = 0.0f, sfa_hum = 0.0f, sfa_temp = 0.0f;
-        if (!sfa3x_read_measured_values(&hcho, &sfa_hum, &sfa_temp)) {
-            printf("SFA3X -> HCHO: %.2f ppm, Humidity: %.2f %%, Temp: %.2f °C\n",
-                   hcho, sfa_hum, sfa_temp);
-            char line[256];
-            snprintf(line, sizeof(line),
-                     "sfa3x,device=SFA3X hcho=%.2f,humidity=%.2f,temp=%.2f",
-                     hcho, sfa_hum, sfa_temp);
-            influxdb_write(line);
-        }
-
-        /* --- SCD30 --- */
-        float co2 = 0.0f, scd_temp = 0.0f, scd_hum = 0.0f;
-        if (!scd30_blocking_read_measurement_data(&co2, &scd_temp, &scd_hum)) {
-            printf("SCD30 -> CO2: %.2f ppm, Temp: %.2f °C, Humidity: %.2f %%\n",
-                   co2, scd_temp, scd_hum);
-            char line[256];
-            snprintf(line, sizeof(line),
-                     "scd30,device=SCD30 co2=%.2f,temp=%.2f,humidity=%.2f",
-                     co2, scd_temp, scd_hum);
-            influxdb_write(line);
-        }
+    /* --- Raw-tick channels, field names as already in the bucket --- */
+    static const char* const sfa3x_fields[] = {"hcho", "humidity", "temp"};
+    static const char* const scd30_fields[] = {"co2", "temp", "humidity"};
+    static const char* const sen44_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                               "voc", "hum", "temp"};
+    static const char* const sen66_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                               "hum", "temp", "voc", "nox", "co2"};
+    static const char* const sen5x_fields[] = {"pm1p0", "pm2p5", "pm4p0", "pm10p0",
+                                               "hum", "temp", "voc", "nox"};
+    sample_store_init(&store, SAMPLE_HISTORY);
+    if (sensor_ticks_add_sfa3x(&sfa3x_ticks, &store, "sfa3x", sfa3x_fields, NULL) != 0 ||
+        sensor_ticks_add_scd30(&scd30_ticks, &store, "scd30", scd30_fields, NULL) != 0 ||
+        sensor_ticks_add_sen44(&sen44_ticks, &store, "sen44", sen44_fields, NULL) != 0 ||
+        sensor_ticks_add_sen66(&sen66_ticks, &store, "sen66", sen66_fields, NULL) != 0 ||
+        sensor_ticks_add_sen5x(&sen5x_ticks, &store, "sen55", sen5x_fields, NULL) != 0) {
+        fprintf(stderr, "Sample store: out of memory\n");
+        return 1;
+    }
+    set_device(&sfa3x_ticks, "SFA3X");
+    set_device(&scd30_ticks, "SCD30");
+    set_device(&sen44_ticks, "SEN44");
+    set_device(&sen66_ticks, "SEN66");
+    set_device(&sen5x_ticks, "SEN55");
 
-        /* --- SEN44 --- */
-        uint16_t pm1p0_44=0, pm2p5_44=0, pm4p0_44=0, pm10p0_44=0;
-        float voc_44=0.0f, hum_44=0.0f, temp_44=0.0f;
-        if (!sen44_read_measured_mass_concentration_and_ambient_values(
-                &pm1p0_44, &pm2p5_44, &pm4p0_44, &pm10p0_44,
-                &voc_44, &hum_44, &temp_44)) {
-            printf("SEN44 -> PM1.0: %u, PM2.5: %u, PM4.0: %u, PM10: %u µg/m³\n",
-                   pm1p0_44, pm2p5_44, pm4p0_44, pm10p0_44);
-            char line[512];
-            snprintf(line, sizeof(line),
-                     "sen44,device=SEN44 pm1p0=%u,pm2p5=%u,pm4p0=%u,pm10p0=%u,voc=%.2f,hum=%.2f,temp=%.2f",
-                     pm1p0_44, pm2p5_44, pm4p0_44, pm10p0_44,
-                     voc_44, hum_44, temp_44);
-            influxdb_write(line);
-        }
+    /* --- Data-ready scheduling (SFA3X has no flag, read per interval) --- */
+    sensor_sched_t sched;
+    sensor_sched_init(&sched, SENSOR_POLL_MS, SENSOR_MAX_SLEEP_MS);
+    sensor_sched_add(&sched, "SFA3X", 1000, NULL, sensor_ticks_read_sfa3x, &sfa3x_ticks);
+    sensor_sched_add(&sched, "SCD30", 2000, sensor_ticks_ready_scd30,
+                     sensor_ticks_read_scd30, &scd30_ticks);
+    sensor_sched_add(&sched, "SEN44", 1000, sensor_ticks_ready_sen44,
+                     sensor_ticks_read_sen44, &sen44_ticks);
+    sensor_sched_add(&sched, "SEN66", 1000, sensor_ticks_ready_sen66,
+                     sensor_ticks_read_sen66, &sen66_ticks);
+    sensor_sched_add(&sched, "SEN55", 1000, sensor_ticks_ready_sen5x,
+                     sensor_ticks_read_sen5x, &sen5x_ticks);
 
-        /* --- SEN66 --- */
-        float pm1p0_66=0.0f, pm2p5_66=0.0f, pm4p0_66=0.0f, pm10p0_66=0.0f;
-        float hum_66=0.0f, temp_66=0.0f, voc_66=0.0f, nox_66=0.0f;
-        uint16_t co2_66=0;
-        if (!sen66_read_measured_values(
-                &pm1p0_66, &pm2p5_66, &pm4p0_66, &pm10p0_66,
-                &hum_66, &temp_66, &voc_66, &nox_66, &co2_66)) {
-            printf("SEN66 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³\n",
-                   pm1p0_66, pm2p5_66, pm4p0_66, pm10p0_66);
-            char line[512];
-            snprintf(line, sizeof(line),
-                     "sen66,device=SEN66 pm1p0=%.2f,pm2p5=%.2f,pm4p0=%.2f,pm10p0=%.2f,"
-                     "hum=%.2f,temp=%.2f,voc=%.2f,nox=%.2f,co2=%u",
-                     pm1p0_66, pm2p5_66, pm4p0_66, pm10p0_66,
-                     hum_66, temp_66, voc_66, nox_66, co2_66);
-            influxdb_write(line);
-        }
+    /* --- Event loop: sensor deadlines and the Influx tick on absolute timers --- */
+    sample_clock_sync(&sample_clock);
+    event_loop_t loop;
+    if (event_loop_init(&loop) != 0 || sensor_sched_attach(&sched, &loop) != 0) {
+        perror("event loop");
+        return 1;
+    }
+    int tick = event_loop_add_timer(&loop, end_tick, NULL);
+    if (tick < 0 || event_loop_arm_periodic(&loop, tick, INFLUXDB_TICK_MS * 1000ULL) != 0) {
+        perror("tick timer");
+        return 1;
+    }
 
-        /* --- SEN55 --- */
-        float pm1p0_5x=0.0f, pm2p5_5x=0.0f, pm4p0_5x=0.0f, pm10p0_5x=0.0f;
-        float hum_5x=0.0f, temp_5x=0.0f, voc_5x=0.0f, nox_5x=0.0f;
-
-        if (!sen5x_read_measured_values(
-                &pm1p0_5x, &pm2p5_5x, &pm4p0_5x, &pm10p0_5x,
-                &hum_5x, &temp_5x, &voc_5x, &nox_5x)) {
-            printf("SEN55 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³\n",
-                   pm1p0_5x, pm2p5_5x, pm4p0_5x, pm10p0_5x);
-            char line[512];
-            snprintf(line, sizeof(line),
-                     "sen55,device=SEN55 pm1p0=%.2f,pm2p5=%.2f,pm4p0=%.2f,pm10p0=%.2f,"
-                     "hum=%.2f,temp=%.2f,voc=%.2f,nox=%.2f",
-                     pm1p0_5x, pm2p5_5x, pm4p0_5x, pm10p0_5x,
-                     hum_5x, temp_5x, voc_5x, nox_5x);
-            influxdb_write(line);
+    int first_pending = 1;
+    while (running) {
+        event_loop_run_once(&loop, -1);
+        if (first_pending) {
+            first_pending = sensor_bringup_report(&bringup, &sched, stdout);
         }
     }
+    event_loop_close(&loop);
 
     printf("Stopping measurements...\n");
     sfa3x_stop_measurement();
@@ -185,6 +286,8 @@ int main(void) {
     sen44_stop_measurement();
     sen66_stop_measurement();
     sen5x_stop_measurement();
+    influx_sender_stop(&influx);
+    sample_store_free(&store);
 
     return 0;
 }
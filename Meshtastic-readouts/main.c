@@ -5,26 +5,45 @@
 #include <time.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <math.h>
 #include <unistd.h>
+#include <sys/epoll.h>
 
+#include "sensirion_common.h"
 #include "sensirion_i2c_hal.h"
 #include "sfa3x_i2c.h"
 #include "scd30_i2c.h"
 #include "sen44_i2c.h"
 #include "sen66_i2c.h"
 #include "sen5x_i2c.h"
+#include "anomaly.h"
+#include "event_loop.h"
+#include "mesh_report.h"
+#include "mesh_serial.h"
+#include "ring_file.h"
+#include "sensor_bringup.h"
 
-/* Spike thresholds */
-#define HCHO_SPIKE     5.0f   // ppm
-#define CO2_SPIKE      100.0f // ppm
-#define PM_SPIKE       50.0f  // µg/m³
-#define TEMP_SPIKE     5.0f   // °C
-#define HUM_SPIKE      10.0f  // %
-#define VOC_SPIKE      10.0f  // arbitrary units
-#define NOX_SPIKE      10.0f  // arbitrary units
+/* Anomaly detection: each channel learns its own baseline and noise */
+#define ANOMALY_ALPHA  0.05f  // baseline over ~20 readings (40 minutes)
+#define ANOMALY_WARMUP 10     // readings before the first alarm
+#define ANOMALY_NOISE_TICKS 2 // noise floor: two steps of the sensor's resolution
+
+/* Detector state across restarts; older than this it starts cold */
+#define STATE_FILE "test-sensors.ring"  // -r overrides, -n runs without
+#define STATE_MAX_AGE_MS (60 * 60 * 1000)
+
+#define SEN5X_TEMP_OFFSET 0.0f  // °C, applied at start-up
+
+#define READING_PERIOD_USEC (120 * 1000000ULL)  // 2 minutes
+
+#define MESH_PORT "/dev/ttyACM0"  // node's USB serial, -p overrides
+#define MESH_KEYFRAME_EVERY 10     // full report every 20 minutes, deltas between
 
 static volatile sig_atomic_t running = 1;
+static int cycle_due;
+static bool text_messages;  // -t: one text message per sensor, as before
 
 /* Timestamp "YYYY-MM-DD HH:MM:SS" */
 static void get_local_timestamp(char* buf, size_t len) {
@@ -44,36 +63,127 @@ static void handle_signal(int sig) {
     running = 0;
 }
 
-/* Meshtastic send helper (escapes quotes) */
+/* Radio link, open for the whole run */
+static mesh_serial_t radio;
+static event_loop_t loop;
+static int radio_watch = -1;
+
+/* FromRadio frames (config dump, echoes, log) are not used; reading them
+ * keeps the node from stalling on a full USB buffer. */
+static void on_radio(void* ctx, int fd, uint32_t events) {
+    (void)fd;
+    (void)events;
+    if (mesh_serial_poll(ctx, NULL, NULL) != 0) {
+        event_loop_remove(&loop, radio_watch);
+        radio_watch = -1;
+        fprintf(stderr, "Meshtastic: %s hung up\n", radio.path);
+    }
+}
+
+/* Reopen after an unplug or a failed write and watch the new descriptor */
+static void watch_radio(void) {
+    if (radio_watch >= 0 && loop.sources[radio_watch].fd == radio.fd) return;
+    if (radio_watch >= 0) event_loop_remove(&loop, radio_watch);
+    radio_watch = -1;
+    if (mesh_serial_reopen(&radio) != 0) return;
+    radio_watch = event_loop_add_fd(&loop, radio.fd, EPOLLIN, on_radio, &radio);
+}
+
 static void send_meshtastic(const char* msg) {
-    char cmd[512];
-    char escaped[512];
-    size_t j = 0;
-    for (size_t i = 0; msg[i] != '\0' && j < sizeof(escaped) - 1; i++) {
-        if (msg[i] == '"') {
-            if (j + 2 < sizeof(escaped) - 1) {
-                escaped[j++] = '\\';
-                escaped[j++] = '"';
-            }
+    if (!text_messages) return;
+    watch_radio();
+    if (mesh_serial_send_text(&radio, msg) != 0) {
+        fprintf(stderr, "Meshtastic send failed: %s\n", strerror(errno));
+    }
+}
+
+/* One sensor's readings into the cycle's report, in its slot's channel order */
+static void report_add(mesh_report_t* report, unsigned slot, const float* values) {
+    uint16_t raw[MESH_REPORT_MAX_CHANNELS];
+    for (unsigned i = 0; i < mesh_report_sensors[slot].count; i++)
+        raw[i] = mesh_report_ticks(slot, i, values[i]);
+    mesh_report_set(report, slot, raw);
+}
+
+/* Every sensor of the cycle in one binary packet (mesh-decode reads it):
+ * a keyframe, or only what moved past its dead-band since */
+static void send_report(mesh_report_stream_t* stream, mesh_report_t* report) {
+    if (text_messages || !report->present) return;
+
+    uint8_t buf[MESH_REPORT_MAX_BYTES];
+    size_t len = mesh_report_stream_encode(stream, report, buf, sizeof(buf));
+    if (len == 0) {
+        printf("Meshtastic: no change past the dead-bands, nothing sent\n");
+        return;
+    }
+    watch_radio();
+    if (mesh_serial_send_data(&radio, MESH_PORT_PRIVATE, buf, len,
+                              MESH_SERIAL_BROADCAST, 0) != 0) {
+        fprintf(stderr, "Meshtastic send failed: %s\n", strerror(errno));
+        return;
+    }
+    if (report->kind == MESH_REPORT_KIND_FULL)
+        printf("Meshtastic: keyframe %u, %zu bytes\n", report->seq, len);
+    else
+        printf("Meshtastic: delta %u on keyframe %u, %zu bytes\n", report->seq,
+               report->key_seq, len);
+}
+
+/* One detector per channel, in report slot order. They live in the state
+ * file when there is one, so a restart keeps the learned baselines. */
+typedef anomaly_state_t detector_row_t[MESH_REPORT_MAX_CHANNELS];
+static detector_row_t cold_detectors[MESH_REPORT_SENSORS];
+static detector_row_t* detectors = cold_detectors;
+static anomaly_config_t detector_cfg[MESH_REPORT_SENSORS][MESH_REPORT_MAX_CHANNELS];
+static ring_file_t state_file;
+
+/* Detectors from path if it has recent ones, else from scratch */
+static void init_detectors(const char* path) {
+    bool warm = false;
+    if (path) {
+        ring_file_config_t cfg = {
+            .path = path,
+            .max_age_ms = STATE_MAX_AGE_MS,
+            .state_bytes = sizeof(cold_detectors),
+        };
+        if (ring_file_open(&state_file, &cfg, NULL) == 0) {
+            detectors = state_file.state;
+            warm = state_file.warm;
+            if (state_file.resumed)
+                printf("Detectors from %s, saved %llu s ago: %s\n", path,
+                       (unsigned long long)(state_file.age_ms / 1000),
+                       warm ? "warm" : "too old, starting cold");
         } else {
-            escaped[j++] = msg[i];
+            fprintf(stderr, "%s: %s, detectors start cold\n", path, strerror(errno));
         }
     }
-    escaped[j] = '\0';
-
-    snprintf(cmd, sizeof(cmd),
-             "meshtastic --port /dev/ttyACM0 --sendtext \"%s\"",
-             escaped);
-    int ret = system(cmd);
-    if (ret != 0) {
-        fprintf(stderr, "Meshtastic send failed: %d\n", ret);
+
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        for (unsigned i = 0; i < mesh_report_sensors[s].count; i++) {
+            float resolution = 1.0f / mesh_report_sensors[s].channels[i].scale;
+            detector_cfg[s][i] = anomaly_config_default(
+                ANOMALY_ALPHA, ANOMALY_NOISE_TICKS * resolution, ANOMALY_WARMUP);
+            if (!warm) anomaly_reset(&detectors[s][i]);
+        }
     }
 }
 
-/* Spike detection helper */
-static bool spike_detected(float current, float previous, float threshold) {
-    if (isnan(current) || isnan(previous)) return false;
-    return fabsf(current - previous) > threshold;
+/* Run a sensor's readings through its detectors and print the alarms.
+ * Returns true if any channel raised one. */
+static bool detect_anomalies(unsigned slot, const float* values) {
+    const mesh_report_sensor_t* sensor = &mesh_report_sensors[slot];
+    bool any = false;
+
+    for (unsigned i = 0; i < sensor->count; i++) {
+        anomaly_event_t ev;
+        if (!anomaly_update(&detectors[slot][i], &detector_cfg[slot][i], values[i], &ev))
+            continue;
+        printf("%s %s: %s to %.2f (baseline %.2f +/- %.2f), severity %u\n",
+               sensor->name, sensor->channels[i].field, anomaly_kind_name(ev.kind),
+               ev.value, ev.baseline, ev.sigma, ev.severity);
+        any = true;
+    }
+    return any;
 }
 
 /* Convert Celsius to Fahrenheit */
@@ -81,7 +191,36 @@ static float c_to_f(float c) {
     return c * 9.0f / 5.0f + 32.0f;
 }
 
-int main(void) {
+/* SEN55 start step: temperature offset first, then measure */
+static int16_t start_sen5x(void* ctx) {
+    (void)ctx;
+    sen5x_set_temperature_offset_simple(SEN5X_TEMP_OFFSET);
+    return sen5x_start_measurement();
+}
+
+/* Reading timer */
+static void on_cycle(void* ctx, uint64_t expirations) {
+    (void)ctx;
+    (void)expirations;
+    cycle_due = 1;
+}
+
+int main(int argc, char** argv) {
+    const char* port = MESH_PORT;
+    const char* state_path = STATE_FILE;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:tr:n")) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        case 't': text_messages = true; break;
+        case 'r': state_path = optarg; break;
+        case 'n': state_path = NULL; break;
+        default:
+            fprintf(stderr, "usage: %s [-p serial-port] [-t] [-r state-file | -n]\n", argv[0]);
+            return 2;
+        }
+    }
+
     setvbuf(stdout, NULL, _IOLBF, 0);
     signal(SIGINT, handle_signal);
     signal(SIGTERM, handle_signal);
@@ -89,40 +228,48 @@ int main(void) {
     /* --- I2C init --- */
     sensirion_i2c_hal_init();
 
-    /* --- Sensor startup --- */
+    /* --- Sensor bring-up: all resets at once, each sensor starts when ready --- */
     sfa3x_init(SFA3X_I2C_ADDR_5D);
-    sfa3x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    sfa3x_start_continuous_measurement();
-
     scd30_init(SCD30_I2C_ADDR_61);
-    scd30_stop_periodic_measurement();
-    scd30_soft_reset();
-    sensirion_i2c_hal_sleep_usec(2000000);
-    scd30_start_periodic_measurement(0);
+    sen66_init(SEN66_I2C_ADDR_6B);
 
-    sen44_device_reset();
-    sen44_start_measurement();
+    sensor_bringup_t bringup;
+    sensor_bringup_init(&bringup);
+    sensor_bringup_add(&bringup, "SFA3X", sensor_bringup_sfa3x_reset,
+                       SFA3X_DEVICE_RESET_USEC, sensor_bringup_sfa3x_start, NULL);
+    sensor_bringup_add(&bringup, "SCD30", sensor_bringup_scd30_reset,
+                       SCD30_SOFT_RESET_USEC, sensor_bringup_scd30_start, NULL);
+    sensor_bringup_add(&bringup, "SEN44", sensor_bringup_sen44_reset,
+                       SEN44_DEVICE_RESET_USEC, sensor_bringup_sen44_start, NULL);
+    sensor_bringup_add(&bringup, "SEN66", sensor_bringup_sen66_reset,
+                       SEN66_DEVICE_RESET_USEC, sensor_bringup_sen66_start, NULL);
+    sensor_bringup_add(&bringup, "SEN55", sensor_bringup_sen5x_reset,
+                       SEN5X_DEVICE_RESET_USEC, start_sen5x, NULL);
+    int failed = sensor_bringup_run(&bringup);
+    if (failed) fprintf(stderr, "%d sensor(s) failed to start\n", failed);
+
+    /* --- Anomaly detectors: as the last run left them, or warming up --- */
+    init_detectors(state_path);
+
+    /* Readings every 2 minutes on an absolute timer, so the read and send
+     * time does not push the schedule back */
+    int cycle = -1;
+    if (event_loop_init(&loop) == 0) cycle = event_loop_add_timer(&loop, on_cycle, NULL);
+    if (cycle < 0 || event_loop_arm_periodic(&loop, cycle, READING_PERIOD_USEC) != 0) {
+        perror("reading timer");
+        return 1;
+    }
 
-    sen66_init(SEN66_I2C_ADDR_6B);
-    sen66_device_reset();
-    sensirion_i2c_hal_sleep_usec(1200000);
-    sen66_start_continuous_measurement();
-
-    sen5x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    sen5x_set_temperature_offset_simple(0.0f);
-    sen5x_start_measurement();
-
-    /* --- Previous values for spike detection --- */
-    float prev_hcho=0, prev_sfa_temp=0, prev_sfa_hum=0;
-    float prev_co2=0, prev_scd_temp=0, prev_scd_hum=0;
-    float prev_pm2p5_44=0, prev_voc_44=0;
-    float prev_pm2p5_66=0, prev_voc_66=0, prev_nox_66=0;
-    float prev_pm2p5_5x=0, prev_voc_5x=0, prev_nox_5x=0;
+    /* --- Radio: the node's serial port stays open; node replies arrive in the loop --- */
+    if (mesh_serial_open(&radio, port) != 0) {
+        fprintf(stderr, "Meshtastic: %s: %s, retrying on each send\n", port, strerror(errno));
+    }
+    watch_radio();
 
     printf("Starting multi-sensor measurement loop...\n");
 
+    mesh_report_stream_t stream;
+    mesh_report_stream_init(&stream, MESH_KEYFRAME_EVERY);
     while (running) {
         char timestamp[32];
         get_local_timestamp(timestamp, sizeof(timestamp));
@@ -139,98 +286,116 @@ int main(void) {
         float pm1p0_5x=0, pm2p5_5x=0, pm4p0_5x=0, pm10p0_5x=0;
         float hum_5x=0, temp_5x=0, voc_5x=0, nox_5x=0;
 
-        sfa3x_read_measured_values(&hcho, &sfa_hum, &sfa_temp);
-        scd30_blocking_read_measurement_data(&co2, &scd_temp, &scd_hum);
-        sen44_read_measured_mass_concentration_and_ambient_values(
+        int16_t sfa_err = sfa3x_read_measured_values(&hcho, &sfa_hum, &sfa_temp);
+        /* Never wait on the SCD30: after 2 minutes a sample is normally
+         * waiting, and if not the others still go out on time */
+        int16_t scd_err =
+            scd30_try_read_measurement_data(&co2, &scd_temp, &scd_hum);
+        int16_t sen44_err = sen44_read_measured_mass_concentration_and_ambient_values(
             &pm1p0_44,&pm2p5_44,&pm4p0_44,&pm10p0_44,&voc_44,&hum_44,&temp_44);
-        sen66_read_measured_values(
+        int16_t sen66_err = sen66_read_measured_values(
             &pm1p0_66,&pm2p5_66,&pm4p0_66,&pm10p0_66,
             &hum_66,&temp_66,&voc_66,&nox_66,&co2_66);
-        sen5x_read_measured_values(
+        int16_t sen5x_err = sen5x_read_measured_values(
             &pm1p0_5x,&pm2p5_5x,&pm4p0_5x,&pm10p0_5x,
             &hum_5x,&temp_5x,&voc_5x,&nox_5x);
 
         char msg[256];
+        mesh_report_t report;
+        mesh_report_clear(&report);
 
         /* --- SFA3X --- */
-        bool spike = spike_detected(hcho, prev_hcho, HCHO_SPIKE) ||
-                     spike_detected(sfa_temp, prev_sfa_temp, TEMP_SPIKE) ||
-                     spike_detected(sfa_hum, prev_sfa_hum, HUM_SPIKE);
-        prev_hcho = hcho; prev_sfa_temp = sfa_temp; prev_sfa_hum = sfa_hum;
+        const float sfa[] = {hcho, sfa_hum, sfa_temp};
+        bool anomaly = sfa_err == NO_ERROR && detect_anomalies(MESH_REPORT_SFA3X, sfa);
 
-        if ((spike || hcho != 0.0f || sfa_temp != 0.0f || sfa_hum != 0.0f) &&
+        if ((anomaly || hcho != 0.0f || sfa_temp != 0.0f || sfa_hum != 0.0f) &&
             !isnan(hcho) && !isnan(sfa_temp) && !isnan(sfa_hum)) {
             snprintf(msg, sizeof(msg),
                      "SFA3X -> HCHO: %.2f ppm, Temp: %.2f C (%.2f F), Hum: %.2f%%",
                      hcho, sfa_temp, c_to_f(sfa_temp), sfa_hum);
             send_meshtastic(msg);
+            report_add(&report, MESH_REPORT_SFA3X, sfa);
             printf("%s\n", msg);
         }
 
-        /* --- SCD30 --- */
-        spike = spike_detected(co2, prev_co2, CO2_SPIKE) ||
-                spike_detected(scd_temp, prev_scd_temp, TEMP_SPIKE) ||
-                spike_detected(scd_hum, prev_scd_hum, HUM_SPIKE);
-        prev_co2 = co2; prev_scd_temp = scd_temp; prev_scd_hum = scd_hum;
-
-        if ((spike || co2 != 0.0f || scd_temp != 0.0f || scd_hum != 0.0f) &&
-            !isnan(co2) && !isnan(scd_temp) && !isnan(scd_hum)) {
-            snprintf(msg, sizeof(msg),
-                     "SCD30 -> CO2: %.2f ppm, Temp: %.2f C (%.2f F), Hum: %.2f%%",
-                     co2, scd_temp, c_to_f(scd_temp), scd_hum);
-            send_meshtastic(msg);
-            printf("%s\n", msg);
+        /* --- SCD30 (skipped this round if no sample was ready) --- */
+        if (scd_err == NO_ERROR) {
+            const float scd[] = {co2, scd_temp, scd_hum};
+            anomaly = detect_anomalies(MESH_REPORT_SCD30, scd);
+
+            if ((anomaly || co2 != 0.0f || scd_temp != 0.0f || scd_hum != 0.0f) &&
+                !isnan(co2) && !isnan(scd_temp) && !isnan(scd_hum)) {
+                snprintf(msg, sizeof(msg),
+                         "SCD30 -> CO2: %.2f ppm, Temp: %.2f C (%.2f F), Hum: %.2f%%",
+                         co2, scd_temp, c_to_f(scd_temp), scd_hum);
+                send_meshtastic(msg);
+                report_add(&report, MESH_REPORT_SCD30, scd);
+                printf("%s\n", msg);
+            }
+        } else if (scd_err == DATA_NOT_READY_ERROR) {
+            printf("SCD30 -> no new sample\n");
         }
 
         /* --- SEN44 --- */
-        spike = spike_detected(pm2p5_44, prev_pm2p5_44, PM_SPIKE) ||
-                spike_detected(voc_44, prev_voc_44, VOC_SPIKE);
-        prev_pm2p5_44 = pm2p5_44; prev_voc_44 = voc_44;
+        const float sen44[] = {pm1p0_44, pm2p5_44, pm4p0_44, pm10p0_44,
+                               voc_44, hum_44, temp_44};
+        anomaly = sen44_err == NO_ERROR && detect_anomalies(MESH_REPORT_SEN44, sen44);
 
-        if ((spike || pm2p5_44 != 0 || voc_44 != 0.0f || temp_44 != 0.0f || hum_44 != 0.0f)) {
+        if ((anomaly || pm2p5_44 != 0 || voc_44 != 0.0f || temp_44 != 0.0f || hum_44 != 0.0f)) {
             snprintf(msg, sizeof(msg),
                      "SEN44 -> PM2.5: %u, VOC: %.2f, Temp: %.2f C (%.2f F), Hum: %.2f",
                      pm2p5_44, voc_44, temp_44, c_to_f(temp_44), hum_44);
             send_meshtastic(msg);
+            report_add(&report, MESH_REPORT_SEN44, sen44);
             printf("%s\n", msg);
         }
 
         /* --- SEN66 --- */
-        spike = spike_detected(pm2p5_66, prev_pm2p5_66, PM_SPIKE) ||
-                spike_detected(voc_66, prev_voc_66, VOC_SPIKE) ||
-                spike_detected(nox_66, prev_nox_66, NOX_SPIKE);
-        prev_pm2p5_66 = pm2p5_66; prev_voc_66 = voc_66; prev_nox_66 = nox_66;
+        const float sen66[] = {pm1p0_66, pm2p5_66, pm4p0_66, pm10p0_66,
+                               hum_66, temp_66, voc_66, nox_66, co2_66};
+        anomaly = sen66_err == NO_ERROR && detect_anomalies(MESH_REPORT_SEN66, sen66);
 
-        if ((spike || pm2p5_66 != 0.0f || voc_66 != 0.0f || temp_66 != 0.0f ||
+        if ((anomaly || pm2p5_66 != 0.0f || voc_66 != 0.0f || temp_66 != 0.0f ||
              hum_66 != 0.0f || nox_66 != 0.0f)) {
             snprintf(msg, sizeof(msg),
                      "SEN66 -> PM2.5: %.2f, VOC: %.2f, Temp: %.2f C (%.2f F), Hum: %.2f, NOx: %.2f",
                      pm2p5_66, voc_66, temp_66, c_to_f(temp_66), hum_66, nox_66);
             send_meshtastic(msg);
+            report_add(&report, MESH_REPORT_SEN66, sen66);
             printf("%s\n", msg);
         }
 
         /* --- SEN55 --- */
-        spike = spike_detected(pm2p5_5x, prev_pm2p5_5x, PM_SPIKE) ||
-                spike_detected(voc_5x, prev_voc_5x, VOC_SPIKE) ||
-                spike_detected(nox_5x, prev_nox_5x, NOX_SPIKE);
-        prev_pm2p5_5x = pm2p5_5x; prev_voc_5x = voc_5x; prev_nox_5x = nox_5x;
+        const float sen5x[] = {pm1p0_5x, pm2p5_5x, pm4p0_5x, pm10p0_5x,
+                               hum_5x, temp_5x, voc_5x, nox_5x};
+        anomaly = sen5x_err == NO_ERROR && detect_anomalies(MESH_REPORT_SEN5X, sen5x);
 
-        if ((spike || pm2p5_5x != 0.0f || voc_5x != 0.0f || temp_5x != 0.0f ||
+        if ((anomaly || pm2p5_5x != 0.0f || voc_5x != 0.0f || temp_5x != 0.0f ||
              hum_5x != 0.0f || nox_5x != 0.0f)) {
             snprintf(msg, sizeof(msg),
                      "SEN55 -> PM2.5: %.2f, VOC: %.2f, Temp: %.2f C (%.2f F), Hum: %.2f, NOx: %.2f",
                      pm2p5_5x, voc_5x, temp_5x, c_to_f(temp_5x), hum_5x, nox_5x);
             send_meshtastic(msg);
+            report_add(&report, MESH_REPORT_SEN5X, sen5x);
             printf("%s\n", msg);
         }
 
-        /* --- Sleep 2 minutes --- */
+        /* --- One packet for the whole cycle --- */
+        send_report(&stream, &report);
+
+        /* --- Detector state to disk, for a warm restart --- */
+        ring_file_tick(&state_file, sensirion_i2c_hal_get_time_usec());
+
+        /* --- Wait for the next 2-minute mark --- */
         if (running) {
-            printf("Sleeping 2 minutes before next reading...\n");
-            for (int i = 0; i < 120 && running; i++) sleep(1);
+            printf("Sleeping until the next reading...\n");
+            cycle_due = 0;
+            while (running && !cycle_due) event_loop_run_once(&loop, -1);
         }
     }
+    event_loop_close(&loop);
+    mesh_serial_close(&radio);
+    ring_file_close(&state_file);
 
     printf("Stopping measurements...\n");
     sfa3x_stop_measurement();
@@ -0,0 +1,163 @@
+/*
+ * Decoder for the binary sensor reports (mesh_report.h) the readouts
+ * program and the daemon's mesh sink send on the private port.
+ *
+ *   ./mesh-decode 1007151c00...     payloads given as hex
+ *   ./mesh-decode < packets.log     hex somewhere on each line
+ *   ./mesh-decode -p /dev/ttyACM0   listen on a receiving node
+ *
+ * On stdin, the first run of hex digits on a line (an optional "0x" is
+ * skipped) that decodes as a report is printed; other lines are ignored.
+ * Deltas are applied to the last keyframe seen, per sending node on -p,
+ * and print the full values of the sensors they touched.
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mesh_report.h"
+#include "mesh_serial.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+#define MAX_NODES 16
+
+/* Report streams by sending node; hex input is all node 0. */
+static struct {
+    uint32_t node;
+    mesh_report_stream_t stream;
+} nodes[MAX_NODES];
+static unsigned node_count;
+
+static mesh_report_stream_t* stream_of(uint32_t node) {
+    for (unsigned i = 0; i < node_count; i++) {
+        if (nodes[i].node == node) return &nodes[i].stream;
+    }
+    unsigned i = node_count < MAX_NODES ? node_count++ : MAX_NODES - 1;
+    nodes[i].node = node;
+    mesh_report_stream_init(&nodes[i].stream, 1);
+    return &nodes[i].stream;
+}
+
+static void print_report(uint32_t node, const uint8_t* buf, size_t len,
+                         const char* from) {
+    mesh_report_t r;
+
+    switch (mesh_report_stream_decode(stream_of(node), buf, len, &r)) {
+    case 0:
+        mesh_report_print(&r, from, len, stdout);
+        break;
+    case 1:
+        printf("delta %u on keyframe %u, %zu bytes: waiting for a keyframe\n",
+               r.seq, r.key_seq, len);
+        break;
+    default:
+        printf("not a report (%zu bytes)\n", len);
+    }
+}
+
+/* Hex digits from s into buf; stops at the first non-hex character.
+ * Returns the byte count, 0 if there were none or an odd number. */
+static size_t parse_hex(const char* s, uint8_t* buf, size_t cap) {
+    size_t n = 0;
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) s += 2;
+    while (isxdigit((unsigned char)s[0]) && isxdigit((unsigned char)s[1])) {
+        if (n == cap) return 0;
+        char byte[3] = {s[0], s[1], '\0'};
+        buf[n++] = (uint8_t)strtoul(byte, NULL, 16);
+        s += 2;
+    }
+    return isxdigit((unsigned char)s[0]) ? 0 : n;
+}
+
+static void on_frame(void* ctx, const uint8_t* msg, size_t len) {
+    (void)ctx;
+    mesh_to_radio_t p;
+    char from[16];
+
+    if (mesh_decode_from_radio(msg, len, &p) != 0 || !p.is_packet ||
+        p.portnum != MESH_PORT_PRIVATE)
+        return;
+    snprintf(from, sizeof(from), "!%08x", p.from);
+    print_report(p.from, p.payload, p.payload_len, from);
+}
+
+static int listen_on(const char* port) {
+    mesh_serial_t radio;
+    if (mesh_serial_open(&radio, port) != 0) {
+        fprintf(stderr, "%s: %s\n", port, strerror(errno));
+        return 1;
+    }
+    fprintf(stderr, "Listening on %s\n", port);
+
+    while (running) {
+        struct pollfd pfd = {.fd = radio.fd, .events = POLLIN};
+        if (radio.fd < 0) {
+            sleep(1);                /* unplugged: try again */
+            mesh_serial_reopen(&radio);
+            continue;
+        }
+        if (poll(&pfd, 1, 1000) > 0 && mesh_serial_poll(&radio, on_frame, NULL) != 0)
+            fprintf(stderr, "%s hung up\n", port);
+    }
+    mesh_serial_close(&radio);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* port = NULL;
+    uint8_t buf[MESH_SERIAL_PAYLOAD_MAX];
+    int opt;
+    while ((opt = getopt(argc, argv, "p:h")) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-p serial-port] [hex ...]\n", argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    if (port) return listen_on(port);
+
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            size_t n = parse_hex(argv[i], buf, sizeof(buf));
+            if (n) print_report(0, buf, n, NULL);
+            else fprintf(stderr, "not hex: %s\n", argv[i]);
+        }
+        return 0;
+    }
+
+    char line[1024];
+    while (running && fgets(line, sizeof(line), stdin)) {
+        const char* p = line;
+        while (*p) {
+            if (!isxdigit((unsigned char)*p)) {
+                p++;
+                continue;
+            }
+            mesh_report_t r;
+            size_t n = parse_hex(p, buf, sizeof(buf));
+            if (n && mesh_report_decode(buf, n, &r) == 0) {
+                print_report(0, buf, n, NULL);
+                break;
+            }
+            while (isxdigit((unsigned char)*p) || *p == 'x' || *p == 'X') p++;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Stand-in Meshtastic node on a pseudo-terminal, for running the
+ * readouts program without a radio. Opens a pty, prints the device to
+ * point the program at (or links it with -l), splits the serial framing,
+ * decodes each ToRadio and prints what would have gone on air. A
+ * want_config request is answered with config_complete_id, as a node
+ * does at the end of its config dump.
+ *
+ *   ./mesh-standin -l /tmp/ttyMESH &
+ *   ./test-sensors -p /tmp/ttyMESH
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "mesh_report.h"
+#include "mesh_serial.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+typedef struct {
+    int master;
+    unsigned long packets;
+    unsigned long limit;     /* stop after this many packets, 0: never */
+    mesh_report_stream_t reports;
+} standin_t;
+
+static void print_payload(standin_t* s, const mesh_to_radio_t* t) {
+    mesh_report_t r;
+
+    if (t->portnum == MESH_PORT_TEXT_MESSAGE) {
+        printf("%.*s\n", (int)t->payload_len, (const char*)t->payload);
+        return;
+    }
+    if (t->portnum == MESH_PORT_PRIVATE &&
+        mesh_report_stream_decode(&s->reports, t->payload, t->payload_len,
+                                  &r) == 0) {
+        mesh_report_print(&r, NULL, 0, stdout);
+        return;
+    }
+    for (size_t i = 0; i < t->payload_len; i++) printf("%02x", t->payload[i]);
+    printf("\n");
+}
+
+static void on_frame(void* ctx, const uint8_t* msg, size_t len) {
+    standin_t* s = ctx;
+    mesh_to_radio_t t;
+
+    if (mesh_decode_to_radio(msg, len, &t) != 0) {
+        printf("malformed ToRadio (%zu bytes)\n", len);
+        return;
+    }
+    if (t.want_config_id) {
+        uint8_t reply[16];
+        size_t n = mesh_encode_config_complete(t.want_config_id, reply);
+        if (write(s->master, reply, n) != (ssize_t)n) perror("reply");
+        printf("want_config %08x\n", t.want_config_id);
+        return;
+    }
+    if (!t.is_packet) return;
+
+    s->packets++;
+    printf("packet id=%08x to=%s ch=%u hops=%u port=%u len=%zu: ", t.id,
+           t.to == MESH_SERIAL_BROADCAST ? "^all" : "node", t.channel,
+           t.hop_limit, t.portnum, t.payload_len);
+    print_payload(s, &t);
+    if (s->limit && s->packets >= s->limit) running = 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-l link] [-n packets]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    const char* link_path = NULL;
+    standin_t s = {.master = -1};
+    mesh_report_stream_init(&s.reports, 1);
+    int opt;
+    while ((opt = getopt(argc, argv, "l:n:h")) != -1) {
+        switch (opt) {
+        case 'l': link_path = optarg; break;
+        case 'n': s.limit = strtoul(optarg, NULL, 10); break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    s.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (s.master < 0 || grantpt(s.master) != 0 || unlockpt(s.master) != 0) {
+        perror("pty");
+        return 1;
+    }
+    const char* slave_path = ptsname(s.master);
+
+    /* Hold the slave open so the master does not see a hang-up between
+     * clients, and start it raw so nothing is echoed back. */
+    int slave = open(slave_path, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+        perror(slave_path);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(slave_path, link_path) != 0) {
+            perror(link_path);
+            return 1;
+        }
+    }
+    printf("Stand-in node on %s%s%s\n", slave_path, link_path ? " -> " : "",
+           link_path ? link_path : "");
+
+    mesh_frame_reader_t rx = {0};
+    while (running) {
+        struct pollfd pfd = {.fd = s.master, .events = POLLIN};
+        if (poll(&pfd, 1, 1000) <= 0) continue;
+
+        uint8_t buf[512];
+        ssize_t n = read(s.master, buf, sizeof(buf));
+        if (n < 0 && errno != EINTR && errno != EAGAIN) {
+            perror("read");
+            break;
+        }
+        if (n > 0) mesh_frame_reader_feed(&rx, buf, (size_t)n, on_frame, &s);
+    }
+
+    printf("%lu packets, %llu frames, %llu bytes outside frames\n", s.packets,
+           (unsigned long long)rx.frames, (unsigned long long)rx.noise);
+    if (link_path) unlink(link_path);
+    close(slave);
+    close(s.master);
+    return 0;
+}
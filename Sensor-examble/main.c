@@ -6,12 +6,24 @@
 #include <signal.h>
 #include <math.h>   // isnan
 
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
 #include "sensirion_i2c_hal.h"
 #include "sfa3x_i2c.h"
 #include "scd30_i2c.h"
 #include "sen44_i2c.h"
 #include "sen66_i2c.h"
 #include "sen5x_i2c.h"
+#include "event_loop.h"
+#include "sensor_bringup.h"
+#include "sensor_sched.h"
+
+/* Retry step while a sample is late, and the longest single sleep */
+#define SENSOR_POLL_MS      50
+#define SENSOR_MAX_SLEEP_MS 1000
+
+/* SEN55 temperature compensation, applied at start-up */
+#define SEN5X_TEMP_OFFSET   0.0f
 
 static volatile sig_atomic_t running = 1;
 
@@ -47,121 +59,179 @@ static inline void print_temp(float c) {
     }
 }
 
+/* ---------- Sensor readers (called when a sample is ready) ---------- */
+
+/* One "--- time ---" header per second in which samples arrived. */
+static void print_header(void) {
+    static time_t last;
+    time_t now = time(NULL);
+    if (now == last) return;
+    last = now;
+
+    char timestamp[32];
+    get_local_timestamp(timestamp, sizeof(timestamp));
+    printf("\n--- %s ---\n", timestamp);
+}
+
+static int16_t read_sfa3x(void* ctx) {
+    (void)ctx;
+    float hcho = 0.0f, sfa_hum = 0.0f, sfa_temp = 0.0f;
+    int16_t err = sfa3x_read_measured_values(&hcho, &sfa_hum, &sfa_temp);
+    if (err) return err;
+    print_header();
+    printf("SFA3X -> HCHO: %.2f ppb, Humidity: %.2f %%, ", hcho, sfa_hum);
+    print_temp(sfa_temp);
+    printf("\n");
+    return NO_ERROR;
+}
+
+static int16_t read_scd30(void* ctx) {
+    (void)ctx;
+    float co2 = 0.0f, scd_temp = 0.0f, scd_hum = 0.0f;
+    int16_t err = scd30_read_measurement_data(&co2, &scd_temp, &scd_hum);
+    if (err) return err;
+    print_header();
+    printf("SCD30 -> CO2: %.2f ppm, ", co2);
+    print_temp(scd_temp);
+    printf(", Humidity: %.2f %%\n", scd_hum);
+    return NO_ERROR;
+}
+
+static int16_t read_sen44(void* ctx) {
+    (void)ctx;
+    uint16_t pm1p0_44 = 0, pm2p5_44 = 0, pm4p0_44 = 0, pm10p0_44 = 0;
+    float voc_44 = 0.0f, hum_44 = 0.0f, temp_44 = 0.0f;
+    int16_t err = sen44_read_measured_mass_concentration_and_ambient_values(
+        &pm1p0_44, &pm2p5_44, &pm4p0_44, &pm10p0_44,
+        &voc_44, &hum_44, &temp_44);
+    if (err) return err;
+    print_header();
+    printf(
+        "SEN44 -> PM1.0: %u, PM2.5: %u, PM4.0: %u, PM10: %u µg/m³, "
+        "VOC: %.2f, Hum: %.2f, ",
+        pm1p0_44, pm2p5_44, pm4p0_44, pm10p0_44,
+        voc_44, hum_44
+    );
+    print_temp(temp_44);
+    printf("\n");
+    return NO_ERROR;
+}
+
+static int16_t read_sen66(void* ctx) {
+    (void)ctx;
+    float pm1p0_66 = 0.0f, pm2p5_66 = 0.0f, pm4p0_66 = 0.0f, pm10p0_66 = 0.0f;
+    float hum_66 = 0.0f, temp_66 = 0.0f, voc_66 = 0.0f, nox_66 = 0.0f;
+    uint16_t co2_66 = 0;
+    int16_t err = sen66_read_measured_values(
+        &pm1p0_66, &pm2p5_66, &pm4p0_66, &pm10p0_66,
+        &hum_66, &temp_66, &voc_66, &nox_66, &co2_66);
+    if (err) return err;
+    print_header();
+    printf(
+        "SEN66 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³, "
+        "Hum: %.2f, ",
+        pm1p0_66, pm2p5_66, pm4p0_66, pm10p0_66,
+        hum_66
+    );
+    print_temp(temp_66);
+    printf(", VOC: %.2f, NOx: %.2f, CO2: %u\n",
+           voc_66, nox_66, co2_66);
+    return NO_ERROR;
+}
+
+static int16_t read_sen5x(void* ctx) {
+    (void)ctx;
+    float pm1p0_5x = 0.0f, pm2p5_5x = 0.0f, pm4p0_5x = 0.0f, pm10p0_5x = 0.0f;
+    float hum_5x = 0.0f, temp_5x = 0.0f, voc_5x = 0.0f, nox_5x = 0.0f;
+    int16_t err = sen5x_read_measured_values(
+        &pm1p0_5x, &pm2p5_5x, &pm4p0_5x, &pm10p0_5x,
+        &hum_5x, &temp_5x, &voc_5x, &nox_5x);
+    if (err) return err;
+    print_header();
+    printf(
+        "SEN55 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³, "
+        "Hum: %.2f, ",
+        pm1p0_5x, pm2p5_5x, pm4p0_5x, pm10p0_5x,
+        hum_5x
+    );
+    print_temp(temp_5x);
+    printf(", VOC: %.2f, NOx: %.2f\n", voc_5x, nox_5x);
+    return NO_ERROR;
+}
+
 /* ---------- Main ---------- */
 
+/* SEN55 start step: temperature offset first, then measure */
+static int16_t start_sen5x(void* ctx) {
+    (void)ctx;
+    sen5x_set_temperature_offset_simple(SEN5X_TEMP_OFFSET);
+    return sen5x_start_measurement();
+}
+
 int main(void) {
     setvbuf(stdout, NULL, _IOLBF, 0);
     signal(SIGINT, handle_signal);
     signal(SIGTERM, handle_signal);
 
+    /* --- CRC tables vs. bitwise reference --- */
+    if (sensirion_i2c_crc_self_test() != NO_ERROR) {
+        fprintf(stderr, "CRC self-test failed\n");
+        return 1;
+    }
+
     /* --- I2C init --- */
     sensirion_i2c_hal_init();
 
-    /* --- SFA3X --- */
+    /* --- Sensor bring-up: all resets at once, each sensor starts when ready --- */
     sfa3x_init(SFA3X_I2C_ADDR_5D);
-    sfa3x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    sfa3x_start_continuous_measurement();
-
-    /* --- SCD30 --- */
     scd30_init(SCD30_I2C_ADDR_61);
-    scd30_stop_periodic_measurement();
-    scd30_soft_reset();
-    sensirion_i2c_hal_sleep_usec(2000000);
-    scd30_start_periodic_measurement(0);
-
-    /* --- SEN44 --- */
-    sen44_device_reset();
-    sen44_start_measurement();
-
-    /* --- SEN66 --- */
     sen66_init(SEN66_I2C_ADDR_6B);
-    sen66_device_reset();
-    sensirion_i2c_hal_sleep_usec(1200000);
-    sen66_start_continuous_measurement();
 
-    /* --- SEN55 (SEN5x) --- */
-    sen5x_device_reset();
-    sensirion_i2c_hal_sleep_usec(1000000);
-    sen5x_set_temperature_offset_simple(0.0f);
-    sen5x_start_measurement();
+    sensor_bringup_t bringup;
+    sensor_bringup_init(&bringup);
+    sensor_bringup_add(&bringup, "SFA3X", sensor_bringup_sfa3x_reset,
+                       SFA3X_DEVICE_RESET_USEC, sensor_bringup_sfa3x_start, NULL);
+    sensor_bringup_add(&bringup, "SCD30", sensor_bringup_scd30_reset,
+                       SCD30_SOFT_RESET_USEC, sensor_bringup_scd30_start, NULL);
+    sensor_bringup_add(&bringup, "SEN44", sensor_bringup_sen44_reset,
+                       SEN44_DEVICE_RESET_USEC, sensor_bringup_sen44_start, NULL);
+    sensor_bringup_add(&bringup, "SEN66", sensor_bringup_sen66_reset,
+                       SEN66_DEVICE_RESET_USEC, sensor_bringup_sen66_start, NULL);
+    sensor_bringup_add(&bringup, "SEN55", sensor_bringup_sen5x_reset,
+                       SEN5X_DEVICE_RESET_USEC, start_sen5x, NULL);
+    int failed = sensor_bringup_run(&bringup);
+    if (failed) fprintf(stderr, "%d sensor(s) failed to start\n", failed);
 
     printf("Starting multi-sensor measurement loop...\n");
 
-    while (running) {
-        sensirion_i2c_hal_sleep_usec(1000000);
-
-        char timestamp[32];
-        get_local_timestamp(timestamp, sizeof(timestamp));
-        printf("\n--- %s ---\n", timestamp);
-
-        /* --- SFA3X --- */
-        float hcho = 0.0f, sfa_hum = 0.0f, sfa_temp = 0.0f;
-        if (!sfa3x_read_measured_values(&hcho, &sfa_hum, &sfa_temp)) {
-            printf("SFA3X -> HCHO: %.2f ppb, Humidity: %.2f %%, ",
-                   hcho, sfa_hum);
-            print_temp(sfa_temp);
-            printf("\n");
-        }
-
-        /* --- SCD30 --- */
-        float co2 = 0.0f, scd_temp = 0.0f, scd_hum = 0.0f;
-        if (!scd30_blocking_read_measurement_data(&co2, &scd_temp, &scd_hum)) {
-            printf("SCD30 -> CO2: %.2f ppm, ", co2);
-            print_temp(scd_temp);
-            printf(", Humidity: %.2f %%\n", scd_hum);
-        }
-
-        /* --- SEN44 --- */
-        uint16_t pm1p0_44 = 0, pm2p5_44 = 0, pm4p0_44 = 0, pm10p0_44 = 0;
-        float voc_44 = 0.0f, hum_44 = 0.0f, temp_44 = 0.0f;
-        if (!sen44_read_measured_mass_concentration_and_ambient_values(
-                &pm1p0_44, &pm2p5_44, &pm4p0_44, &pm10p0_44,
-                &voc_44, &hum_44, &temp_44)) {
-            printf(
-                "SEN44 -> PM1.0: %u, PM2.5: %u, PM4.0: %u, PM10: %u µg/m³, "
-                "VOC: %.2f, Hum: %.2f, ",
-                pm1p0_44, pm2p5_44, pm4p0_44, pm10p0_44,
-                voc_44, hum_44
-            );
-            print_temp(temp_44);
-            printf("\n");
-        }
-
-        /* --- SEN66 --- */
-        float pm1p0_66 = 0.0f, pm2p5_66 = 0.0f, pm4p0_66 = 0.0f, pm10p0_66 = 0.0f;
-        float hum_66 = 0.0f, temp_66 = 0.0f, voc_66 = 0.0f, nox_66 = 0.0f;
-        uint16_t co2_66 = 0;
-        if (!sen66_read_measured_values(
-                &pm1p0_66, &pm2p5_66, &pm4p0_66, &pm10p0_66,
-                &hum_66, &temp_66, &voc_66, &nox_66, &co2_66)) {
-            printf(
-                "SEN66 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³, "
-                "Hum: %.2f, ",
-                pm1p0_66, pm2p5_66, pm4p0_66, pm10p0_66,
-                hum_66
-            );
-            print_temp(temp_66);
-            printf(", VOC: %.2f, NOx: %.2f, CO2: %u\n",
-                   voc_66, nox_66, co2_66);
-        }
+    /* --- Data-ready scheduling (SFA3X has no flag, read per interval) --- */
+    sensor_sched_t sched;
+    sensor_sched_init(&sched, SENSOR_POLL_MS, SENSOR_MAX_SLEEP_MS);
+    sensor_sched_add(&sched, "SFA3X", 1000, NULL, read_sfa3x, NULL);
+    sensor_sched_add(&sched, "SCD30", 2000, sensor_sched_scd30_ready,
+                     read_scd30, NULL);
+    sensor_sched_add(&sched, "SEN44", 1000, sensor_sched_sen44_ready,
+                     read_sen44, NULL);
+    sensor_sched_add(&sched, "SEN66", 1000, sensor_sched_sen66_ready,
+                     read_sen66, NULL);
+    sensor_sched_add(&sched, "SEN55", 1000, sensor_sched_sen5x_ready,
+                     read_sen5x, NULL);
+
+    /* --- Event loop: sensor deadlines on absolute timers --- */
+    event_loop_t loop;
+    if (event_loop_init(&loop) != 0 || sensor_sched_attach(&sched, &loop) != 0) {
+        perror("event loop");
+        return 1;
+    }
 
-        /* --- SEN55 --- */
-        float pm1p0_5x = 0.0f, pm2p5_5x = 0.0f, pm4p0_5x = 0.0f, pm10p0_5x = 0.0f;
-        float hum_5x = 0.0f, temp_5x = 0.0f, voc_5x = 0.0f, nox_5x = 0.0f;
-        if (!sen5x_read_measured_values(
-                &pm1p0_5x, &pm2p5_5x, &pm4p0_5x, &pm10p0_5x,
-                &hum_5x, &temp_5x, &voc_5x, &nox_5x)) {
-            printf(
-                "SEN55 -> PM1.0: %.2f, PM2.5: %.2f, PM4.0: %.2f, PM10: %.2f µg/m³, "
-                "Hum: %.2f, ",
-                pm1p0_5x, pm2p5_5x, pm4p0_5x, pm10p0_5x,
-                hum_5x
-            );
-            print_temp(temp_5x);
-            printf(", VOC: %.2f, NOx: %.2f\n", voc_5x, nox_5x);
+    int first_pending = 1;
+    while (running) {
+        event_loop_run_once(&loop, -1);
+        if (first_pending) {
+            first_pending = sensor_bringup_report(&bringup, &sched, stdout);
         }
     }
+    event_loop_close(&loop);
 
     printf("Stopping measurements...\n");
     sfa3x_stop_measurement();
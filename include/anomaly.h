@@ -0,0 +1,73 @@
+#ifndef ANOMALY_H
+#define ANOMALY_H
+
+#include <stdint.h>
+
+/*
+ * Streaming anomaly detector, one per channel. An EWMA of the value and
+ * of its variance gives the channel's own baseline and noise level, so
+ * the alarm thresholds are in standard deviations rather than fixed
+ * units: noisy PM needs a bigger jump than steady temperature. Two
+ * alarms on top of that:
+ *
+ *   spike  one sample more than spike_sigmas from the baseline
+ *   drift  a two-sided CUSUM of the standardized error crossing h, i.e.
+ *          a slow climb (CO2 in a closed room) that never jumps
+ *
+ * State is five numbers and one update is a handful of float operations,
+ * so every channel can run on every sample. Unknown values (NaN) are
+ * skipped.
+ */
+
+typedef struct {
+    float alpha;             /* EWMA weight of a new sample (0..1) */
+    float spike_sigmas;      /* one-sample jump that is a spike */
+    float cusum_k;           /* CUSUM slack, in sigmas */
+    float cusum_h;           /* CUSUM alarm level, in sigmas */
+    float min_sigma;         /* noise floor in channel units (resolution) */
+    uint32_t warmup;         /* samples before the first alarm */
+} anomaly_config_t;
+
+/* Baseline and noise over ~1/alpha samples; 5-sigma spikes; CUSUM k 0.5,
+ * h 8 (no false alarm in 50k samples of white noise at alpha 0.05);
+ * min_sigma as given. */
+anomaly_config_t anomaly_config_default(float alpha, float min_sigma,
+                                        uint32_t warmup);
+
+typedef struct {
+    float mean;
+    float var;
+    float cusum_hi;
+    float cusum_lo;
+    uint32_t n;              /* samples seen */
+} anomaly_state_t;
+
+typedef enum {
+    ANOMALY_NONE,
+    ANOMALY_SPIKE_UP,
+    ANOMALY_SPIKE_DOWN,
+    ANOMALY_DRIFT_UP,
+    ANOMALY_DRIFT_DOWN,
+} anomaly_kind_t;
+
+typedef struct {
+    anomaly_kind_t kind;
+    uint8_t severity;        /* 1 minor, 2 major, 3 critical */
+    float score;             /* how far past the threshold: 1.0 = at it */
+    float value;
+    float baseline;          /* mean before this sample */
+    float sigma;
+} anomaly_event_t;
+
+void anomaly_reset(anomaly_state_t* s);
+
+/* Feed one value. Returns 1 and fills ev on an alarm, else 0. A spike
+ * wins over a drift on the same sample; a drift alarm restarts its
+ * CUSUM. */
+int anomaly_update(anomaly_state_t* s, const anomaly_config_t* c, float x,
+                   anomaly_event_t* ev);
+
+/* "spike up", "drift down", ... */
+const char* anomaly_kind_name(anomaly_kind_t kind);
+
+#endif
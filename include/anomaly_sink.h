@@ -0,0 +1,43 @@
+#ifndef ANOMALY_SINK_H
+#define ANOMALY_SINK_H
+
+#include <stdint.h>
+
+#include "anomaly.h"
+#include "sample_ring.h"
+#include "sample_sink.h"
+
+/*
+ * Anomaly detection as a sample sink: one detector (anomaly.h) per
+ * channel of the store, fed every sample, printing an alarm line such as
+ *
+ *   ANOMALY sen66 co2: drift up to 812 (baseline 640.3 +/- 12.1), severity 2
+ *
+ * Each channel's noise floor is noise_ticks steps of its resolution.
+ * The detectors can live in a ring file (ring_file.h), so a restart
+ * carries on with the baselines it had instead of warming up again.
+ */
+
+typedef struct {
+    float alpha;             /* EWMA weight per sample */
+    uint32_t warmup;         /* samples before the first alarm */
+    float noise_ticks;       /* noise floor, in raw ticks */
+    anomaly_state_t* state;  /* SAMPLE_STORE_MAX detectors kept elsewhere,
+                                NULL: in the sink */
+} anomaly_sink_config_t;
+
+typedef struct {
+    anomaly_config_t cfg[SAMPLE_STORE_MAX];     /* by store channel id */
+    anomaly_state_t own[SAMPLE_STORE_MAX];
+    anomaly_state_t* state;                     /* own, or the config's */
+    uint8_t ready[SAMPLE_STORE_MAX];            /* cfg[] filled in */
+    anomaly_sink_config_t sink_cfg;
+    uint64_t events;
+} anomaly_sink_t;
+
+void anomaly_sink_init(anomaly_sink_t* a, const anomaly_sink_config_t* cfg);
+
+/* state: anomaly_sink_t* set up with anomaly_sink_init() */
+extern const sample_sink_ops_t anomaly_sink_ops;
+
+#endif
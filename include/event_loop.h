@@ -0,0 +1,67 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+
+/*
+ * Single-threaded epoll loop. Timers are timerfds armed at absolute
+ * CLOCK_MONOTONIC deadlines, so periodic work does not drift by however
+ * long each round took, and nothing wakes the process while idle. Other
+ * descriptors (sockets, a serial port) can sit in the same set.
+ */
+
+#define EVENT_LOOP_MAX 16
+
+/* Timer fired; expirations > 1 means rounds were missed. */
+typedef void (*event_loop_timer_fn)(void* ctx, uint64_t expirations);
+
+/* Descriptor ready; events is the EPOLL* mask that fired. */
+typedef void (*event_loop_io_fn)(void* ctx, int fd, uint32_t events);
+
+typedef struct {
+    int fd;                  /* -1: free slot */
+    int is_timer;            /* fd is a timerfd owned by the loop */
+    event_loop_timer_fn on_timer;
+    event_loop_io_fn on_io;
+    void* ctx;
+} event_loop_source_t;
+
+typedef struct {
+    int epfd;
+    event_loop_source_t sources[EVENT_LOOP_MAX];
+    unsigned count;
+} event_loop_t;
+
+/* Returns 0, or -1 with errno set. */
+int event_loop_init(event_loop_t* ev);
+void event_loop_close(event_loop_t* ev);
+
+/* Microseconds on CLOCK_MONOTONIC, the clock timers are armed against. */
+uint64_t event_loop_now_usec(void);
+
+/* Watch fd for events (EPOLLIN, ...). The caller keeps ownership of fd.
+ * Returns the source id, or -1. */
+int event_loop_add_fd(event_loop_t* ev, int fd, uint32_t events,
+                      event_loop_io_fn fn, void* ctx);
+
+/* Stop watching a descriptor added with event_loop_add_fd(), e.g. before
+ * closing it; the id may be handed out again. Returns 0, or -1. */
+int event_loop_remove(event_loop_t* ev, int id);
+
+/* New disarmed timer; fn may be NULL when the caller only needs the wake-up.
+ * Returns the source id, or -1. */
+int event_loop_add_timer(event_loop_t* ev, event_loop_timer_fn fn, void* ctx);
+
+/* Fire once at deadline_usec (event_loop_now_usec() time base); a
+ * deadline in the past fires at once. */
+int event_loop_arm_at(event_loop_t* ev, int id, uint64_t deadline_usec);
+
+/* Fire every period_usec, the first time one period from now. */
+int event_loop_arm_periodic(event_loop_t* ev, int id, uint64_t period_usec);
+
+/* Wait up to timeout_ms (-1: forever) and dispatch what is ready. Returns
+ * the number of sources dispatched; 0 on timeout or when a signal cut the
+ * wait short, -1 on error. */
+int event_loop_run_once(event_loop_t* ev, int timeout_ms);
+
+#endif
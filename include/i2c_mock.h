@@ -0,0 +1,60 @@
+#ifndef I2C_MOCK_H
+#define I2C_MOCK_H
+
+#include <stdint.h>
+
+/*
+ * In-memory stand-in for sensirion_i2c_hal.c. Link src/i2c_mock.c instead
+ * of the real HAL (make HAL=i2c_mock) and the drivers talk to simulated
+ * sensors that answer their command sets with CRC'd frames.
+ *
+ * Devices are keyed by (bus, address); the sensirion_i2c_hal_* calls go
+ * to the currently selected bus, the _fd variants take the bus number as
+ * the fd (sensirion_i2c_hal_open_bus(n) returns n once a device sits on
+ * bus n). If nothing was added by the time sensirion_i2c_hal_init() runs,
+ * bus 0 gets the default rig: SCD30 at 0x61, SEN5x at 0x69, SEN66 at 0x6B
+ * and SFA3x at 0x5D.
+ */
+
+typedef enum {
+    I2C_MOCK_SCD30,
+    I2C_MOCK_SEN44,
+    I2C_MOCK_SEN5X,
+    I2C_MOCK_SEN66,
+    I2C_MOCK_SFA3X,
+} i2c_mock_sensor_t;
+
+typedef struct {
+    uint32_t latency_usec;   /* added to every transfer */
+    uint32_t nack_ppm;       /* transfers NACKed, per million */
+    uint32_t crc_ppm;        /* response words sent with a bad CRC, per million */
+    uint32_t seed;           /* error injection and sample noise */
+    int virtual_time;        /* sleeps and latency advance a simulated clock;
+                                event_loop timers keep real time */
+} i2c_mock_config_t;
+
+typedef struct {
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t bytes;
+    uint64_t nacks;          /* injected */
+    uint64_t crc_faults;     /* injected */
+    uint64_t rejected;       /* unknown command, bad argument CRC, bad length */
+} i2c_mock_stats_t;
+
+/* Call before sensirion_i2c_hal_init(); the default is no latency, no
+ * errors and real time. */
+void i2c_mock_configure(const i2c_mock_config_t* cfg);
+
+/* Returns 0, or -1 if the address is taken or out of memory. */
+int i2c_mock_add_sensor(unsigned bus, uint8_t address, i2c_mock_sensor_t type);
+
+/* Route subsequent HAL transfers to this bus. */
+void i2c_mock_select_bus(unsigned bus);
+
+void i2c_mock_get_stats(i2c_mock_stats_t* out);
+
+/* Remove every device and clear the counters. */
+void i2c_mock_reset(void);
+
+#endif
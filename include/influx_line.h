@@ -0,0 +1,53 @@
+#ifndef INFLUX_LINE_H
+#define INFLUX_LINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Line-protocol encoder.
+ *
+ * Points are written straight into a caller-owned arena (one line or a
+ * whole batch) without allocating and without printf: fixed-point values
+ * are turned into decimals with integer arithmetic, and names are escaped
+ * as the protocol requires (measurement: comma and space; tag keys, tag
+ * values and field keys: comma, equals sign and space).
+ *
+ *   influx_line_begin(&lp, "sen66");
+ *   influx_line_tag(&lp, "device", "SEN66");
+ *   influx_line_field_fixed(&lp, "pm2_5", 79, 10, 1);
+ *   influx_line_end(&lp, ts_ms);     -> sen66,device=SEN66 pm2_5=7.9 <ts>
+ *
+ * Lines are separated by newlines and the arena is kept NUL-terminated,
+ * so a one-line arena can go to influx_sender_push() as it is. A line
+ * that does not fit is rolled back whole and end() reports it, so the
+ * arena only ever holds complete lines.
+ */
+
+typedef struct {
+    char* buf;
+    size_t cap;
+    size_t len;             /* bytes of complete lines, excluding the NUL */
+    size_t pos;             /* write position in the open line */
+    unsigned fields;        /* fields in the open line */
+    int overflow;
+} influx_line_t;
+
+void influx_line_init(influx_line_t* lp, char* buf, size_t cap);
+
+/* Drop every line. */
+void influx_line_reset(influx_line_t* lp);
+
+void influx_line_begin(influx_line_t* lp, const char* measurement);
+void influx_line_tag(influx_line_t* lp, const char* key, const char* value);
+
+/* value / scale with `decimals` digits (at most 4), a float field. */
+void influx_line_field_fixed(influx_line_t* lp, const char* key,
+                             int32_t value, uint16_t scale, uint8_t decimals);
+
+/* Close the line with a timestamp in the write URL's precision. Returns
+ * 0, or -1 if the line did not fit or has no fields (it is then
+ * discarded). */
+int influx_line_end(influx_line_t* lp, uint64_t timestamp);
+
+#endif
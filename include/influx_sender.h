@@ -0,0 +1,80 @@
+#ifndef INFLUX_SENDER_H
+#define INFLUX_SENDER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "influx_writer.h"
+#include "spool.h"
+#include "spsc_ring.h"
+
+/*
+ * Background InfluxDB sender.
+ *
+ * The acquisition loop pushes lines into a lock-free SPSC ring and never
+ * touches the network; a sender thread drains the ring into an
+ * influx_writer_t. Batches that fail to send go to an on-disk spool, and
+ * when the ring is full the line is either dropped or spilled to the same
+ * spool. The spool is replayed in large batches once InfluxDB answers
+ * again.
+ */
+
+#define INFLUX_SENDER_LINE_MAX 512
+
+typedef enum {
+    INFLUX_QUEUE_DROP = 0,  /* count and discard lines that do not fit */
+    INFLUX_QUEUE_SPILL,     /* append them to the spool for later replay */
+} influx_queue_policy_t;
+
+typedef struct {
+    influx_writer_config_t writer;
+    uint32_t queue_lines;           /* ring capacity in lines */
+    influx_queue_policy_t policy;
+    spool_config_t spool;           /* spool.dir NULL: no spool */
+    uint32_t replay_batches;        /* spool batches sent per wake-up */
+} influx_sender_config_t;
+
+typedef struct {
+    uint64_t pushed;        /* lines accepted into the ring */
+    uint64_t dropped;       /* lines lost because the ring was full */
+    uint64_t spilled;       /* lines written to the spool on overflow */
+    uint32_t depth;         /* lines currently queued */
+    uint32_t max_depth;     /* high-water mark since start */
+} influx_sender_stats_t;
+
+typedef struct {
+    influx_sender_config_t cfg;
+    influx_writer_t writer;
+    spsc_ring_t ring;
+    sem_t wake;
+    pthread_t thread;
+    atomic_int stop;
+
+    spool_t spool;
+    int have_spool;
+
+    /* counters, each written by one side and read by both */
+    _Atomic uint64_t pushed, dropped, spilled;
+    _Atomic uint32_t max_depth;
+    uint64_t report_usec;   /* sender thread only */
+} influx_sender_t;
+
+/* Start the sender thread. Returns 0 on success, -1 on failure. */
+int influx_sender_start(influx_sender_t* s, const influx_sender_config_t* cfg);
+
+/* Queue one line; never blocks on the network. Returns 0 if queued or
+ * spilled, -1 if dropped. Producer thread only. */
+int influx_sender_push(influx_sender_t* s, const char* line);
+
+/* Close the current sweep and wake the sender. Producer thread only. */
+void influx_sender_end_tick(influx_sender_t* s);
+
+/* Snapshot of the queue counters. */
+void influx_sender_get_stats(influx_sender_t* s, influx_sender_stats_t* out);
+
+/* Drain the ring, flush and join the thread. */
+void influx_sender_stop(influx_sender_t* s);
+
+#endif
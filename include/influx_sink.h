@@ -0,0 +1,42 @@
+#ifndef INFLUX_SINK_H
+#define INFLUX_SINK_H
+
+#include "influx_sender.h"
+#include "sample_sink.h"
+
+/*
+ * InfluxDB as a sample sink: each sample becomes one line, queued on the
+ * sink's own influx_sender (ring, sender thread, batching, spool). v2 and
+ * 1.8 differ only in the sender's URL and token, and in how the bucket
+ * names its fields and tags.
+ */
+
+/* Field names for one measurement, in the channel order of the
+ * sensor_ticks_add_*() call. */
+typedef struct {
+    const char* sensor;
+    const char* const* fields;
+} influx_sink_fields_t;
+
+typedef struct {
+    influx_sender_config_t sender;
+    /* tag key carrying the sensor name in capitals ("SEN66"), NULL: none */
+    const char* device_tag;
+    /* per-measurement field names, ended by {NULL, NULL}; measurements not
+     * listed (or NULL) keep the channel names */
+    const influx_sink_fields_t* fields;
+} influx_sink_config_t;
+
+typedef struct {
+    influx_sink_config_t cfg;
+    influx_sender_t sender;
+    char line[INFLUX_SENDER_LINE_MAX];
+} influx_sink_t;
+
+/* Start the sink's sender thread. Returns 0, or -1 on failure. */
+int influx_sink_start(influx_sink_t* k, const influx_sink_config_t* cfg);
+
+/* state: influx_sink_t* started with influx_sink_start() */
+extern const sample_sink_ops_t influx_sink_ops;
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef INFLUX_WRITER_H
+#define INFLUX_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <curl/curl.h>
+#include <zlib.h>
+
+/*
+ * Batched InfluxDB line-protocol writer.
+ *
+ * Lines are appended to one body and POSTed together through a single
+ * curl easy handle that is kept alive for the lifetime of the writer, so
+ * DNS, TCP setup and the header list are paid once instead of per point.
+ * A batch is flushed when it has collected max_ticks sweeps, when the next
+ * line would not fit in max_bytes, or when the oldest line is older than
+ * max_age_ms.
+ *
+ * With gzip_level set, bodies of at least gzip_min_bytes are deflated
+ * through one reused z_stream and sent with Content-Encoding: gzip, which
+ * both /api/v2/write and the 1.x /write accept. Smaller bodies, and any
+ * body that does not shrink, go out as they are.
+ */
+
+/* influx_writer_post() results */
+#define INFLUX_WRITE_OK 0
+#define INFLUX_WRITE_RETRY -1     /* transport error, 429 or 5xx */
+#define INFLUX_WRITE_REJECTED -2  /* other 4xx: resending will not help */
+
+typedef struct {
+    const char* url;        /* full write URL incl. query (org/bucket/db) */
+    const char* token;      /* v2 API token, NULL for unauthenticated 1.x */
+    long timeout_ms;        /* per-request timeout */
+    size_t max_bytes;       /* body capacity, flush before exceeding it */
+    uint32_t max_ticks;     /* sweeps gathered per POST (>= 1) */
+    uint32_t max_age_ms;    /* flush if oldest pending line is this old */
+    int gzip_level;         /* 1-9, 0: never compress */
+    size_t gzip_min_bytes;  /* smaller bodies are sent uncompressed */
+    /* optional: receives a batch that failed with INFLUX_WRITE_RETRY
+     * instead of dropping it */
+    void (*on_failed)(void* ctx, const char* body, size_t len);
+    void* on_failed_ctx;
+} influx_writer_config_t;
+
+typedef struct {
+    uint64_t lines;         /* lines accepted */
+    uint64_t posts;         /* HTTP requests issued */
+    uint64_t failed_posts;  /* requests that failed (transport or HTTP) */
+    uint64_t bytes;         /* body bytes sent */
+    uint64_t wire_bytes;    /* of which on the wire, after gzip */
+} influx_writer_stats_t;
+
+typedef struct {
+    influx_writer_config_t cfg;
+    CURL* curl;
+    struct curl_slist* headers;
+    struct curl_slist* gzip_headers;
+    z_stream zs;
+    int have_zs;
+    unsigned char* zbody;   /* deflate output, grown to fit */
+    size_t zcap;
+    char* body;
+    size_t len;
+    uint32_t ticks;
+    uint64_t oldest_usec;
+    int last_ok;            /* server reachable on the most recent POST */
+    influx_writer_stats_t total;
+    influx_writer_stats_t window;
+    uint64_t window_start_usec;
+} influx_writer_t;
+
+/* Allocate the body buffer and set up the persistent curl handle.
+ * Returns 0 on success, -1 on failure. */
+int influx_writer_init(influx_writer_t* w, const influx_writer_config_t* cfg);
+
+/* Append one line (without trailing newline). Flushes first if the line
+ * would not fit. Returns 0 on success, -1 if the line was dropped. */
+int influx_writer_add_line(influx_writer_t* w, const char* line);
+
+/* Mark the end of one sensor sweep. Flushes when max_ticks or max_age_ms
+ * is reached and prints the per-minute round-trip summary when due. */
+int influx_writer_end_tick(influx_writer_t* w);
+
+/* Flush on max_ticks / max_age_ms and print the minute summary when due,
+ * without closing a sweep. For callers that wake up on a timer. */
+int influx_writer_poll(influx_writer_t* w);
+
+/* POST whatever is pending. Returns 0 on success or if nothing was
+ * pending, -1 if the request failed. A retryable failure goes to
+ * on_failed if set; everything else is discarded. */
+int influx_writer_flush(influx_writer_t* w);
+
+/* POST a ready-made body (newline-terminated lines) on the same handle,
+ * bypassing the batch buffer and on_failed. Returns an INFLUX_WRITE_*
+ * code. */
+int influx_writer_post(influx_writer_t* w, const char* body, size_t len);
+
+/* Flush pending lines and release the handle and buffers. */
+void influx_writer_free(influx_writer_t* w);
+
+#endif
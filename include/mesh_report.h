@@ -0,0 +1,140 @@
+#ifndef MESH_REPORT_H
+#define MESH_REPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sample_ring.h"
+
+/*
+ * Compact binary report: every sensor's values from one cycle in a single
+ * mesh packet, sent on MESH_PORT_PRIVATE instead of one text message per
+ * sensor. Values travel as the sensor's own 16-bit integer ticks (the
+ * scales of sensor_ticks.h), so nothing is rounded on the way.
+ *
+ *   byte 0   version << 4 | kind          (MESH_REPORT_VERSION, KIND_FULL)
+ *   byte 1   sequence number, +1 per report
+ *   byte 2   presence bitmap, bit n = sensor slot n below
+ *   then     for each present sensor in slot order, all of its channels
+ *            as little-endian uint16 ticks; a value the sensor did not
+ *            have is sent as its "unknown" marker (0x7FFF signed, 0xFFFF
+ *            unsigned)
+ *
+ * All five sensors come to 63 bytes; the five text messages were ~350.
+ * The slot order and channel layout are part of the wire format and do
+ * not follow renamed fields.
+ *
+ * Between full reports (keyframes) a stream sends deltas: only channels
+ * that moved more than their dead-band since what the receiver last got,
+ * as the difference to the keyframe.
+ *
+ *   byte 0   version << 4 | KIND_DELTA
+ *   byte 1   sequence number
+ *   byte 2   sequence number of the keyframe the deltas are against
+ *   byte 3   bitmap of the sensors that follow
+ *   then     per sensor: a varint channel mask (bit n = channel n), then
+ *            a zigzag varint (value - keyframe value) per channel in it
+ *
+ * A delta is usually 6-10 bytes, and in steady air nothing is sent at all
+ * until the next keyframe. A receiver that missed the keyframe sees the
+ * key sequence number change and waits for the next one.
+ */
+
+#define MESH_REPORT_VERSION 1
+#define MESH_REPORT_KIND_FULL 0
+#define MESH_REPORT_KIND_DELTA 1
+
+/* Sensor slots */
+enum {
+    MESH_REPORT_SCD30,       /* co2 temperature humidity */
+    MESH_REPORT_SEN44,       /* pm1 pm2_5 pm4 pm10 voc humidity temperature */
+    MESH_REPORT_SEN5X,       /* pm1 pm2_5 pm4 pm10 humidity temperature voc nox */
+    MESH_REPORT_SEN66,       /* ... as SEN5X, then co2 */
+    MESH_REPORT_SFA3X,       /* hcho humidity temperature */
+    MESH_REPORT_SENSORS
+};
+
+#define MESH_REPORT_MAX_CHANNELS 9
+#define MESH_REPORT_MAX_BYTES (3 + 2 * 30)
+
+typedef struct {
+    const char* name;        /* as printed, e.g. "SEN66" */
+    const char* model;       /* sensor_ticks_t.model */
+    unsigned count;
+    const sample_channel_t* channels;  /* scale and format only, no ring */
+    const uint16_t* deadband;          /* ticks a delta has to exceed */
+} mesh_report_sensor_t;
+
+extern const mesh_report_sensor_t mesh_report_sensors[MESH_REPORT_SENSORS];
+
+typedef struct {
+    uint8_t kind;            /* MESH_REPORT_KIND_* */
+    uint8_t seq;
+    uint8_t key_seq;         /* delta: keyframe it was taken against */
+    uint8_t present;         /* bit per sensor slot */
+    uint16_t carried[MESH_REPORT_SENSORS];  /* channel mask in the packet */
+    uint16_t raw[MESH_REPORT_SENSORS][MESH_REPORT_MAX_CHANNELS];
+} mesh_report_t;
+
+/* Slot of a sensor_ticks_t.model, or -1. */
+int mesh_report_slot(const char* model);
+
+void mesh_report_clear(mesh_report_t* r);
+
+/* Mark slot present with its channels' ticks. */
+void mesh_report_set(mesh_report_t* r, unsigned slot, const uint16_t* raw);
+
+/* A float reading in the slot's ticks; NaN and out-of-range values
+ * become the "unknown" marker. For programs that read floats. */
+uint16_t mesh_report_ticks(unsigned slot, unsigned channel, float value);
+
+/* A full report. Returns the encoded length, 0 if cap is too small. */
+size_t mesh_report_encode(const mesh_report_t* r, uint8_t* buf, size_t cap);
+
+/* A full report or a delta on its own (deltas are not applied to
+ * anything: raw holds the differences). Returns 0, or -1 if buf is not a
+ * report of this version. */
+int mesh_report_decode(const uint8_t* buf, size_t len, mesh_report_t* out);
+
+/* ---------- Keyframes and deltas ---------- */
+
+/* One side of a report stream: the sender's view of what the receiver
+ * holds, or the receiver's copy of it. */
+typedef struct {
+    mesh_report_t key;       /* last keyframe */
+    mesh_report_t current;   /* key with the deltas since applied */
+    int have_key;
+    uint8_t next_seq;        /* sender */
+    unsigned since_key;      /* sender: reports since the keyframe */
+    unsigned keyframe_every; /* sender: 1 sends keyframes only */
+} mesh_report_stream_t;
+
+void mesh_report_stream_init(mesh_report_stream_t* s, unsigned keyframe_every);
+
+/* Encode this cycle's values: a keyframe when one is due, a sensor
+ * appeared or a value became (un)known, else a delta. r->seq is set.
+ * Returns the length, 0 when nothing moved past its dead-band and there
+ * is nothing to send. */
+size_t mesh_report_stream_encode(mesh_report_stream_t* s, mesh_report_t* r,
+                                 uint8_t* buf, size_t cap);
+
+/* Receiver: decode buf and apply it. out gets the full current values
+ * (kind, seq and carried as received). Returns 0, -1 if buf is not a
+ * report, 1 for a delta against a keyframe this side does not have. */
+int mesh_report_stream_decode(mesh_report_stream_t* s, const uint8_t* buf,
+                              size_t len, mesh_report_t* out);
+
+/* "SEN66 -> pm1: 6.0, ..., temperature: 23.04 C (73.46 F)" for a present
+ * slot, leaving out unknown values. Returns the length (truncated to
+ * fit cap). */
+size_t mesh_report_format(const mesh_report_t* r, unsigned slot, char* buf,
+                          size_t cap);
+
+/* "keyframe 3" or "delta 4 on keyframe 3", then one indented
+ * mesh_report_format() line per sensor the packet carried values for.
+ * `from` and `len` go on the first line when non-NULL / non-zero. */
+void mesh_report_print(const mesh_report_t* r, const char* from, size_t len,
+                       FILE* out);
+
+#endif
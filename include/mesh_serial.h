@@ -0,0 +1,111 @@
+#ifndef MESH_SERIAL_H
+#define MESH_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Native Meshtastic serial transport. The node's USB serial port is
+ * opened once and kept open; packets go out as protobuf ToRadio messages
+ * in the stream framing the firmware expects:
+ *
+ *   0x94 0xC3 <length, big-endian 16 bit> <ToRadio>
+ *
+ * The few protobuf fields needed (ToRadio.packet, MeshPacket to /
+ * channel / decoded / id / hop_limit, Data portnum / payload) are encoded
+ * by hand, so there is no Python, no fork and no protobuf library on the
+ * send path. Incoming FromRadio frames are split out of the stream the
+ * same way and handed to a callback; anything between frames is the
+ * node's debug log and is skipped.
+ */
+
+#define MESH_SERIAL_START1       0x94
+#define MESH_SERIAL_START2       0xC3
+#define MESH_SERIAL_MAX_FRAME    512   /* protobuf bytes per frame */
+#define MESH_SERIAL_PAYLOAD_MAX  233   /* Data.payload limit of the firmware */
+
+#define MESH_SERIAL_BROADCAST    0xFFFFFFFFu
+
+/* PortNum values used here */
+#define MESH_PORT_TEXT_MESSAGE   1
+#define MESH_PORT_PRIVATE        256
+
+/* A complete protobuf message (ToRadio or FromRadio) out of the stream. */
+typedef void (*mesh_serial_frame_fn)(void* ctx, const uint8_t* msg,
+                                     size_t len);
+
+/* Stream splitter, for either direction. */
+typedef struct {
+    uint8_t buf[4 + MESH_SERIAL_MAX_FRAME];
+    size_t len;
+    uint64_t frames;
+    uint64_t noise;          /* bytes outside frames (log text, garbage) */
+} mesh_frame_reader_t;
+
+void mesh_frame_reader_feed(mesh_frame_reader_t* r, const uint8_t* data,
+                            size_t n, mesh_serial_frame_fn fn, void* ctx);
+
+typedef struct {
+    int fd;                  /* -1 while closed */
+    const char* path;
+    uint32_t next_id;        /* MeshPacket.id of the next packet */
+    uint8_t hop_limit;
+    mesh_frame_reader_t rx;
+    uint64_t frames_out;
+    uint64_t write_errors;
+} mesh_serial_t;
+
+/* Open path raw at 115200 8N1, non-blocking, wake the node's API and ask
+ * for its config (the reply is drained like any other input). Returns 0,
+ * or -1 with errno set; m->path is kept for mesh_serial_reopen(). */
+int mesh_serial_open(mesh_serial_t* m, const char* path);
+void mesh_serial_close(mesh_serial_t* m);
+
+/* Open m->path again if it is closed (node unplugged and back). Returns
+ * 0 when open. */
+int mesh_serial_reopen(mesh_serial_t* m);
+
+/* Broadcast a text message on channel 0. Returns 0, or -1 (the port is
+ * closed on a write error so the next call reopens it). */
+int mesh_serial_send_text(mesh_serial_t* m, const char* text);
+
+/* Send payload under portnum to `to` on channel. len is capped at
+ * MESH_SERIAL_PAYLOAD_MAX. Returns 0 or -1, as above. */
+int mesh_serial_send_data(mesh_serial_t* m, uint32_t portnum,
+                          const uint8_t* payload, size_t len, uint32_t to,
+                          uint32_t channel);
+
+/* Read what is waiting without blocking and pass each FromRadio frame to
+ * fn (may be NULL to just drain). Returns 0, or -1 if the port hung up
+ * (it is then closed). */
+int mesh_serial_poll(mesh_serial_t* m, mesh_serial_frame_fn fn, void* ctx);
+
+/* ---------- Decoding (stand-in node, tools) ---------- */
+
+/* A ToRadio or FromRadio message; only the fields used here. */
+typedef struct {
+    int is_packet;           /* else want_config_id or something else */
+    uint32_t want_config_id;
+    uint32_t from;           /* sending node (FromRadio only) */
+    uint32_t to;
+    uint32_t channel;
+    uint32_t id;
+    uint32_t hop_limit;
+    uint32_t portnum;
+    const uint8_t* payload;  /* points into the message */
+    size_t payload_len;
+} mesh_to_radio_t;
+
+/* Returns 0, or -1 if msg is not a well-formed ToRadio. */
+int mesh_decode_to_radio(const uint8_t* msg, size_t len, mesh_to_radio_t* out);
+
+/* FromRadio, as the node sends it to mesh_serial_poll()'s callback: only
+ * a received packet sets is_packet. Returns 0 or -1, as above. */
+int mesh_decode_from_radio(const uint8_t* msg, size_t len,
+                           mesh_to_radio_t* out);
+
+/* Frame a FromRadio{config_complete_id} reply into buf (at least 16
+ * bytes). Returns its length. */
+size_t mesh_encode_config_complete(uint32_t id, uint8_t* buf);
+
+#endif
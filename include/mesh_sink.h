@@ -0,0 +1,71 @@
+#ifndef MESH_SINK_H
+#define MESH_SINK_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "mesh_report.h"
+#include "mesh_serial.h"
+#include "sample_sink.h"
+#include "sensor_sched.h"
+#include "spsc_ring.h"
+
+/*
+ * Meshtastic as a sample sink. The mesh cannot take a message per
+ * second, so the sink only remembers which sensors have reported; once
+ * per period it packs every sensor's newest sample into one binary
+ * report (mesh_report.h) and queues it: a keyframe every
+ * `keyframe_every` periods, in between only the channels that moved
+ * past their dead-band, or nothing. With `text` set it queues one
+ * text message per sensor instead ("SEN66 -> pm2_5: 9.0, ...,
+ * temperature: 22.57 C (72.63 F)"), for reading on a phone. A thread of
+ * its own writes the queue to the node over the serial link
+ * (mesh_serial.h), so acquisition never waits on the radio. Between
+ * sends the thread keeps reading what the node sends (its config dump,
+ * every packet it hears): a node whose output is not read stalls.
+ */
+
+#define MESH_SINK_TEXT_MAX 228   /* Meshtastic text payload limit */
+
+typedef struct {
+    const char* port;        /* serial device of the node, e.g. /dev/ttyACM0 */
+    uint32_t period_ms;      /* one report (or message per sensor) per period */
+    uint32_t queue_msgs;     /* messages waiting for the radio */
+    uint32_t keyframe_every; /* periods per full report, 1: no deltas */
+    int text;                /* text messages instead of reports */
+} mesh_sink_config_t;
+
+/* A queued message */
+typedef struct {
+    uint16_t portnum;
+    uint16_t len;
+    uint8_t data[MESH_SINK_TEXT_MAX];
+} mesh_sink_msg_t;
+
+typedef struct {
+    mesh_sink_config_t cfg;
+    spsc_ring_t ring;
+    int wake_fd;             /* eventfd: queue has messages, or stop */
+    pthread_t thread;
+    atomic_int stop;
+    mesh_serial_t radio;     /* sender thread only */
+
+    /* acquisition thread only */
+    const sensor_ticks_t* sensors[SENSOR_SCHED_MAX];
+    uint64_t sent_usec[SENSOR_SCHED_MAX];  /* sample time last queued */
+    unsigned count;
+    uint64_t next_usec;
+    mesh_report_stream_t stream;
+
+    _Atomic uint64_t sent, failed, dropped;
+} mesh_sink_t;
+
+/* Start the sender thread; the first messages go out one period after
+ * the first tick. Returns 0, or -1 on failure. */
+int mesh_sink_start(mesh_sink_t* m, const mesh_sink_config_t* cfg);
+
+/* state: mesh_sink_t* started with mesh_sink_start() */
+extern const sample_sink_ops_t mesh_sink_ops;
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RING_FILE_H
+#define RING_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sample_clock.h"
+#include "sample_ring.h"
+#include "sample_sink.h"
+
+/*
+ * Recent history that survives a restart. A fixed-size file is mapped
+ * shared and the sample store's rings live in it, so appends write to
+ * the file without a system call. The file also holds a state area for
+ * the caller, such as the anomaly detectors. A restarted process maps
+ * the file again and carries on with the samples and state it had.
+ *
+ *   header     layout (channel names, capacity, state size), each ring's
+ *              head, and the wall-clock offset of the HAL time at the
+ *              last tick
+ *   rings      one per channel, sample_ring_bytes() each; the first
+ *              channel of a sensor holds the sensor's time column
+ *   state      state_bytes, zeroed on a cold start
+ *
+ * The pages are in the page cache as soon as they are written. A crashed
+ * or killed process loses at most the appends since the last tick, when
+ * the heads are copied to the header. msync() runs at most every
+ * sync_ms and bounds what a power cut can lose.
+ *
+ * The ring timestamps are HAL time, which restarts at boot. On open they
+ * are moved by the change in the wall-clock offset, so history from
+ * before a reboot keeps its place in time, as long as the wall clock was
+ * right on both sides.
+ *
+ * A file with a different layout (channels added or renamed, another
+ * capacity) is started afresh. The state alone is also started afresh
+ * when the file was last ticked more than max_age_ms ago: a detector
+ * baseline from yesterday would raise alarms, not prevent them.
+ */
+
+typedef struct {
+    const char* path;
+    uint32_t sync_ms;        /* msync at most this often; 0: every tick */
+    uint32_t max_age_ms;     /* older state starts cold; 0: never */
+    size_t state_bytes;
+} ring_file_config_t;
+
+typedef struct {
+    ring_file_config_t cfg;
+    int fd;
+    uint8_t* map;
+    size_t size;
+    sample_store_t* store;
+    void* state;             /* state_bytes in the mapping */
+    int resumed;             /* samples came back from the file */
+    int warm;                /* ... and so did the state */
+    uint64_t age_ms;         /* since the last tick before the restart */
+    sample_clock_t clock;
+    uint64_t last_sync_usec;
+    uint64_t syncs;
+} ring_file_t;
+
+/* Map cfg->path, creating or re-initializing it as needed, and move every
+ * ring of store into it (store may be NULL for the state only). Add the
+ * store's channels first. Returns 0, or -1 with errno set; the rings are
+ * left on the heap then. */
+int ring_file_open(ring_file_t* rf, const ring_file_config_t* cfg,
+                   sample_store_t* store);
+
+/* Save the heads and the clock offset; msync when sync_ms is due. */
+void ring_file_tick(ring_file_t* rf, uint64_t now_usec);
+
+/* Tick, msync and unmap. The store's rings are unusable afterwards. */
+void ring_file_close(ring_file_t* rf);
+
+/* As a sample sink, added after the others: tick on every sink tick,
+ * close on stop. state: ring_file_t* opened with ring_file_open(). */
+extern const sample_sink_ops_t ring_file_sink_ops;
+
+#endif
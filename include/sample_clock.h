@@ -0,0 +1,24 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include <stdint.h>
+
+/*
+ * Wall-clock timestamps for samples stamped with the monotonic HAL time.
+ * The offset between CLOCK_REALTIME and CLOCK_MONOTONIC is read once per
+ * sync, normally once per batch, so an NTP step shifts whole batches and
+ * never the spacing of samples within one.
+ */
+
+typedef struct {
+    int64_t offset_usec;     /* realtime - monotonic */
+} sample_clock_t;
+
+/* Re-read the offset; call before the first sample and once per batch. */
+void sample_clock_sync(sample_clock_t* c);
+
+/* Unix time in ms (or ns) for a sensirion_i2c_hal_get_time_usec() stamp. */
+uint64_t sample_clock_wall_ms(const sample_clock_t* c, uint64_t mono_usec);
+uint64_t sample_clock_wall_ns(const sample_clock_t* c, uint64_t mono_usec);
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * In-memory history, one ring per channel (a single value such as SEN66
+ * PM2.5). Each ring is struct-of-arrays: timestamps, raw 16-bit values
+ * and status bytes in separate cache-aligned columns, so a consumer that
+ * only needs values walks one dense array. The channels of one sensor
+ * are appended together and share one time column, so a sample costs 3
+ * bytes per channel and 8 per sensor: a week of 1 Hz SEN66 data (9
+ * channels) is 21 MB.
+ *
+ * Appends overwrite the oldest sample once the ring is full. Samples are
+ * numbered from 0 in append order; a window hands out pointers into the
+ * columns (at most two spans, split where the ring wraps) without copying.
+ *
+ * Not thread-safe: append and read from the acquisition thread.
+ *
+ * The columns are on the heap, or in memory handed to
+ * sample_ring_attach() (a ring file, ring_file.h) that survives a
+ * restart.
+ */
+
+#define SAMPLE_RING_CACHELINE 64
+
+/* Status bits */
+#define SAMPLE_OK          0x00
+#define SAMPLE_INVALID     0x01  /* sensor reported "no value" (e.g. 0x7FFF) */
+#define SAMPLE_READ_ERROR  0x02  /* read failed; raw value is meaningless */
+#define SAMPLE_STALE       0x04  /* no new sample; previous value repeated */
+
+typedef struct {
+    uint64_t* t_ms;          /* HAL time in ms */
+    uint16_t* raw;           /* int16 channels are stored as their bits */
+    uint8_t* status;
+    uint32_t mask;
+    uint64_t head;           /* samples appended so far */
+    int attached;            /* columns are not ours to free */
+    int shared_time;         /* t_ms is another ring's; it stamps the rows */
+} sample_ring_t;
+
+/* A run of consecutive samples, oldest first. */
+typedef struct {
+    const uint64_t* t_ms;
+    const uint16_t* raw;
+    const uint8_t* status;
+    uint32_t len;
+} sample_span_t;
+
+/* capacity is rounded up to a power of two. time: a ring of the same
+ * capacity whose time column this one shares, NULL for a column of its
+ * own. A ring sharing time is appended together with time, after it or
+ * before, and its own timestamps are not written. Returns 0 or -1. */
+int sample_ring_init(sample_ring_t* r, uint32_t capacity,
+                     const sample_ring_t* time);
+void sample_ring_free(sample_ring_t* r);
+
+/* Bytes sample_ring_attach() needs for capacity (a power of two), with
+ * or without a time column. */
+size_t sample_ring_bytes(uint32_t capacity, int own_time);
+
+/* Put the columns in mem (SAMPLE_RING_CACHELINE-aligned,
+ * sample_ring_bytes() long) and continue appending at head; time is as
+ * for sample_ring_init(). Whatever mem holds is the ring's content;
+ * sample_ring_free() leaves it alone. */
+void sample_ring_attach(sample_ring_t* r, void* mem, uint32_t capacity,
+                        uint64_t head, const sample_ring_t* time);
+
+static inline uint32_t sample_ring_capacity(const sample_ring_t* r) {
+    return r->mask + 1;
+}
+
+/* Sequence number of the oldest sample still held. */
+static inline uint64_t sample_ring_oldest(const sample_ring_t* r) {
+    return r->head > r->mask ? r->head - r->mask - 1 : 0;
+}
+
+static inline void sample_ring_append(sample_ring_t* r, uint64_t t_usec,
+                                      uint16_t raw, uint8_t status) {
+    uint32_t i = (uint32_t)r->head & r->mask;
+    if (!r->shared_time) r->t_ms[i] = t_usec / 1000;
+    r->raw[i] = raw;
+    r->status[i] = status;
+    r->head++;
+}
+
+/* Up to max samples starting at sequence *from (moved up to the oldest
+ * held if it was overwritten). Fills out[] and returns the number of
+ * spans, 0 when there is nothing from *from onwards. */
+unsigned sample_ring_window(const sample_ring_t* r, uint64_t* from,
+                            uint32_t max, sample_span_t out[2]);
+
+/* The newest n samples (fewer if the ring holds fewer). */
+unsigned sample_ring_last(const sample_ring_t* r, uint32_t n,
+                          sample_span_t out[2]);
+
+/* Newest raw value (0 while empty). */
+static inline uint16_t sample_ring_latest(const sample_ring_t* r) {
+    return r->raw[(uint32_t)(r->head - 1) & r->mask];
+}
+
+/* ---------- Channel store ---------- */
+
+#define SAMPLE_STORE_MAX 48
+
+/* Channel flags */
+#define SAMPLE_CHANNEL_SIGNED  0x01  /* raw is int16 */
+#define SAMPLE_CHANNEL_CELSIUS 0x02  /* temperature; displays add °F */
+
+/* Values stay in the sensor's own integer ticks: value = raw / scale,
+ * printed with `decimals` digits after the point. Nothing is converted
+ * to float until it is shown or sent. */
+typedef struct {
+    const char* sensor;      /* measurement name, e.g. "sen66" */
+    const char* field;       /* e.g. "pm2_5" */
+    uint16_t scale;
+    uint8_t decimals;        /* at most 4 */
+    uint8_t flags;
+    sample_ring_t ring;
+} sample_channel_t;
+
+typedef struct {
+    sample_channel_t channels[SAMPLE_STORE_MAX];
+    unsigned count;
+    uint32_t capacity;       /* samples per channel */
+} sample_store_t;
+
+void sample_store_init(sample_store_t* s, uint32_t capacity);
+void sample_store_free(sample_store_t* s);
+
+/* Returns the channel id, or -1 when the table is full or out of memory.
+ * A channel added right after one of the same sensor shares that
+ * sensor's time column: append all of a sensor's channels together. */
+int sample_store_add(sample_store_t* s, const char* sensor, const char* field,
+                     uint16_t scale, uint8_t decimals, uint8_t flags);
+
+static inline int32_t sample_channel_value(const sample_channel_t* c,
+                                           uint16_t raw) {
+    return c->flags & SAMPLE_CHANNEL_SIGNED ? (int32_t)(int16_t)raw
+                                            : (int32_t)raw;
+}
+
+/* Status bits for a freshly read raw value: the Sensirion "unknown"
+ * markers (0x7FFF signed, 0xFFFF unsigned) become SAMPLE_INVALID. */
+static inline uint8_t sample_channel_status(const sample_channel_t* c,
+                                            uint16_t raw) {
+    uint16_t unknown = c->flags & SAMPLE_CHANNEL_SIGNED ? 0x7FFF : 0xFFFF;
+    return raw == unknown ? SAMPLE_INVALID : SAMPLE_OK;
+}
+
+/* value / scale as a decimal string with integer arithmetic only, rounded
+ * half away from zero. Returns the full length, as snprintf() does, and
+ * truncates to fit len. */
+int sample_format_fixed(int32_t value, uint16_t scale, uint8_t decimals,
+                        char* buf, size_t len);
+
+static inline int sample_channel_format(const sample_channel_t* c,
+                                        uint16_t raw, char* buf, size_t len) {
+    return sample_format_fixed(sample_channel_value(c, raw), c->scale,
+                               c->decimals, buf, len);
+}
+
+/* A CELSIUS channel in °F: C * 9 / 5 + 32 on the raw ticks, at five
+ * times the channel scale. */
+static inline int sample_channel_format_fahrenheit(const sample_channel_t* c,
+                                                   uint16_t raw, char* buf,
+                                                   size_t len) {
+    int32_t v = sample_channel_value(c, raw) * 9 + 160 * (int32_t)c->scale;
+    return sample_format_fixed(v, (uint16_t)(c->scale * 5), c->decimals, buf,
+                               len);
+}
+
+#endif
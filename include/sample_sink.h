@@ -0,0 +1,70 @@
+#ifndef SAMPLE_SINK_H
+#define SAMPLE_SINK_H
+
+#include <stdint.h>
+
+#include "sample_clock.h"
+#include "sensor_ticks.h"
+
+/*
+ * Fan-out of samples to outputs. The acquisition loop reads each sensor
+ * once and hands every sample to each registered sink, so two outputs no
+ * longer mean two processes polling the same bus. A sink that does I/O
+ * keeps its own queue and batching and must not block the caller: the
+ * callbacks run on the acquisition thread.
+ *
+ *   sample_sink_set_add(&sinks, &influx_sink_ops, &influx2);
+ *   sample_sink_set_add(&sinks, &sample_sink_stdout_ops, NULL);
+ *   sen66_ticks.on_sample = sample_sink_set_publish;
+ *   sen66_ticks.user = &sinks;
+ */
+
+#define SAMPLE_SINK_MAX 8
+
+typedef struct sample_sink sample_sink_t;
+
+typedef struct {
+    const char* name;
+    /* New sample of t (read it with sensor_ticks_raw/_status); ts_ms is
+     * its Unix time in ms. */
+    void (*sample)(sample_sink_t* s, const sensor_ticks_t* t, uint64_t ts_ms);
+    /* End of one tick; now_usec is HAL time. NULL: not needed. */
+    void (*tick)(sample_sink_t* s, uint64_t now_usec);
+    /* Flush what can be flushed and release. NULL: not needed. */
+    void (*stop)(sample_sink_t* s);
+} sample_sink_ops_t;
+
+struct sample_sink {
+    const sample_sink_ops_t* ops;
+    void* state;
+};
+
+typedef struct {
+    sample_sink_t sinks[SAMPLE_SINK_MAX];
+    unsigned count;
+    /* HAL stamps to wall time, re-synced every tick */
+    sample_clock_t clock;
+} sample_sink_set_t;
+
+void sample_sink_set_init(sample_sink_set_t* set);
+
+/* state is handed back to ops as s->state. Returns 0, or -1 when the set
+ * is full. */
+int sample_sink_set_add(sample_sink_set_t* set, const sample_sink_ops_t* ops,
+                        void* state);
+
+/* sensor_ticks_fn: pass the set as the sensor's user pointer. */
+void sample_sink_set_publish(const sensor_ticks_t* t, void* user);
+
+/* Close a tick on every sink, then re-sync the clock. */
+void sample_sink_set_tick(sample_sink_set_t* set);
+
+/* Stop every sink, in the order they were added. */
+void sample_sink_set_stop(sample_sink_set_t* set);
+
+/* Console output: a time header per second with samples, then one
+ * "SEN66 -> field: value, ..." line per sample, temperatures also in °F.
+ * No state. */
+extern const sample_sink_ops_t sample_sink_stdout_ops;
+
+#endif
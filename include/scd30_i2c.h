@@ -46,6 +46,9 @@ extern "C" {
 #include "sensirion_config.h"
 #define SCD30_I2C_ADDR_61 0x61
 
+/* Time the device needs after a reset before it answers again */
+#define SCD30_SOFT_RESET_USEC 2000000
+
 typedef enum {
     SCD30_START_PERIODIC_MEASUREMENT_CMD_ID = 0x10,
     SCD30_STOP_PERIODIC_MEASUREMENT_CMD_ID = 0x104,
@@ -73,6 +76,29 @@ typedef enum {
  */
 void scd30_init(uint8_t i2c_address);
 
+/**
+ * @brief One SCD30 instance: bus handle, address and command buffer
+ *
+ * Lets several identical sensors share a host, at different addresses or on
+ * different buses. The plain scd30_* functions use a built-in instance on the
+ * default bus, addressed by scd30_init().
+ */
+typedef struct {
+    int fd;
+    uint8_t address;
+    uint8_t buffer[18];
+} scd30_dev_t;
+
+/**
+ * @brief Bind an instance to a bus and address
+ *
+ * @param[out] dev Instance to initialize
+ * @param[in] fd Bus handle, SENSIRION_I2C_HAL_DEFAULT_FD for the default bus
+ * @param[in] i2c_address Used i2c address
+ *
+ */
+void scd30_dev_init(scd30_dev_t* dev, int fd, uint8_t i2c_address);
+
 /**
  * @brief Poll the data ready flag.
  *
@@ -101,6 +127,42 @@ int16_t scd30_blocking_read_measurement_data(float* co2_concentration,
                                              float* temperature,
                                              float* humidity);
 
+/**
+ * @brief Read a measurement only if one is ready.
+ *
+ * Checks the data ready flag once and reads out the sample if it is set.
+ * Never sleeps beyond the command delays, so it is safe to call from a
+ * loop that serves other sensors.
+ *
+ * @param[out] co2_concentration
+ * @param[out] temperature
+ * @param[out] humidity
+ *
+ * @return NO_ERROR on success, DATA_NOT_READY_ERROR if no new sample is
+ * available, an error code otherwise.
+ */
+int16_t scd30_try_read_measurement_data(float* co2_concentration,
+                                        float* temperature, float* humidity);
+
+/**
+ * @brief Wait at most timeout_ms for a measurement and read it.
+ *
+ * Polls the data ready flag every 100 ms (or less near the deadline) until
+ * a sample is ready or the timeout expires. A timeout of 0 is the same as
+ * scd30_try_read_measurement_data().
+ *
+ * @param[out] co2_concentration
+ * @param[out] temperature
+ * @param[out] humidity
+ * @param[in] timeout_ms Longest time to wait for the ready flag.
+ *
+ * @return NO_ERROR on success, DATA_NOT_READY_ERROR if the deadline passed
+ * without a sample, an error code otherwise.
+ */
+int16_t scd30_poll_measurement_data(float* co2_concentration,
+                                    float* temperature, float* humidity,
+                                    uint32_t timeout_ms);
+
 /**
  * @brief Starts continuous measurement of CO₂, relative humidity and
  * temperature.
@@ -432,6 +494,56 @@ int16_t scd30_read_firmware_version(uint8_t* major, uint8_t* minor);
  */
 int16_t scd30_soft_reset();
 
+/**
+ * @brief scd30_soft_reset() without the wait
+ *
+ * See scd30_dev_soft_reset_nowait().
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t scd30_soft_reset_nowait();
+
+/**
+ * @brief Per-instance variants of the measurement commands
+ *
+ * Same behaviour, parameters and return values as the functions of the same
+ * name without _dev_, but addressed to @p dev and using its own buffer, so
+ * instances on different buses can be read from different threads.
+ */
+
+int16_t scd30_dev_start_periodic_measurement(scd30_dev_t* dev,
+                                             uint16_t ambient_pressure);
+
+int16_t scd30_dev_stop_periodic_measurement(scd30_dev_t* dev);
+
+int16_t scd30_dev_get_data_ready(scd30_dev_t* dev, uint16_t* data_ready_flag);
+
+int16_t scd30_dev_read_measurement_data(scd30_dev_t* dev,
+                                        float* co2_concentration,
+                                        float* temperature, float* humidity);
+
+int16_t scd30_dev_try_read_measurement_data(scd30_dev_t* dev,
+                                            float* co2_concentration,
+                                            float* temperature,
+                                            float* humidity);
+
+int16_t scd30_dev_poll_measurement_data(scd30_dev_t* dev,
+                                        float* co2_concentration,
+                                        float* temperature, float* humidity,
+                                        uint32_t timeout_ms);
+
+int16_t scd30_dev_soft_reset(scd30_dev_t* dev);
+
+/**
+ * @brief Send the reset command without waiting for the device
+ *
+ * The device does not answer for SCD30_SOFT_RESET_USEC afterwards. Lets a
+ * caller reset several sensors at once and wait out the longest delay.
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t scd30_dev_soft_reset_nowait(scd30_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,6 +45,30 @@ extern "C" {
 
 #include "sensirion_config.h"
 
+/* Time the device needs after a reset before it answers again */
+#define SEN44_DEVICE_RESET_USEC 100000
+
+/**
+ * sen44_dev_t - One SEN44 instance: bus handle and address.
+ *
+ * The sensor answers at a fixed address, so several of them need separate
+ * buses. The plain sen44_* functions use a built-in instance on the default
+ * bus.
+ */
+typedef struct {
+    int fd;
+    uint8_t address;
+} sen44_dev_t;
+
+/**
+ * sen44_dev_init() - Bind an instance to a bus.
+ *
+ * @param dev Instance to initialize
+ * @param fd Bus handle, SENSIRION_I2C_HAL_DEFAULT_FD for the default bus
+ * @param i2c_address I2C address, normally 0x69
+ */
+void sen44_dev_init(sen44_dev_t* dev, int fd, uint8_t i2c_address);
+
 /**
  * sen44_start_measurement() - Starts a continuous measurement.
  *
@@ -328,6 +352,50 @@ int16_t sen44_clear_device_status(void);
  */
 int16_t sen44_device_reset(void);
 
+/**
+ * sen44_device_reset_nowait() - sen44_device_reset() without the wait, see
+ * sen44_dev_device_reset_nowait().
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sen44_device_reset_nowait(void);
+
+/*
+ * Per-instance variants of the measurement commands: same behaviour,
+ * parameters and return values as the functions of the same name without
+ * _dev_, but addressed to @dev. Instances on different buses can be read
+ * from different threads.
+ */
+
+int16_t sen44_dev_start_measurement(sen44_dev_t* dev);
+
+int16_t sen44_dev_stop_measurement(sen44_dev_t* dev);
+
+int16_t sen44_dev_read_data_ready(sen44_dev_t* dev, bool* data_ready);
+
+int16_t sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+    sen44_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* voc_index,
+    int16_t* ambient_humidity, int16_t* ambient_temperature);
+
+int16_t sen44_dev_read_measured_mass_concentration_and_ambient_values(
+    sen44_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, float* voc_index,
+    float* ambient_humidity, float* ambient_temperature);
+
+int16_t sen44_dev_device_reset(sen44_dev_t* dev);
+
+/**
+ * sen44_dev_device_reset_nowait() - Send the reset command without waiting
+ * for the device, which does not answer for SEN44_DEVICE_RESET_USEC
+ * afterwards.
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sen44_dev_device_reset_nowait(sen44_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
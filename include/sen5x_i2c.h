@@ -45,6 +45,30 @@ extern "C" {
 
 #include "sensirion_config.h"
 
+/* Time the device needs after a reset before it answers again */
+#define SEN5X_DEVICE_RESET_USEC 200000
+
+/**
+ * sen5x_dev_t - One SEN5x instance: bus handle and address.
+ *
+ * The sensor answers at a fixed address, so several of them need separate
+ * buses. The plain sen5x_* functions use a built-in instance on the default
+ * bus.
+ */
+typedef struct {
+    int fd;
+    uint8_t address;
+} sen5x_dev_t;
+
+/**
+ * sen5x_dev_init() - Bind an instance to a bus.
+ *
+ * @param dev Instance to initialize
+ * @param fd Bus handle, SENSIRION_I2C_HAL_DEFAULT_FD for the default bus
+ * @param i2c_address I2C address, normally 0x69
+ */
+void sen5x_dev_init(sen5x_dev_t* dev, int fd, uint8_t i2c_address);
+
 /**
  * sen5x_start_measurement() - Starts a continuous measurement.
  *
@@ -829,6 +853,53 @@ int16_t sen5x_read_and_clear_device_status(uint32_t* device_status);
  */
 int16_t sen5x_device_reset(void);
 
+/**
+ * sen5x_device_reset_nowait() - sen5x_device_reset() without the wait, see
+ * sen5x_dev_device_reset_nowait().
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sen5x_device_reset_nowait(void);
+
+/*
+ * Per-instance variants of the measurement commands: same behaviour,
+ * parameters and return values as the functions of the same name without
+ * _dev_, but addressed to @dev. Instances on different buses can be read
+ * from different threads.
+ */
+
+int16_t sen5x_dev_start_measurement(sen5x_dev_t* dev);
+
+int16_t sen5x_dev_stop_measurement(sen5x_dev_t* dev);
+
+int16_t sen5x_dev_read_data_ready(sen5x_dev_t* dev, bool* data_ready);
+
+int16_t sen5x_dev_read_measured_values_as_integers(
+    sen5x_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* ambient_humidity,
+    int16_t* ambient_temperature, int16_t* voc_index, int16_t* nox_index);
+
+int16_t sen5x_dev_read_measured_values(sen5x_dev_t* dev,
+                                       float* mass_concentration_pm1p0,
+                                       float* mass_concentration_pm2p5,
+                                       float* mass_concentration_pm4p0,
+                                       float* mass_concentration_pm10p0,
+                                       float* ambient_humidity,
+                                       float* ambient_temperature,
+                                       float* voc_index, float* nox_index);
+
+int16_t sen5x_dev_device_reset(sen5x_dev_t* dev);
+
+/**
+ * sen5x_dev_device_reset_nowait() - Send the reset command without waiting
+ * for the device, which does not answer for SEN5X_DEVICE_RESET_USEC
+ * afterwards.
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sen5x_dev_device_reset_nowait(sen5x_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
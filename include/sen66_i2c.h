@@ -46,6 +46,9 @@ extern "C" {
 #include "sensirion_config.h"
 #define SEN66_I2C_ADDR_6B 0x6b
 
+/* Time the device needs after a reset before it answers again */
+#define SEN66_DEVICE_RESET_USEC 1200000
+
 typedef enum {
     SEN66_START_CONTINUOUS_MEASUREMENT_CMD_ID = 0x21,
     SEN66_STOP_MEASUREMENT_CMD_ID = 0x104,
@@ -105,6 +108,29 @@ typedef union {
  */
 void sen66_init(uint8_t i2c_address);
 
+/**
+ * @brief One SEN66 instance: bus handle, address and command buffer
+ *
+ * Lets several identical sensors share a host, at different addresses or on
+ * different buses. The plain sen66_* functions use a built-in instance on the
+ * default bus, addressed by sen66_init().
+ */
+typedef struct {
+    int fd;
+    uint8_t address;
+    uint8_t buffer[48];
+} sen66_dev_t;
+
+/**
+ * @brief Bind an instance to a bus and address
+ *
+ * @param[out] dev Instance to initialize
+ * @param[in] fd Bus handle, SENSIRION_I2C_HAL_DEFAULT_FD for the default bus
+ * @param[in] i2c_address Used i2c address
+ *
+ */
+void sen66_dev_init(sen66_dev_t* dev, int fd, uint8_t i2c_address);
+
 /**
  * @brief sen66_signal_mass_concentration_pm1p0
  *
@@ -1034,6 +1060,58 @@ int16_t sen66_read_and_clear_device_status(sen66_device_status* device_status);
  */
 int16_t sen66_device_reset();
 
+/**
+ * @brief sen66_device_reset() without the wait
+ *
+ * See sen66_dev_device_reset_nowait().
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t sen66_device_reset_nowait();
+
+/**
+ * @brief Per-instance variants of the measurement commands
+ *
+ * Same behaviour, parameters and return values as the functions of the same
+ * name without _dev_, but addressed to @p dev and using its own buffer, so
+ * instances on different buses can be read from different threads.
+ */
+
+int16_t sen66_dev_start_continuous_measurement(sen66_dev_t* dev);
+
+int16_t sen66_dev_stop_measurement(sen66_dev_t* dev);
+
+int16_t sen66_dev_get_data_ready(sen66_dev_t* dev, uint8_t* padding,
+                                 bool* data_ready);
+
+int16_t sen66_dev_read_measured_values_as_integers(
+    sen66_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* ambient_humidity,
+    int16_t* ambient_temperature, int16_t* voc_index, int16_t* nox_index,
+    uint16_t* co2);
+
+int16_t sen66_dev_read_measured_values(sen66_dev_t* dev,
+                                       float* mass_concentration_pm1p0,
+                                       float* mass_concentration_pm2p5,
+                                       float* mass_concentration_pm4p0,
+                                       float* mass_concentration_pm10p0,
+                                       float* humidity, float* temperature,
+                                       float* voc_index, float* nox_index,
+                                       uint16_t* co2);
+
+int16_t sen66_dev_device_reset(sen66_dev_t* dev);
+
+/**
+ * @brief Send the reset command without waiting for the device
+ *
+ * The device does not answer for SEN66_DEVICE_RESET_USEC afterwards. Lets a
+ * caller reset several sensors at once and wait out the longest delay.
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t sen66_dev_device_reset_nowait(sen66_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +40,7 @@ extern "C" {
 
 #define NO_ERROR 0
 #define NOT_IMPLEMENTED_ERROR 31
+#define DATA_NOT_READY_ERROR 32
 
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(*(x)))
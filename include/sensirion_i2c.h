@@ -52,8 +52,47 @@ extern "C" {
 #define SENSIRION_NUM_WORDS(x) (sizeof(x) / SENSIRION_WORD_SIZE)
 #define SENSIRION_MAX_BUFFER_WORDS 32
 
+/**
+ * sensirion_i2c_generate_crc() - CRC-8 over count bytes, table driven and
+ *                                consuming two bytes per step.
+ *
+ * @data:  Bytes to checksum
+ * @count: Number of bytes
+ *
+ * @return The CRC-8 (polynomial 0x31, init 0xFF)
+ */
 uint8_t sensirion_i2c_generate_crc(const uint8_t* data, uint16_t count);
 
+/**
+ * sensirion_i2c_generate_crc_word() - CRC-8 of one 2-byte sensor word.
+ *
+ * Equivalent to sensirion_i2c_generate_crc(data, SENSIRION_WORD_SIZE) but
+ * uses two independent table lookups and no loop. This is the form every
+ * word on the wire needs.
+ *
+ * @data:  Pointer to the two bytes of the word (MSB first)
+ *
+ * @return The CRC-8 of the word
+ */
+uint8_t sensirion_i2c_generate_crc_word(const uint8_t* data);
+
+/**
+ * sensirion_i2c_generate_crc_bitwise() - Reference bit-at-a-time CRC-8.
+ *
+ * Kept for sensirion_i2c_crc_self_test() and for comparison in benchmarks.
+ */
+uint8_t sensirion_i2c_generate_crc_bitwise(const uint8_t* data,
+                                           uint16_t count);
+
+/**
+ * sensirion_i2c_crc_self_test() - Check the table-driven CRC functions
+ *                                 against the bitwise reference for every
+ *                                 possible word.
+ *
+ * @return NO_ERROR if all match, CRC_ERROR otherwise
+ */
+int8_t sensirion_i2c_crc_self_test(void);
+
 int8_t sensirion_i2c_check_crc(const uint8_t* data, uint16_t count,
                                uint8_t checksum);
 
@@ -341,6 +380,69 @@ int16_t sensirion_i2c_write_data(uint8_t address, const uint8_t* data,
  */
 int16_t sensirion_i2c_read_data_inplace(uint8_t address, uint8_t* buffer,
                                         uint16_t expected_data_length);
+
+/**
+ * sensirion_i2c_write_data_fd() - sensirion_i2c_write_data() on an explicit
+ *                                 bus.
+ *
+ * @param fd          Bus handle from the HAL, or SENSIRION_I2C_HAL_DEFAULT_FD.
+ * @param address     I2C address to write to.
+ * @param data        Pointer to the buffer containing the data to write.
+ * @param data_length Number of bytes to send to the Sensor.
+ *
+ * @return        NO_ERROR on success, error code otherwise
+ */
+int16_t sensirion_i2c_write_data_fd(int fd, uint8_t address,
+                                    const uint8_t* data, uint16_t data_length);
+
+/**
+ * sensirion_i2c_read_data_inplace_fd() - sensirion_i2c_read_data_inplace()
+ *                                        on an explicit bus.
+ *
+ * @param fd                   Bus handle from the HAL, or
+ *                             SENSIRION_I2C_HAL_DEFAULT_FD.
+ * @param address              Sensor I2C address
+ * @param buffer               Allocated buffer, see
+ *                             sensirion_i2c_read_data_inplace().
+ * @param expected_data_length Number of bytes to read (without CRC).
+ *
+ * @return            NO_ERROR on success, an error code otherwise
+ */
+int16_t sensirion_i2c_read_data_inplace_fd(int fd, uint8_t address,
+                                           uint8_t* buffer,
+                                           uint16_t expected_data_length);
+
+#define SENSIRION_I2C_BATCH_MAX 16
+
+/**
+ * One read in sensirion_i2c_read_data_batch_fd(). buffer must hold the
+ * data with CRCs; error is set per read.
+ */
+typedef struct {
+    uint8_t address;
+    uint8_t* buffer;
+    uint16_t expected_data_length;
+    int16_t error;
+} sensirion_i2c_read_req_t;
+
+/**
+ * sensirion_i2c_read_data_batch_fd() - Collect the answers of several
+ * devices on one bus in as few transfers as the HAL allows.
+ *
+ * Send every command first and wait out the longest execution time; the
+ * reads then go out SENSIRION_I2C_BATCH_MAX at a time, each group as one
+ * I2C_RDWR call on adapters that support it.
+ *
+ * @param fd    Bus handle from the HAL, or SENSIRION_I2C_HAL_DEFAULT_FD.
+ * @param reqs  Reads to perform; results as in
+ *              sensirion_i2c_read_data_inplace().
+ * @param count Number of entries in reqs
+ *
+ * @return      NO_ERROR if every read succeeded, else the first error
+ */
+int16_t sensirion_i2c_read_data_batch_fd(int fd,
+                                         sensirion_i2c_read_req_t* reqs,
+                                         uint16_t count);
 #ifdef __cplusplus
 }
 #endif
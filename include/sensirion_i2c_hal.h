@@ -3,7 +3,13 @@
 
 #include <stdint.h>
 
-/* HAL init/sleep/time */
+#ifndef SENSIRION_I2C_HAL_DEFAULT_BUS
+#define SENSIRION_I2C_HAL_DEFAULT_BUS 1 /* /dev/i2c-1, adjust for your platform */
+#endif
+#define SENSIRION_I2C_HAL_MAX_BUSES 8
+
+/* HAL init/sleep/time. The time is CLOCK_MONOTONIC: it does not jump
+ * with NTP, and event_loop timers run on the same clock. */
 void sensirion_i2c_hal_init(void);
 void sensirion_i2c_hal_sleep_usec(uint32_t useconds);
 uint64_t sensirion_i2c_hal_get_time_usec(void);
@@ -12,4 +18,32 @@ uint64_t sensirion_i2c_hal_get_time_usec(void);
 int8_t sensirion_i2c_hal_write(uint8_t address, const uint8_t* data, uint16_t count);
 int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count);
 
+/* Same on an explicit bus: an open /dev/i2c-N descriptor, or
+ * SENSIRION_I2C_HAL_DEFAULT_FD for the bus opened by sensirion_i2c_hal_init().
+ * Transfers on one fd must not interleave between threads. */
+#define SENSIRION_I2C_HAL_DEFAULT_FD (-1)
+int8_t sensirion_i2c_hal_write_fd(int fd, uint8_t address, const uint8_t* data, uint16_t count);
+int8_t sensirion_i2c_hal_read_fd(int fd, uint8_t address, uint8_t* data, uint16_t count);
+
+/* One segment of a combined transfer. */
+typedef struct {
+    uint8_t address;
+    uint8_t read;   /* 1: fill data from the device, 0: send data */
+    uint16_t count;
+    uint8_t* data;
+} sensirion_i2c_hal_msg_t;
+
+/* Run the messages back to back with repeated starts and one stop, in a
+ * single I2C_RDWR call where the adapter supports it and as separate
+ * write()/read() calls otherwise. A device still executing a command NACKs
+ * its read, so only put a command and its read in one transfer when the
+ * command needs no execution time. */
+int8_t sensirion_i2c_hal_transfer_fd(int fd, sensirion_i2c_hal_msg_t* msgs, uint16_t count);
+
+/* Open /dev/i2c-<bus> for the _fd calls; returns the fd or -1. The HAL
+ * remembers the slave address per fd and only reissues I2C_SLAVE when it
+ * changes. Open and close buses before starting threads that use them. */
+int sensirion_i2c_hal_open_bus(unsigned bus);
+void sensirion_i2c_hal_close_bus(int fd);
+
 #endif
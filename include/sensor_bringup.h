@@ -0,0 +1,73 @@
+#ifndef SENSOR_BRINGUP_H
+#define SENSOR_BRINGUP_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sensor_sched.h"
+
+/*
+ * Sensor start-up without serialized reset waits. Every reset is sent
+ * back to back, then each sensor is started as soon as its own settle time
+ * has passed, so bring-up takes as long as the slowest device rather than
+ * the sum of all of them.
+ */
+
+#define SENSOR_BRINGUP_MAX SENSOR_SCHED_MAX
+
+/* One step on one sensor; returns the driver error code. */
+typedef int16_t (*sensor_bringup_fn)(void* ctx);
+
+typedef struct {
+    const char* name;         /* matched against the scheduler entry */
+    sensor_bringup_fn reset;  /* send the reset and return; NULL: none */
+    uint32_t reset_usec;      /* time the device needs after the reset */
+    sensor_bringup_fn start;  /* configure and start measuring */
+    void* ctx;
+    int16_t error;            /* first failing step, NO_ERROR if none */
+    uint64_t due_usec;
+    uint64_t started_usec;    /* since sensor_bringup_run() began */
+    int started;
+    int reported;
+} sensor_bringup_entry_t;
+
+typedef struct {
+    sensor_bringup_entry_t entries[SENSOR_BRINGUP_MAX];
+    unsigned count;
+    uint64_t t0_usec;
+} sensor_bringup_t;
+
+void sensor_bringup_init(sensor_bringup_t* b);
+
+/* Returns 0, or -1 when the table is full. */
+int sensor_bringup_add(sensor_bringup_t* b, const char* name,
+                       sensor_bringup_fn reset, uint32_t reset_usec,
+                       sensor_bringup_fn start, void* ctx);
+
+/* Reset everything, then start each sensor when it is ready. A sensor
+ * whose reset fails is not started. Returns the number of sensors that
+ * failed. */
+int sensor_bringup_run(sensor_bringup_t* b);
+
+/* Print time-to-first-sample for sensors whose first sample arrived in
+ * the scheduler since the last call. Returns how many started sensors are
+ * still waiting for theirs. */
+int sensor_bringup_report(sensor_bringup_t* b, const sensor_sched_t* s,
+                          FILE* out);
+
+/* Reset and start steps for the stock drivers. ctx is the driver
+ * instance (<sensor>_dev_t*), or NULL for the one set up with
+ * <sensor>_init(). The reset settle times are <SENSOR>_DEVICE_RESET_USEC
+ * and SCD30_SOFT_RESET_USEC. SCD30 starts without pressure compensation. */
+int16_t sensor_bringup_scd30_reset(void* ctx);
+int16_t sensor_bringup_scd30_start(void* ctx);
+int16_t sensor_bringup_sen44_reset(void* ctx);
+int16_t sensor_bringup_sen44_start(void* ctx);
+int16_t sensor_bringup_sen5x_reset(void* ctx);
+int16_t sensor_bringup_sen5x_start(void* ctx);
+int16_t sensor_bringup_sen66_reset(void* ctx);
+int16_t sensor_bringup_sen66_start(void* ctx);
+int16_t sensor_bringup_sfa3x_reset(void* ctx);
+int16_t sensor_bringup_sfa3x_start(void* ctx);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SENSOR_SCHED_H
+#define SENSOR_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "event_loop.h"
+
+/*
+ * Data-ready driven acquisition. Each sensor is polled with its own
+ * data-ready command shortly before its next sample is expected and read
+ * as soon as the flag is set; in between, the loop sleeps until the
+ * nearest deadline instead of a fixed second.
+ */
+
+#define SENSOR_SCHED_MAX 16
+
+/* Query the data-ready flag; ctx is the entry's, as for the read. */
+typedef int16_t (*sensor_ready_fn)(void* ctx, bool* data_ready);
+
+/* Read and publish one sample; returns the driver error code.
+ * DATA_NOT_READY_ERROR is retried one poll step later. */
+typedef int16_t (*sensor_read_fn)(void* ctx);
+
+typedef struct {
+    uint64_t polls;          /* data-ready queries */
+    uint64_t not_ready;
+    uint64_t samples;
+    uint64_t errors;
+    uint64_t first_sample_usec; /* HAL time of the first sample, 0 before */
+} sensor_sched_stats_t;
+
+typedef struct {
+    const char* name;
+    uint32_t interval_usec;
+    sensor_ready_fn ready;   /* NULL: no flag, read once per interval */
+    sensor_read_fn read;
+    void* ctx;
+    uint64_t due_usec;
+    sensor_sched_stats_t stats;
+} sensor_sched_entry_t;
+
+typedef struct {
+    sensor_sched_entry_t entries[SENSOR_SCHED_MAX];
+    unsigned count;
+    uint32_t poll_usec;      /* retry step while a sample is late */
+    uint32_t max_sleep_usec; /* upper bound so the caller stays responsive */
+    event_loop_t* loop;      /* set by sensor_sched_attach() */
+    int timer;
+} sensor_sched_t;
+
+void sensor_sched_init(sensor_sched_t* s, uint32_t poll_ms, uint32_t max_sleep_ms);
+
+/* interval_ms is the sample period the device was started with. Returns
+ * 0, or -1 when the table is full. */
+int sensor_sched_add(sensor_sched_t* s, const char* name, uint32_t interval_ms,
+                     sensor_ready_fn ready, sensor_read_fn read, void* ctx);
+
+/* Service every sensor that is due, then sleep until the next deadline.
+ * Returns the number of samples read. */
+int sensor_sched_run(sensor_sched_t* s);
+
+/* The two halves of sensor_sched_run(): service what is due without
+ * sleeping, and the HAL time of the nearest deadline (UINT64_MAX when
+ * the table is empty). */
+int sensor_sched_service(sensor_sched_t* s);
+uint64_t sensor_sched_next_due(const sensor_sched_t* s);
+
+/* Drive the scheduler from a timer in ev instead of sensor_sched_run():
+ * the timer is re-armed at the nearest deadline after every round.
+ * Returns 0, or -1 if no timer could be added. */
+int sensor_sched_attach(sensor_sched_t* s, event_loop_t* ev);
+
+/* The drivers' data-ready calls as sensor_ready_fn. ctx is the
+ * <sensor>_dev_t* to query, NULL for the driver's default instance. */
+int16_t sensor_sched_scd30_ready(void* ctx, bool* data_ready);
+int16_t sensor_sched_sen44_ready(void* ctx, bool* data_ready);
+int16_t sensor_sched_sen5x_ready(void* ctx, bool* data_ready);
+int16_t sensor_sched_sen66_ready(void* ctx, bool* data_ready);
+
+#endif
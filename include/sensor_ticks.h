@@ -0,0 +1,94 @@
+#ifndef SENSOR_TICKS_H
+#define SENSOR_TICKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sample_ring.h"
+
+/*
+ * Raw-tick acquisition. The readers here use the drivers' *_as_integers
+ * (SEN44: *_ticks) reads and append the sensor's integer ticks straight
+ * into a sample_store, one channel per value, with the scale the
+ * datasheet gives. No float is produced on the read path; the SCD30
+ * sends IEEE floats on the wire, so its reader converts them to ticks
+ * once.
+ *
+ * Each reader is a sensor_read_fn and each ready call a sensor_ready_fn:
+ * pass the sensor_ticks_t as the scheduler ctx. Both go to t->dev.
+ */
+
+#define SENSOR_TICKS_MAX_CHANNELS 9
+
+typedef struct sensor_ticks sensor_ticks_t;
+
+/* Called after every successful read. */
+typedef void (*sensor_ticks_fn)(const sensor_ticks_t* t, void* user);
+
+struct sensor_ticks {
+    const char* name;         /* measurement name of the channels */
+    const char* model;        /* driver: "scd30", "sen44", "sen5x", ... */
+    sample_store_t* store;
+    int first;                /* id of the sensor's first channel */
+    unsigned count;
+    void* dev;                /* <sensor>_dev_t*, NULL: the default one */
+    uint64_t t_usec;          /* HAL time of the last sample */
+    sensor_ticks_fn on_sample;
+    void* user;
+};
+
+/* Register the sensor's channels in store. fields overrides the default
+ * field names, in the order listed below; NULL keeps them. Returns 0, or
+ * -1 when the store is full.
+ *
+ *   scd30: co2 temperature humidity
+ *   sen44: pm1 pm2_5 pm4 pm10 voc humidity temperature
+ *   sen5x: pm1 pm2_5 pm4 pm10 humidity temperature voc nox
+ *   sen66: pm1 pm2_5 pm4 pm10 humidity temperature voc nox co2
+ *   sfa3x: hcho humidity temperature
+ */
+int sensor_ticks_add_scd30(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev);
+int sensor_ticks_add_sen44(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev);
+int sensor_ticks_add_sen5x(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev);
+int sensor_ticks_add_sen66(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev);
+int sensor_ticks_add_sfa3x(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev);
+
+int16_t sensor_ticks_read_scd30(void* ctx);
+int16_t sensor_ticks_read_sen44(void* ctx);
+int16_t sensor_ticks_read_sen5x(void* ctx);
+int16_t sensor_ticks_read_sen66(void* ctx);
+int16_t sensor_ticks_read_sfa3x(void* ctx);
+
+/* SFA3x has no data-ready flag. */
+int16_t sensor_ticks_ready_scd30(void* ctx, bool* data_ready);
+int16_t sensor_ticks_ready_sen44(void* ctx, bool* data_ready);
+int16_t sensor_ticks_ready_sen5x(void* ctx, bool* data_ready);
+int16_t sensor_ticks_ready_sen66(void* ctx, bool* data_ready);
+
+static inline const sample_channel_t* sensor_ticks_channel(
+    const sensor_ticks_t* t, unsigned i) {
+    return &t->store->channels[t->first + (int)i];
+}
+
+/* Newest raw value of the sensor's i-th channel. */
+static inline uint16_t sensor_ticks_raw(const sensor_ticks_t* t, unsigned i) {
+    return sample_ring_latest(&sensor_ticks_channel(t, i)->ring);
+}
+
+static inline uint8_t sensor_ticks_status(const sensor_ticks_t* t,
+                                          unsigned i) {
+    const sample_ring_t* r = &sensor_ticks_channel(t, i)->ring;
+    return r->status[(uint32_t)(r->head - 1) & r->mask];
+}
+
+#endif
@@ -46,6 +46,9 @@ extern "C" {
 #include "sensirion_config.h"
 #define SFA3X_I2C_ADDR_5D 0x5d
 
+/* Time the device needs after a reset before it answers again */
+#define SFA3X_DEVICE_RESET_USEC 1000000
+
 typedef enum {
     SFA3X_START_CONTINUOUS_MEASUREMENT_CMD_ID = 0x6,
     SFA3X_STOP_MEASUREMENT_CMD_ID = 0x104,
@@ -62,6 +65,29 @@ typedef enum {
  */
 void sfa3x_init(uint8_t i2c_address);
 
+/**
+ * @brief One SFA3x instance: bus handle, address and command buffer
+ *
+ * Lets several identical sensors share a host, at different addresses or on
+ * different buses. The plain sfa3x_* functions use a built-in instance on the
+ * default bus, addressed by sfa3x_init().
+ */
+typedef struct {
+    int fd;
+    uint8_t address;
+    uint8_t buffer[48];
+} sfa3x_dev_t;
+
+/**
+ * @brief Bind an instance to a bus and address
+ *
+ * @param[out] dev Instance to initialize
+ * @param[in] fd Bus handle, SENSIRION_I2C_HAL_DEFAULT_FD for the default bus
+ * @param[in] i2c_address Used i2c address
+ *
+ */
+void sfa3x_dev_init(sfa3x_dev_t* dev, int fd, uint8_t i2c_address);
+
 /**
  * @brief sfa3x_signal_hcho
  *
@@ -168,6 +194,47 @@ int16_t sfa3x_get_device_marking(int8_t* device_marking,
  */
 int16_t sfa3x_device_reset();
 
+/**
+ * @brief sfa3x_device_reset() without the wait
+ *
+ * See sfa3x_dev_device_reset_nowait().
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t sfa3x_device_reset_nowait();
+
+/**
+ * @brief Per-instance variants of the measurement commands
+ *
+ * Same behaviour, parameters and return values as the functions of the same
+ * name without _dev_, but addressed to @p dev and using its own buffer, so
+ * instances on different buses can be read from different threads.
+ */
+
+int16_t sfa3x_dev_start_continuous_measurement(sfa3x_dev_t* dev);
+
+int16_t sfa3x_dev_stop_measurement(sfa3x_dev_t* dev);
+
+int16_t sfa3x_dev_read_measured_values_as_integers(sfa3x_dev_t* dev,
+                                                   int16_t* hcho,
+                                                   int16_t* humidity,
+                                                   int16_t* temperature);
+
+int16_t sfa3x_dev_read_measured_values(sfa3x_dev_t* dev, float* hcho,
+                                       float* humidity, float* temperature);
+
+int16_t sfa3x_dev_device_reset(sfa3x_dev_t* dev);
+
+/**
+ * @brief Send the reset command without waiting for the device
+ *
+ * The device does not answer for SFA3X_DEVICE_RESET_USEC afterwards. Lets a
+ * caller reset several sensors at once and wait out the longest delay.
+ *
+ * @return error_code 0 on success, an error code otherwise.
+ */
+int16_t sfa3x_dev_device_reset_nowait(sfa3x_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,99 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Durable on-disk spool for data that could not be delivered.
+ *
+ * Records are appended to numbered segment files (seg-00000001.log, ...)
+ * in one directory. Each record is a 12-byte header (magic, length,
+ * CRC-32 of the payload) followed by the payload, so a torn write at the
+ * tail is detected on replay and skipped. Segments rotate at a fixed
+ * size; the oldest is dropped when max_segments is exceeded so the spool
+ * cannot fill the SD card. fsync is batched by byte count and age rather
+ * than issued per record.
+ *
+ * Appends only write. Rotation and every fsync are left to one
+ * maintaining thread (spool_maintain() and spool_replay()), which syncs
+ * with the lock dropped, so a producer appending from another thread
+ * never waits on the card. A segment may run past segment_bytes until
+ * that thread gets to it.
+ *
+ * Replay always reads from the oldest closed segment, concatenates
+ * records into batches of up to replay_bytes and hands them to a send
+ * callback. A segment is unlinked once all of it has been sent, so
+ * delivery is at-least-once across crashes.
+ */
+
+typedef struct {
+    const char* dir;            /* created if missing */
+    size_t segment_bytes;       /* rotate once a segment reaches this */
+    uint32_t max_segments;      /* oldest segment dropped beyond this */
+    size_t sync_bytes;          /* fsync after this many unsynced bytes */
+    uint32_t sync_interval_ms;  /* ... or when unsynced data is this old */
+    size_t replay_bytes;        /* largest batch handed to send() */
+} spool_config_t;
+
+typedef struct {
+    uint64_t appended;          /* records written */
+    uint64_t appended_bytes;
+    uint64_t replayed;          /* records delivered by replay */
+    uint64_t replayed_bytes;
+    uint64_t corrupt;           /* segment tails skipped on bad CRC/header */
+    uint64_t dropped_segments;  /* segments discarded to stay in budget */
+    uint64_t syncs;
+    uint32_t segments;          /* segments currently on disk */
+} spool_stats_t;
+
+/* Returns 0 if the batch was delivered, non-zero to stop the replay. */
+typedef int (*spool_send_fn)(void* ctx, const char* body, size_t len);
+
+typedef struct {
+    spool_config_t cfg;
+    pthread_mutex_t lock;       /* guards everything below except replay */
+
+    int fd;                     /* active segment, -1 if it could not be opened */
+    uint32_t first_id;          /* oldest segment on disk */
+    uint32_t active_id;         /* segment receiving appends */
+    size_t active_bytes;
+    size_t unsynced_bytes;
+    uint64_t unsynced_since_usec;
+    spool_stats_t stats;
+
+    /* replay cursor, owned by the thread calling spool_replay() */
+    uint32_t read_id;
+    size_t read_off;
+    char* batch;
+} spool_t;
+
+/* Open (or create) the spool directory and pick up existing segments.
+ * Returns 0 on success, -1 on failure. */
+int spool_open(spool_t* sp, const spool_config_t* cfg);
+
+/* Append one record without syncing. Thread-safe. Returns 0, or -1 if
+ * the write failed or no segment is open. */
+int spool_append(spool_t* sp, const char* data, size_t len);
+
+/* Rotate a full segment, reopen one after a failure, and fsync the
+ * active segment if sync_bytes or sync_interval_ms is due. Call from the
+ * thread that replays. */
+void spool_maintain(spool_t* sp);
+
+/* Non-zero while any record is waiting to be replayed. */
+int spool_pending(spool_t* sp);
+
+/* Send up to max_batches batches, oldest first. Returns 0 when the spool
+ * is empty, 1 if more remains, -1 if send() failed (the cursor stays on
+ * the failed batch). Call from one thread only. */
+int spool_replay(spool_t* sp, spool_send_fn send, void* ctx,
+                 uint32_t max_batches);
+
+void spool_get_stats(spool_t* sp, spool_stats_t* out);
+
+/* fsync and close. */
+void spool_close(spool_t* sp);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Single-producer/single-consumer ring of fixed-size slots.
+ *
+ * Lock-free: the producer only stores head, the consumer only stores
+ * tail, and each side publishes with release / observes with acquire.
+ * head and tail sit on separate cache lines so the two threads do not
+ * bounce one line between cores.
+ */
+
+#define SPSC_RING_CACHELINE 64
+
+typedef struct {
+    _Alignas(SPSC_RING_CACHELINE) _Atomic uint32_t head;
+    _Alignas(SPSC_RING_CACHELINE) _Atomic uint32_t tail;
+    _Alignas(SPSC_RING_CACHELINE) uint32_t mask;
+    size_t slot_size;
+    uint8_t* slots;
+} spsc_ring_t;
+
+/* capacity is rounded up to a power of two. Returns 0 or -1. */
+int spsc_ring_init(spsc_ring_t* r, uint32_t capacity, size_t slot_size);
+void spsc_ring_free(spsc_ring_t* r);
+
+/* Producer: slot to fill, or NULL if full. Publish with commit(). */
+void* spsc_ring_reserve(spsc_ring_t* r);
+void spsc_ring_commit(spsc_ring_t* r);
+
+/* Consumer: oldest filled slot, or NULL if empty. Hand back with release(). */
+const void* spsc_ring_peek(spsc_ring_t* r);
+void spsc_ring_release(spsc_ring_t* r);
+
+/* Approximate number of filled slots; exact when called by either side
+ * while the other is idle. */
+uint32_t spsc_ring_depth(const spsc_ring_t* r);
+
+static inline uint32_t spsc_ring_capacity(const spsc_ring_t* r) {
+    return r->mask + 1;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef TSDB_H
+#define TSDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Local time-series store: append-only files of compressed blocks that
+ * keep months of history on the Pi without a database server.
+ *
+ * One file per sensor holds all of its channels. The file starts with a
+ * header naming the columns (field, scale, decimals, flags), so it can be
+ * read without the daemon's tables. Blocks follow back to back, each
+ * covering up to block_ms of samples:
+ *
+ *   0   magic "TSB1"
+ *   4   block length in bytes, header included, a multiple of 8
+ *   8   rows
+ *   12  CRC-32 of everything after this field
+ *   16  first and last timestamp, Unix ms (2 x uint64)
+ *   32  length in bytes of the time stream, then of each value stream
+ *       (uint32 each)
+ *   ... the streams, one per column
+ *
+ * The streams are columnar and Gorilla-style bit-packed. Timestamps are
+ * stored once for all channels of the sensor as delta-of-delta from
+ * the block's first timestamp. At 1 Hz the delta-of-delta is a few ms of
+ * jitter, so it costs 1 to 10 bits. Values are the sensor's raw 16-bit
+ * ticks, stored as the integer delta to the previous row: 1 bit when
+ * unchanged, 5 bits within +/-4 ticks, up to 20 bits for a jump. Integer
+ * deltas replace Gorilla's float XOR because nothing here is a float. A
+ * scan of one channel decodes the time stream and that channel's stream
+ * only.
+ *
+ * Sealed blocks are never rewritten. The open block lives in memory and
+ * goes to disk when it is full or on close; a crash loses at most that
+ * block. On open, a torn block at the end of the file (one that runs
+ * past the end, or a last block with a bad CRC) is cut off. A damaged
+ * header with blocks after it, such as a bit flip on the card, is left
+ * in place: the writer and readers step over it to the next block whose
+ * CRC checks out.
+ *
+ * Readers mmap the file. Block headers are indexed once at open, and a
+ * range scan finds its first block by binary search on the timestamps.
+ * CRCs are checked only on the blocks a scan touches.
+ */
+
+#define TSDB_MAX_COLUMNS 16
+#define TSDB_FIELD_MAX 24
+#define TSDB_BLOCK_MAX_ROWS 4096
+
+typedef struct {
+    char field[TSDB_FIELD_MAX];  /* NUL-terminated */
+    uint16_t scale;              /* value = raw / scale */
+    uint8_t decimals;
+    uint8_t flags;               /* SAMPLE_CHANNEL_* */
+} tsdb_column_t;
+
+typedef struct {
+    uint64_t rows;           /* appended since open */
+    uint64_t blocks;         /* sealed since open */
+    uint64_t bytes;          /* block bytes written since open */
+    uint64_t write_errors;   /* blocks lost to a failed write */
+} tsdb_stats_t;
+
+typedef struct {
+    int fd;
+    unsigned columns;
+    uint32_t block_ms;
+    uint64_t end;            /* file offset of the next block */
+
+    /* open block */
+    uint32_t rows;
+    uint64_t t_first;
+    uint64_t t_last;         /* also of the last sealed block */
+    int64_t prev_delta;
+    uint16_t prev[TSDB_MAX_COLUMNS];
+    uint8_t* stream[TSDB_MAX_COLUMNS + 1];  /* [0] time, then values */
+    size_t bits[TSDB_MAX_COLUMNS + 1];
+    uint8_t* buf;            /* streams, then the block being sealed */
+
+    uint64_t damaged;        /* bytes stepped over on open */
+    tsdb_stats_t stats;
+} tsdb_writer_t;
+
+/* Open path for appending, creating it with these columns if missing. An
+ * existing file must have the same columns. block_ms (at most a day) is
+ * the time a block spans; 0 leaves it to TSDB_BLOCK_MAX_ROWS. Returns 0,
+ * or -1 with errno set (EINVAL: the file's columns differ). */
+int tsdb_writer_open(tsdb_writer_t* w, const char* path,
+                     const tsdb_column_t* columns, unsigned count,
+                     uint32_t block_ms);
+
+/* One row: raw[] has a value per column. A timestamp older than the last
+ * one (the wall clock stepped back) is stored as the last one, so the
+ * blocks stay in time order. Returns 0, or -1 if sealing a full block
+ * failed to write (the row itself is kept). */
+int tsdb_writer_append(tsdb_writer_t* w, uint64_t t_ms, const uint16_t* raw);
+
+/* Write the open block now, if it has rows. Returns 0 or -1. */
+int tsdb_writer_seal(tsdb_writer_t* w);
+
+/* Seal, fdatasync and close. */
+void tsdb_writer_close(tsdb_writer_t* w);
+
+/* ---------- Reading ---------- */
+
+typedef struct {
+    int fd;
+    const uint8_t* map;
+    size_t size;
+    unsigned columns;
+    tsdb_column_t column[TSDB_MAX_COLUMNS];
+    uint32_t blocks;
+    uint64_t* offset;        /* file offset of each block */
+    uint64_t* scratch;       /* decoded timestamps of one block */
+    uint16_t* values;        /* decoded values, TSDB_BLOCK_MAX_ROWS per column */
+    uint64_t damaged;        /* bytes of damaged blocks not indexed */
+    uint64_t corrupt;        /* blocks skipped by scans on a bad CRC */
+} tsdb_reader_t;
+
+/* Map path read-only and index its blocks. Returns 0, or -1 with errno
+ * set. */
+int tsdb_reader_open(tsdb_reader_t* r, const char* path);
+void tsdb_reader_close(tsdb_reader_t* r);
+
+/* Column index of field, or -1. */
+int tsdb_reader_column(const tsdb_reader_t* r, const char* field);
+
+/* First and last timestamp held; 0 and 0 when there are no blocks. */
+void tsdb_reader_range(const tsdb_reader_t* r, uint64_t* first_ms,
+                       uint64_t* last_ms);
+
+/* Rows in the blocks held. */
+uint64_t tsdb_reader_rows(const tsdb_reader_t* r);
+
+/* One row of a scan. Only the columns in the scan's mask are filled in. */
+typedef void (*tsdb_row_fn)(void* ctx, uint64_t t_ms, const uint16_t* raw);
+
+/* Every row with from_ms <= t <= to_ms, oldest first. Only the columns in
+ * mask (bit n = column n) are decoded. Returns the number of rows. */
+uint64_t tsdb_reader_scan(tsdb_reader_t* r, uint64_t from_ms, uint64_t to_ms,
+                          uint32_t mask, tsdb_row_fn fn, void* ctx);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TSDB_SINK_H
+#define TSDB_SINK_H
+
+#include <stdint.h>
+
+#include "sample_sink.h"
+#include "tsdb.h"
+
+/*
+ * Local history as a sample sink: every sample goes into a tsdb file
+ * per sensor, <dir>/<sensor>.tsdb (e.g. sensors-daemon.tsdb/sen66.tsdb),
+ * with one column per channel. Encoding a row is a few dozen bit
+ * operations; the disk sees one write per block_ms per sensor.
+ * Daemon/tsdb-query reads the files back.
+ *
+ * When a file is opened, the rows of the sensor's sample history newer
+ * than the file's last are appended first. With the history in a ring
+ * file this recovers the open block a crash cost, as long as the
+ * history covers block_ms.
+ */
+
+#define TSDB_SINK_MAX_SENSORS 8
+
+typedef struct {
+    const char* dir;         /* created if missing */
+    uint32_t block_ms;       /* time one block spans, at most a day */
+} tsdb_sink_config_t;
+
+typedef struct {
+    tsdb_sink_config_t cfg;
+    struct {
+        const sensor_ticks_t* ticks;
+        tsdb_writer_t writer;
+        int ok;              /* writer open; 0 after it failed to */
+    } sensors[TSDB_SINK_MAX_SENSORS];
+    unsigned count;
+} tsdb_sink_t;
+
+/* Create the directory. Files are opened at each sensor's first sample.
+ * Returns 0 or -1. */
+int tsdb_sink_start(tsdb_sink_t* s, const tsdb_sink_config_t* cfg);
+
+/* state: tsdb_sink_t* started with tsdb_sink_start() */
+extern const sample_sink_ops_t tsdb_sink_ops;
+
+#endif
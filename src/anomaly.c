@@ -0,0 +1,94 @@
+#include "anomaly.h"
+
+#include <math.h>
+#include <string.h>
+
+anomaly_config_t anomaly_config_default(float alpha, float min_sigma,
+                                        uint32_t warmup) {
+    anomaly_config_t c = {
+        .alpha = alpha,
+        .spike_sigmas = 5.0f,
+        .cusum_k = 0.5f,
+        .cusum_h = 8.0f,
+        .min_sigma = min_sigma,
+        .warmup = warmup,
+    };
+    return c;
+}
+
+void anomaly_reset(anomaly_state_t* s) {
+    memset(s, 0, sizeof(*s));
+}
+
+static uint8_t severity(float score) {
+    return score < 2.0f ? 1 : score < 4.0f ? 2 : 3;
+}
+
+static int emit(anomaly_event_t* ev, anomaly_kind_t kind, float score, float x,
+                float mean, float sigma) {
+    ev->kind = kind;
+    ev->score = score;
+    ev->severity = severity(score);
+    ev->value = x;
+    ev->baseline = mean;
+    ev->sigma = sigma;
+    return 1;
+}
+
+int anomaly_update(anomaly_state_t* s, const anomaly_config_t* c, float x,
+                   anomaly_event_t* ev) {
+    if (isnan(x)) return 0;
+    if (s->n == 0) {
+        anomaly_reset(s);
+        s->mean = x;
+        s->n = 1;
+        return 0;
+    }
+
+    float mean = s->mean;
+    float sigma = fmaxf(sqrtf(s->var), c->min_sigma);
+    float z = (x - mean) / sigma;
+    int armed = s->n >= c->warmup;
+    int spike = fabsf(z) > c->spike_sigmas;
+    int alarm = 0;
+
+    /* An outlier moves the baseline and noise by at most spike_sigmas, so
+     * a single bad read does not blind the detector; a real step is
+     * still taken up over a few samples. */
+    float d = x - mean;
+    float lim = c->spike_sigmas * sigma;
+    if (d > lim) d = lim;
+    if (d < -lim) d = -lim;
+    s->mean += c->alpha * d;
+    s->var = (1.0f - c->alpha) * (s->var + c->alpha * d * d);
+    if (s->n < UINT32_MAX) s->n++;
+
+    if (!armed) return 0;
+    if (spike) {
+        return emit(ev, z > 0 ? ANOMALY_SPIKE_UP : ANOMALY_SPIKE_DOWN,
+                    fabsf(z) / c->spike_sigmas, x, mean, sigma);
+    }
+
+    s->cusum_hi = fmaxf(0.0f, s->cusum_hi + z - c->cusum_k);
+    s->cusum_lo = fmaxf(0.0f, s->cusum_lo - z - c->cusum_k);
+    if (s->cusum_hi > c->cusum_h) {
+        alarm = emit(ev, ANOMALY_DRIFT_UP, s->cusum_hi / c->cusum_h, x, mean, sigma);
+    } else if (s->cusum_lo > c->cusum_h) {
+        alarm = emit(ev, ANOMALY_DRIFT_DOWN, s->cusum_lo / c->cusum_h, x, mean, sigma);
+    }
+    if (alarm) {
+        s->cusum_hi = 0.0f;
+        s->cusum_lo = 0.0f;
+    }
+    return alarm;
+}
+
+const char* anomaly_kind_name(anomaly_kind_t kind) {
+    switch (kind) {
+    case ANOMALY_SPIKE_UP: return "spike up";
+    case ANOMALY_SPIKE_DOWN: return "spike down";
+    case ANOMALY_DRIFT_UP: return "drift up";
+    case ANOMALY_DRIFT_DOWN: return "drift down";
+    default: return "none";
+    }
+}
@@ -0,0 +1,49 @@
+#include "anomaly_sink.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void anomaly_sink_init(anomaly_sink_t* a, const anomaly_sink_config_t* cfg) {
+    memset(a, 0, sizeof(*a));
+    a->sink_cfg = *cfg;
+    a->state = cfg->state ? cfg->state : a->own;
+}
+
+static void anomaly_sample(sample_sink_t* s, const sensor_ticks_t* t,
+                           uint64_t ts_ms) {
+    (void)ts_ms;
+    anomaly_sink_t* a = s->state;
+
+    for (unsigned i = 0; i < t->count; i++) {
+        unsigned id = (unsigned)t->first + i;
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        if (id >= SAMPLE_STORE_MAX || sensor_ticks_status(t, i) != SAMPLE_OK) continue;
+
+        if (!a->ready[id]) {
+            a->cfg[id] = anomaly_config_default(a->sink_cfg.alpha,
+                                                a->sink_cfg.noise_ticks / c->scale,
+                                                a->sink_cfg.warmup);
+            a->ready[id] = 1;
+        }
+
+        anomaly_event_t ev;
+        float x = (float)sample_channel_value(c, sensor_ticks_raw(t, i)) / c->scale;
+        if (!anomaly_update(&a->state[id], &a->cfg[id], x, &ev)) continue;
+
+        a->events++;
+        printf("ANOMALY %s %s: %s to %.*f (baseline %.*f +/- %.*f), severity %u\n",
+               c->sensor, c->field, anomaly_kind_name(ev.kind), c->decimals, ev.value,
+               c->decimals + 1, ev.baseline, c->decimals + 1, ev.sigma, ev.severity);
+    }
+}
+
+static void anomaly_stop(sample_sink_t* s) {
+    anomaly_sink_t* a = s->state;
+    printf("Anomaly detector: %llu alarms\n", (unsigned long long)a->events);
+}
+
+const sample_sink_ops_t anomaly_sink_ops = {
+    .name = "anomaly",
+    .sample = anomaly_sample,
+    .stop = anomaly_stop,
+};
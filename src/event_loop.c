@@ -0,0 +1,133 @@
+#include "event_loop.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+int event_loop_init(event_loop_t* ev) {
+    memset(ev, 0, sizeof(*ev));
+    ev->epfd = epoll_create1(EPOLL_CLOEXEC);
+    return ev->epfd < 0 ? -1 : 0;
+}
+
+void event_loop_close(event_loop_t* ev) {
+    for (unsigned i = 0; i < ev->count; i++) {
+        if (ev->sources[i].is_timer) close(ev->sources[i].fd);
+    }
+    if (ev->epfd >= 0) close(ev->epfd);
+    ev->epfd = -1;
+    ev->count = 0;
+}
+
+uint64_t event_loop_now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int add_source(event_loop_t* ev, int fd, uint32_t events) {
+    unsigned id = 0;
+    while (id < ev->count && ev->sources[id].fd >= 0) id++;
+    if (id == EVENT_LOOP_MAX) return -1;
+
+    struct epoll_event e = {.events = events, .data.u32 = id};
+    if (epoll_ctl(ev->epfd, EPOLL_CTL_ADD, fd, &e) < 0) return -1;
+
+    if (id == ev->count) ev->count++;
+    event_loop_source_t* s = &ev->sources[id];
+    memset(s, 0, sizeof(*s));
+    s->fd = fd;
+    return (int)id;
+}
+
+int event_loop_add_fd(event_loop_t* ev, int fd, uint32_t events,
+                      event_loop_io_fn fn, void* ctx) {
+    int id = add_source(ev, fd, events);
+    if (id < 0) return -1;
+    ev->sources[id].on_io = fn;
+    ev->sources[id].ctx = ctx;
+    return id;
+}
+
+int event_loop_remove(event_loop_t* ev, int id) {
+    if (id < 0 || (unsigned)id >= ev->count || ev->sources[id].fd < 0 ||
+        ev->sources[id].is_timer) {
+        errno = EINVAL;
+        return -1;
+    }
+    epoll_ctl(ev->epfd, EPOLL_CTL_DEL, ev->sources[id].fd, NULL);
+    ev->sources[id].fd = -1;
+    ev->sources[id].on_io = NULL;
+    return 0;
+}
+
+int event_loop_add_timer(event_loop_t* ev, event_loop_timer_fn fn, void* ctx) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    int id = add_source(ev, fd, EPOLLIN);
+    if (id < 0) {
+        close(fd);
+        return -1;
+    }
+    ev->sources[id].is_timer = 1;
+    ev->sources[id].on_timer = fn;
+    ev->sources[id].ctx = ctx;
+    return id;
+}
+
+static struct timespec to_timespec(uint64_t usec) {
+    struct timespec ts = {(time_t)(usec / 1000000),
+                          (long)(usec % 1000000) * 1000};
+    return ts;
+}
+
+static int arm(event_loop_t* ev, int id, uint64_t deadline_usec,
+               uint64_t period_usec) {
+    if (id < 0 || (unsigned)id >= ev->count || !ev->sources[id].is_timer) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* it_value 0 would disarm; 1 us is long past and fires at once */
+    struct itimerspec its = {
+        .it_interval = to_timespec(period_usec),
+        .it_value = to_timespec(deadline_usec ? deadline_usec : 1),
+    };
+    return timerfd_settime(ev->sources[id].fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int event_loop_arm_at(event_loop_t* ev, int id, uint64_t deadline_usec) {
+    return arm(ev, id, deadline_usec, 0);
+}
+
+int event_loop_arm_periodic(event_loop_t* ev, int id, uint64_t period_usec) {
+    return arm(ev, id, event_loop_now_usec() + period_usec, period_usec);
+}
+
+int event_loop_run_once(event_loop_t* ev, int timeout_ms) {
+    struct epoll_event events[EVENT_LOOP_MAX];
+
+    int n = epoll_wait(ev->epfd, events, EVENT_LOOP_MAX, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < n; i++) {
+        event_loop_source_t* s = &ev->sources[events[i].data.u32];
+        if (s->fd < 0) continue;  /* removed earlier this round */
+        if (s->is_timer) {
+            uint64_t expirations = 0;
+            /* a re-arm from an earlier callback this round may have
+             * cleared it */
+            if (read(s->fd, &expirations, sizeof(expirations)) !=
+                sizeof(expirations)) {
+                continue;
+            }
+            if (s->on_timer) s->on_timer(s->ctx, expirations);
+        } else if (s->on_io) {
+            s->on_io(s->ctx, s->fd, events[i].events);
+        }
+    }
+    return n;
+}
@@ -0,0 +1,542 @@
+/*
+ * Simulated I2C bus for running the drivers without hardware.
+ *
+ * Implements the sensirion_i2c_hal API. A write parses the command word
+ * and its CRC'd arguments the way the sensor would and prepares the
+ * response; the following read returns it as data words with CRC. Sample
+ * values follow a slow triangle wave plus noise so a dashboard shows
+ * something that moves.
+ */
+#include "i2c_mock.h"
+#include "sensirion_i2c.h"
+#include "sensirion_i2c_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MOCK_ADDRESSES 128
+#define MOCK_RESP_WORDS 16   /* 32-byte strings */
+#define MOCK_REG_WORDS 6
+#define MOCK_REGS 8
+#define MOCK_WAVE 64         /* samples per triangle period */
+
+enum {
+    CMD_START,      /* begin periodic measurement */
+    CMD_STOP,
+    CMD_RESET,
+    CMD_NOOP,       /* accepted, no visible effect (fan cleaning, heater) */
+    CMD_READY,      /* data-ready flag */
+    CMD_SAMPLE,     /* measurement frame built from fields */
+    CMD_REG,        /* setting: args store it, response echoes it */
+    CMD_TEXT,       /* 32-byte string: dflt[0] 0 = name, 1 = serial */
+};
+
+/* One measured signal in raw ticks; scale != 0 sends it as a float of
+ * ticks / scale (SCD30). */
+typedef struct {
+    int32_t base;
+    int32_t swing;
+    uint16_t scale;
+} mock_field_t;
+
+typedef struct {
+    uint16_t cmd;
+    uint8_t kind;
+    uint8_t words;               /* response length, 0 for write-only */
+    const mock_field_t* fields;
+    uint16_t dflt[2];
+} mock_cmd_t;
+
+typedef struct {
+    const char* name;
+    const mock_cmd_t* cmds;
+    uint32_t interval_ms;        /* default measurement interval */
+    uint16_t interval_cmd;       /* register holding the interval in s, or 0 */
+} mock_type_t;
+
+typedef struct {
+    i2c_mock_sensor_t type;
+    uint32_t id;
+    int measuring;
+    uint64_t start_usec;
+    uint32_t interval_usec;
+    uint64_t consumed;           /* last sample index read out */
+    int pending;
+    uint8_t resp_words;
+    uint16_t resp[MOCK_RESP_WORDS];
+    uint8_t nregs;
+    uint16_t reg_cmd[MOCK_REGS];
+    uint16_t reg_val[MOCK_REGS][MOCK_REG_WORDS];
+} mock_dev_t;
+
+#define START(c) {c, CMD_START, 0, NULL, {0, 0}}
+#define STOP(c) {c, CMD_STOP, 0, NULL, {0, 0}}
+#define RESET(c) {c, CMD_RESET, 0, NULL, {0, 0}}
+#define NOOP(c) {c, CMD_NOOP, 0, NULL, {0, 0}}
+#define READY(c) {c, CMD_READY, 1, NULL, {0, 0}}
+#define SAMPLE(c, n, f) {c, CMD_SAMPLE, n, f, {0, 0}}
+#define REG(c, n, d0, d1) {c, CMD_REG, n, NULL, {d0, d1}}
+#define TEXT(c, which) {c, CMD_TEXT, 16, NULL, {which, 0}}
+#define END {0, CMD_NOOP, 0, NULL, {0, 0}}
+
+/* Typical indoor levels: PM x10, RH x100, T x200, VOC/NOx x10, HCHO x5 */
+#define F_PM1 {50, 30, 0}
+#define F_PM25 {80, 40, 0}
+#define F_PM4 {90, 40, 0}
+#define F_PM10 {100, 50, 0}
+#define F_NC05 {300, 100, 0}
+#define F_NC1 {350, 120, 0}
+#define F_NC25 {370, 120, 0}
+#define F_NC4 {375, 120, 0}
+#define F_NC10 {380, 120, 0}
+#define F_SIZE {600, 100, 0}
+#define F_RH {4500, 1500, 0}
+#define F_T {4400, 600, 0}
+#define F_VOC {1000, 300, 0}
+#define F_NOX {10, 5, 0}
+#define F_CO2 {600, 200, 0}
+#define F_RAW_VOC {30000, 2000, 0}
+#define F_RAW_NOX {15000, 1000, 0}
+
+static const mock_field_t scd30_meas[] = {
+    {600, 200, 1}, {4400, 600, 200}, {4500, 1500, 100}};
+static const mock_field_t sen5x_meas[] = {F_PM1, F_PM25, F_PM4, F_PM10,
+                                          F_RH,  F_T,    F_VOC, F_NOX};
+static const mock_field_t sen5x_raw[] = {F_RH, F_T, F_RAW_VOC, F_RAW_NOX};
+static const mock_field_t pm_full[] = {F_PM1, F_PM25, F_PM4, F_PM10, F_NC05,
+                                       F_NC1, F_NC25, F_NC4, F_NC10, F_SIZE};
+static const mock_field_t sen44_meas[] = {F_PM1, F_PM25, F_PM4, F_PM10,
+                                          F_VOC, F_RH,   F_T};
+static const mock_field_t sen44_ambient[] = {F_VOC, F_RH, F_T};
+static const mock_field_t sen66_meas[] = {F_PM1, F_PM25, F_PM4, F_PM10, F_RH,
+                                          F_T,   F_VOC,  F_NOX, F_CO2};
+static const mock_field_t sen66_nc[] = {F_NC05, F_NC1, F_NC25, F_NC4, F_NC10};
+static const mock_field_t sen66_raw[] = {F_RH, F_T, F_RAW_VOC, F_RAW_NOX,
+                                         F_CO2};
+static const mock_field_t sht_heater[] = {F_RH, F_T};
+static const mock_field_t sfa3x_meas[] = {{100, 50, 0}, F_RH, F_T};
+
+static const mock_cmd_t scd30_cmds[] = {
+    START(0x0010),          STOP(0x0104),
+    REG(0x4600, 1, 2, 0),   READY(0x0202),
+    SAMPLE(0x0300, 6, scd30_meas),
+    REG(0x5306, 1, 1, 0),   REG(0x5204, 1, 400, 0),
+    REG(0x5403, 1, 0, 0),   REG(0x5102, 1, 0, 0),
+    REG(0xD100, 1, 0x0342, 0),
+    RESET(0xD304),          END};
+
+static const mock_cmd_t sen44_cmds[] = {
+    START(0x0021),          STOP(0x0104),
+    READY(0x0202),          SAMPLE(0x0353, 10, pm_full),
+    SAMPLE(0x0374, 7, sen44_meas),
+    SAMPLE(0x03A6, 3, sen44_ambient),
+    NOOP(0x5607),           REG(0x8004, 2, 0x0009, 0x3A80),
+    TEXT(0xD025, 0),        TEXT(0xD033, 1),
+    REG(0xD100, 3, 0x0100, 0),
+    REG(0xD206, 2, 0, 0),   NOOP(0xD210),
+    RESET(0xD304),          END};
+
+static const mock_cmd_t sen5x_cmds[] = {
+    START(0x0021),          START(0x0037),
+    STOP(0x0104),           READY(0x0202),
+    SAMPLE(0x03C4, 8, sen5x_meas),
+    SAMPLE(0x03D2, 4, sen5x_raw),
+    SAMPLE(0x0413, 10, pm_full),
+    NOOP(0x5607),           REG(0x60B2, 3, 0, 0),
+    REG(0x60C6, 1, 0, 0),   REG(0x60D0, 6, 100, 12),
+    REG(0x60E1, 6, 1, 12),  REG(0x60F7, 1, 0, 0),
+    REG(0x6181, 4, 0, 0),   REG(0x8004, 2, 0x0009, 0x3A80),
+    TEXT(0xD014, 0),        TEXT(0xD033, 1),
+    REG(0xD100, 4, 0x0200, 0),
+    REG(0xD206, 2, 0, 0),   REG(0xD210, 2, 0, 0),
+    RESET(0xD304),          END};
+
+static const mock_cmd_t sen66_cmds[] = {
+    START(0x0021),          STOP(0x0104),
+    READY(0x0202),          SAMPLE(0x0300, 9, sen66_meas),
+    SAMPLE(0x0316, 5, sen66_nc),
+    SAMPLE(0x0405, 5, sen66_raw),
+    NOOP(0x5607),           REG(0x60B2, 4, 0, 0),
+    REG(0x60D0, 6, 100, 12),
+    REG(0x60E1, 6, 1, 12),  REG(0x6100, 4, 0, 0),
+    REG(0x6181, 4, 0, 0),   REG(0x6707, 1, 0x8000, 0),
+    REG(0x6711, 1, 1, 0),   REG(0x6720, 1, 1013, 0),
+    REG(0x6736, 1, 0, 0),   NOOP(0x6765),
+    SAMPLE(0x6790, 2, sht_heater),
+    TEXT(0xD014, 0),        TEXT(0xD033, 1),
+    REG(0xD100, 1, 0x0400, 0),
+    REG(0xD206, 2, 0, 0),   REG(0xD210, 2, 0, 0),
+    RESET(0xD304),          END};
+
+static const mock_cmd_t sfa3x_cmds[] = {
+    START(0x0006),          STOP(0x0104),
+    SAMPLE(0x0327, 3, sfa3x_meas),
+    TEXT(0xD060, 1),        RESET(0xD304),
+    END};
+
+static const mock_type_t types[] = {
+    [I2C_MOCK_SCD30] = {"SCD30", scd30_cmds, 2000, 0x4600},
+    [I2C_MOCK_SEN44] = {"SEN44", sen44_cmds, 1000, 0},
+    [I2C_MOCK_SEN5X] = {"SEN55", sen5x_cmds, 1000, 0},
+    [I2C_MOCK_SEN66] = {"SEN66", sen66_cmds, 1000, 0},
+    [I2C_MOCK_SFA3X] = {"SFA30", sfa3x_cmds, 500, 0},
+};
+
+static i2c_mock_config_t cfg;
+static uint32_t rng = 0x2545F491u;
+static _Atomic uint64_t vclock_usec;
+static i2c_mock_stats_t stats;
+
+static mock_dev_t* devs;
+static size_t ndevs;
+static size_t devs_cap;
+static int32_t (*bus_map)[MOCK_ADDRESSES];
+static unsigned nbuses;
+static unsigned cur_bus;
+
+/* ---------- Helpers ---------- */
+
+static uint32_t next_rand(void) {
+    uint32_t x = rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng = x;
+}
+
+static int chance(uint32_t ppm) {
+    return ppm && next_rand() % 1000000u < ppm;
+}
+
+static uint32_t mix(uint32_t a, uint32_t b) {
+    uint32_t h = a * 0x9E3779B1u ^ b;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+static uint64_t now_usec(void) {
+    if (cfg.virtual_time) return atomic_load(&vclock_usec);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void pass_time(uint32_t usec) {
+    if (usec == 0) return;
+    if (cfg.virtual_time) {
+        atomic_fetch_add(&vclock_usec, usec);
+    } else {
+        usleep(usec);
+    }
+}
+
+static mock_dev_t* lookup(int fd, uint8_t address) {
+    unsigned bus = fd == SENSIRION_I2C_HAL_DEFAULT_FD ? cur_bus : (unsigned)fd;
+    if (bus >= nbuses || address >= MOCK_ADDRESSES) return NULL;
+    int32_t i = bus_map[bus][address];
+    return i < 0 ? NULL : &devs[i];
+}
+
+static const mock_cmd_t* find_cmd(const mock_dev_t* d, uint16_t cmd) {
+    for (const mock_cmd_t* c = types[d->type].cmds; c->cmd; c++) {
+        if (c->cmd == cmd) return c;
+    }
+    return NULL;
+}
+
+static uint16_t* reg_slot(mock_dev_t* d, const mock_cmd_t* c) {
+    for (uint8_t i = 0; i < d->nregs; i++) {
+        if (d->reg_cmd[i] == c->cmd) return d->reg_val[i];
+    }
+    if (d->nregs == MOCK_REGS) return NULL;
+    uint16_t* v = d->reg_val[d->nregs];
+    d->reg_cmd[d->nregs++] = c->cmd;
+    memset(v, 0, sizeof(d->reg_val[0]));
+    v[0] = c->dflt[0];
+    v[1] = c->dflt[1];
+    return v;
+}
+
+static void power_on(mock_dev_t* d) {
+    d->measuring = 0;
+    d->pending = 0;
+    d->nregs = 0;
+    d->consumed = 0;
+    d->interval_usec = types[d->type].interval_ms * 1000u;
+}
+
+static uint64_t sample_index(const mock_dev_t* d) {
+    return (now_usec() - d->start_usec) / d->interval_usec;
+}
+
+static int32_t field_value(const mock_dev_t* d, const mock_field_t* f,
+                           uint64_t idx, unsigned n) {
+    int32_t t = (int32_t)((idx + d->id * 7) % MOCK_WAVE);
+    int32_t w = t < MOCK_WAVE / 2 ? t - MOCK_WAVE / 4 : 3 * MOCK_WAVE / 4 - t;
+    int32_t v = f->base + f->swing * w / (MOCK_WAVE / 4);
+    int32_t noise = f->swing / 10;
+    if (noise > 0) {
+        v += (int32_t)(mix(d->id ^ (uint32_t)idx, n) % (uint32_t)(2 * noise + 1)) -
+             noise;
+    }
+    return v;
+}
+
+/* ---------- Command execution ---------- */
+
+static void build_sample(mock_dev_t* d, const mock_cmd_t* c) {
+    uint64_t idx = sample_index(d);
+    d->consumed = idx;
+
+    uint8_t w = 0;
+    for (unsigned n = 0; w < c->words; n++) {
+        const mock_field_t* f = &c->fields[n];
+        int32_t v = field_value(d, f, idx, n);
+        if (f->scale) {
+            float fv = (float)v / (float)f->scale;
+            uint32_t bits;
+            memcpy(&bits, &fv, sizeof(bits));
+            d->resp[w++] = (uint16_t)(bits >> 16);
+            d->resp[w++] = (uint16_t)bits;
+        } else {
+            d->resp[w++] = (uint16_t)v;
+        }
+    }
+}
+
+static void build_text(mock_dev_t* d, const mock_cmd_t* c) {
+    char text[MOCK_RESP_WORDS * 2] = {0};
+    if (c->dflt[0] == 0) {
+        snprintf(text, sizeof(text), "%s", types[d->type].name);
+    } else {
+        snprintf(text, sizeof(text), "MOCK%08X", (unsigned)d->id);
+    }
+    for (int i = 0; i < MOCK_RESP_WORDS; i++) {
+        d->resp[i] = (uint16_t)((uint8_t)text[2 * i] << 8 |
+                                (uint8_t)text[2 * i + 1]);
+    }
+}
+
+/* Returns 0, or -1 where the sensor would NACK. */
+static int execute(mock_dev_t* d, const mock_cmd_t* c, const uint16_t* args,
+                   uint8_t nargs) {
+    d->pending = 0;
+    switch (c->kind) {
+    case CMD_START:
+        d->measuring = 1;
+        d->start_usec = now_usec();
+        d->consumed = 0;
+        return 0;
+    case CMD_STOP:
+        d->measuring = 0;
+        return 0;
+    case CMD_RESET:
+        power_on(d);
+        return 0;
+    case CMD_NOOP:
+        return 0;
+    case CMD_READY:
+        d->resp[0] = d->measuring && sample_index(d) > d->consumed;
+        break;
+    case CMD_SAMPLE:
+        if (!d->measuring) return -1;
+        build_sample(d, c);
+        break;
+    case CMD_REG: {
+        uint16_t* v = reg_slot(d, c);
+        if (!v || nargs > MOCK_REG_WORDS) return -1;
+        if (nargs) {
+            memcpy(v, args, nargs * sizeof(uint16_t));
+            if (c->cmd == types[d->type].interval_cmd && args[0])
+                d->interval_usec = args[0] * 1000000u;
+        }
+        memcpy(d->resp, v, c->words * sizeof(uint16_t));
+        break;
+    }
+    case CMD_TEXT:
+        build_text(d, c);
+        break;
+    }
+    d->resp_words = c->words;
+    d->pending = c->words != 0;
+    return 0;
+}
+
+/* ---------- Control API ---------- */
+
+void i2c_mock_configure(const i2c_mock_config_t* c) {
+    cfg = *c;
+    rng = cfg.seed ? cfg.seed : 0x2545F491u;
+}
+
+int i2c_mock_add_sensor(unsigned bus, uint8_t address, i2c_mock_sensor_t type) {
+    if (address >= MOCK_ADDRESSES || type > I2C_MOCK_SFA3X) return -1;
+
+    if (bus >= nbuses) {
+        unsigned n = bus + 1;
+        int32_t (*m)[MOCK_ADDRESSES] = realloc(bus_map, n * sizeof(*m));
+        if (!m) return -1;
+        memset(m + nbuses, 0xFF, (n - nbuses) * sizeof(*m));
+        bus_map = m;
+        nbuses = n;
+    }
+    if (bus_map[bus][address] >= 0) return -1;
+
+    if (ndevs == devs_cap) {
+        size_t cap = devs_cap ? devs_cap * 2 : 16;
+        mock_dev_t* d = realloc(devs, cap * sizeof(*d));
+        if (!d) return -1;
+        devs = d;
+        devs_cap = cap;
+    }
+
+    mock_dev_t* d = &devs[ndevs];
+    memset(d, 0, sizeof(*d));
+    d->type = type;
+    d->id = mix((uint32_t)ndevs, bus << 8 | address);
+    power_on(d);
+    bus_map[bus][address] = (int32_t)ndevs++;
+    return 0;
+}
+
+void i2c_mock_select_bus(unsigned bus) {
+    cur_bus = bus;
+}
+
+void i2c_mock_get_stats(i2c_mock_stats_t* out) {
+    *out = stats;
+}
+
+void i2c_mock_reset(void) {
+    free(devs);
+    free(bus_map);
+    devs = NULL;
+    bus_map = NULL;
+    ndevs = devs_cap = 0;
+    nbuses = 0;
+    cur_bus = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+/* ---------- sensirion_i2c_hal API ---------- */
+
+void sensirion_i2c_hal_init(void) {
+    if (ndevs) return;
+    i2c_mock_add_sensor(0, 0x61, I2C_MOCK_SCD30);
+    i2c_mock_add_sensor(0, 0x69, I2C_MOCK_SEN5X);
+    i2c_mock_add_sensor(0, 0x6B, I2C_MOCK_SEN66);
+    i2c_mock_add_sensor(0, 0x5D, I2C_MOCK_SFA3X);
+}
+
+/* The bus number doubles as the fd. */
+int sensirion_i2c_hal_open_bus(unsigned bus) {
+    return bus < nbuses ? (int)bus : -1;
+}
+
+void sensirion_i2c_hal_close_bus(int fd) {
+    (void)fd;
+}
+
+void sensirion_i2c_hal_sleep_usec(uint32_t useconds) {
+    pass_time(useconds);
+}
+
+uint64_t sensirion_i2c_hal_get_time_usec(void) {
+    return now_usec();
+}
+
+int8_t sensirion_i2c_hal_write(uint8_t address, const uint8_t* data,
+                               uint16_t count) {
+    return sensirion_i2c_hal_write_fd(SENSIRION_I2C_HAL_DEFAULT_FD, address,
+                                      data, count);
+}
+
+int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
+    return sensirion_i2c_hal_read_fd(SENSIRION_I2C_HAL_DEFAULT_FD, address,
+                                     data, count);
+}
+
+int8_t sensirion_i2c_hal_write_fd(int fd, uint8_t address, const uint8_t* data,
+                                  uint16_t count) {
+    pass_time(cfg.latency_usec);
+    stats.writes++;
+    stats.bytes += count;
+
+    mock_dev_t* d = lookup(fd, address);
+    if (!d) return -1;
+    if (chance(cfg.nack_ppm)) {
+        stats.nacks++;
+        return -1;
+    }
+
+    uint16_t args[MOCK_REG_WORDS];
+    uint8_t nargs = 0;
+    const mock_cmd_t* c = NULL;
+    if (count >= 2 && (count - 2) % 3 == 0 &&
+        (count - 2) / 3 <= MOCK_REG_WORDS) {
+        c = find_cmd(d, (uint16_t)(data[0] << 8 | data[1]));
+    }
+    for (uint16_t i = 2; c && i < count; i += 3) {
+        if (sensirion_i2c_generate_crc_word(&data[i]) != data[i + 2]) c = NULL;
+        else args[nargs++] = (uint16_t)(data[i] << 8 | data[i + 1]);
+    }
+    if (!c || execute(d, c, args, nargs) != 0) {
+        d->pending = 0;
+        stats.rejected++;
+        return -1;
+    }
+    return 0;
+}
+
+int8_t sensirion_i2c_hal_read_fd(int fd, uint8_t address, uint8_t* data,
+                                 uint16_t count) {
+    pass_time(cfg.latency_usec);
+    stats.reads++;
+    stats.bytes += count;
+
+    mock_dev_t* d = lookup(fd, address);
+    if (!d) return -1;
+    if (chance(cfg.nack_ppm)) {
+        stats.nacks++;
+        return -1;
+    }
+    if (!d->pending || count != d->resp_words * 3) {
+        d->pending = 0;
+        stats.rejected++;
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < d->resp_words; i++) {
+        uint8_t* p = &data[i * 3];
+        p[0] = (uint8_t)(d->resp[i] >> 8);
+        p[1] = (uint8_t)d->resp[i];
+        p[2] = sensirion_i2c_generate_crc_word(p);
+        if (chance(cfg.crc_ppm)) {
+            p[2] ^= 0x01;
+            stats.crc_faults++;
+        }
+    }
+    d->pending = 0;
+    return 0;
+}
+
+/* Messages are played in order; a failing one ends the transfer. */
+int8_t sensirion_i2c_hal_transfer_fd(int fd, sensirion_i2c_hal_msg_t* msgs,
+                                     uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        sensirion_i2c_hal_msg_t* m = &msgs[i];
+        int8_t err = m->read
+                         ? sensirion_i2c_hal_read_fd(fd, m->address, m->data,
+                                                     m->count)
+                         : sensirion_i2c_hal_write_fd(fd, m->address, m->data,
+                                                      m->count);
+        if (err) return err;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "influx_line.h"
+#include "sample_ring.h"
+
+#include <string.h>
+
+void influx_line_init(influx_line_t* lp, char* buf, size_t cap) {
+    lp->buf = buf;
+    lp->cap = cap;
+    influx_line_reset(lp);
+}
+
+void influx_line_reset(influx_line_t* lp) {
+    lp->len = 0;
+    lp->pos = 0;
+    lp->fields = 0;
+    lp->overflow = 0;
+    if (lp->cap) lp->buf[0] = '\0';
+}
+
+/* Keeps one byte for the terminating NUL. */
+static int room(influx_line_t* lp, size_t n) {
+    if (lp->overflow || lp->pos + n >= lp->cap) {
+        lp->overflow = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static void put(influx_line_t* lp, const char* s, size_t n) {
+    if (!room(lp, n)) return;
+    memcpy(lp->buf + lp->pos, s, n);
+    lp->pos += n;
+}
+
+static void put_char(influx_line_t* lp, char c) {
+    if (room(lp, 1)) lp->buf[lp->pos++] = c;
+}
+
+/* Backslash before space, comma and (if eq) the equals sign. */
+static void put_escaped(influx_line_t* lp, const char* s, int eq) {
+    size_t n = strcspn(s, eq ? " ,=" : " ,");
+    put(lp, s, n);
+    for (s += n; *s; s++) {
+        if (*s == ' ' || *s == ',' || (eq && *s == '=')) put_char(lp, '\\');
+        put_char(lp, *s);
+    }
+}
+
+void influx_line_begin(influx_line_t* lp, const char* measurement) {
+    lp->pos = lp->len;
+    lp->fields = 0;
+    lp->overflow = 0;
+    if (lp->len) put_char(lp, '\n');
+    put_escaped(lp, measurement, 0);
+}
+
+void influx_line_tag(influx_line_t* lp, const char* key, const char* value) {
+    put_char(lp, ',');
+    put_escaped(lp, key, 1);
+    put_char(lp, '=');
+    put_escaped(lp, value, 1);
+}
+
+void influx_line_field_fixed(influx_line_t* lp, const char* key,
+                             int32_t value, uint16_t scale, uint8_t decimals) {
+    char num[24];
+    int n = sample_format_fixed(value, scale, decimals, num, sizeof(num));
+
+    put_char(lp, lp->fields++ ? ',' : ' ');
+    put_escaped(lp, key, 1);
+    put_char(lp, '=');
+    put(lp, num, (size_t)n);
+}
+
+int influx_line_end(influx_line_t* lp, uint64_t timestamp) {
+    char digits[21];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = (char)('0' + timestamp % 10);
+        timestamp /= 10;
+    } while (timestamp);
+
+    put_char(lp, ' ');
+    put(lp, p, (size_t)(digits + sizeof(digits) - p));
+
+    if (lp->overflow || lp->fields == 0) {
+        if (lp->cap) lp->buf[lp->len] = '\0';
+        return -1;
+    }
+    lp->len = lp->pos;
+    lp->buf[lp->len] = '\0';
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "influx_sender.h"
+#include "sensirion_i2c_hal.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#define SENDER_WAKE_MS 1000
+#define SENDER_REPORT_USEC (60ULL * 1000000ULL)
+
+/* An empty slot marks the end of a sweep. */
+#define TICK_MARKER '\0'
+
+/* Producer side: only reached when the ring is full. The append only
+ * writes; the sender thread syncs and rotates. */
+static int spill_line(influx_sender_t* s, const char* line, size_t n) {
+    char rec[INFLUX_SENDER_LINE_MAX + 1];
+    memcpy(rec, line, n);
+    rec[n] = '\n';
+    return spool_append(&s->spool, rec, n + 1);
+}
+
+/* Writer hook: a batch could not be delivered, keep it on disk. */
+static void spool_failed_batch(void* ctx, const char* body, size_t len) {
+    influx_sender_t* s = ctx;
+    if (spool_append(&s->spool, body, len) != 0) {
+        fprintf(stderr, "InfluxDB batch lost (%zu bytes), spool failed\n", len);
+    }
+}
+
+static int send_spooled(void* ctx, const char* body, size_t len) {
+    influx_sender_t* s = ctx;
+    /* A rejected batch will never succeed; consume it rather than
+     * blocking the rest of the spool behind it. */
+    return influx_writer_post(&s->writer, body, len) == INFLUX_WRITE_RETRY;
+}
+
+static void report(influx_sender_t* s) {
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+    if (now - s->report_usec < SENDER_REPORT_USEC) return;
+    s->report_usec = now;
+
+    influx_sender_stats_t st;
+    influx_sender_get_stats(s, &st);
+    printf("InfluxDB queue: depth %u (max %u of %u), %llu dropped, "
+           "%llu spilled\n",
+           st.depth, st.max_depth, spsc_ring_capacity(&s->ring),
+           (unsigned long long)st.dropped, (unsigned long long)st.spilled);
+
+    if (s->have_spool) {
+        spool_stats_t sp;
+        spool_get_stats(&s->spool, &sp);
+        printf("InfluxDB spool: %u segments, %llu records in, %llu replayed, "
+               "%llu syncs, %llu damaged, %llu segments dropped\n",
+               sp.segments, (unsigned long long)sp.appended,
+               (unsigned long long)sp.replayed, (unsigned long long)sp.syncs,
+               (unsigned long long)sp.corrupt,
+               (unsigned long long)sp.dropped_segments);
+    }
+}
+
+static void wait_for_work(influx_sender_t* s) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += SENDER_WAKE_MS / 1000;
+    ts.tv_nsec += (long)(SENDER_WAKE_MS % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&s->wake, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static void* sender_main(void* arg) {
+    influx_sender_t* s = arg;
+
+    for (;;) {
+        const char* slot;
+        while ((slot = spsc_ring_peek(&s->ring)) != NULL) {
+            if (slot[0] == TICK_MARKER) {
+                influx_writer_end_tick(&s->writer);
+            } else {
+                influx_writer_add_line(&s->writer, slot);
+            }
+            spsc_ring_release(&s->ring);
+        }
+
+        if (atomic_load(&s->stop)) break;
+
+        influx_writer_poll(&s->writer);
+        int more = 0;
+        if (s->have_spool) {
+            spool_maintain(&s->spool);
+            if (s->writer.last_ok && spool_pending(&s->spool)) {
+                more = spool_replay(&s->spool, send_spooled, s,
+                                    s->cfg.replay_batches) == 1;
+            }
+        }
+        report(s);
+        /* While a backlog drains, only yield to new lines between rounds. */
+        if (!more) wait_for_work(s);
+    }
+
+    influx_writer_flush(&s->writer);
+    return NULL;
+}
+
+int influx_sender_start(influx_sender_t* s, const influx_sender_config_t* cfg) {
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    if (s->cfg.replay_batches == 0) s->cfg.replay_batches = 1;
+
+    influx_writer_config_t wcfg = cfg->writer;
+    if (cfg->spool.dir) {
+        /* every failed batch must fit in one spool record */
+        if (s->cfg.spool.replay_bytes < wcfg.max_bytes)
+            s->cfg.spool.replay_bytes = wcfg.max_bytes;
+        if (spool_open(&s->spool, &s->cfg.spool) != 0) return -1;
+        s->have_spool = 1;
+        wcfg.on_failed = spool_failed_batch;
+        wcfg.on_failed_ctx = s;
+    } else if (s->cfg.policy == INFLUX_QUEUE_SPILL) {
+        s->cfg.policy = INFLUX_QUEUE_DROP;
+    }
+
+    if (influx_writer_init(&s->writer, &wcfg) != 0) {
+        if (s->have_spool) spool_close(&s->spool);
+        return -1;
+    }
+    if (spsc_ring_init(&s->ring, cfg->queue_lines, INFLUX_SENDER_LINE_MAX)) {
+        influx_writer_free(&s->writer);
+        if (s->have_spool) spool_close(&s->spool);
+        return -1;
+    }
+    sem_init(&s->wake, 0, 0);
+    atomic_init(&s->stop, 0);
+    s->report_usec = sensirion_i2c_hal_get_time_usec();
+
+    if (pthread_create(&s->thread, NULL, sender_main, s) != 0) {
+        sem_destroy(&s->wake);
+        spsc_ring_free(&s->ring);
+        influx_writer_free(&s->writer);
+        if (s->have_spool) spool_close(&s->spool);
+        return -1;
+    }
+    return 0;
+}
+
+int influx_sender_push(influx_sender_t* s, const char* line) {
+    size_t n = strlen(line);
+    if (n == 0) return 0;
+    if (n >= INFLUX_SENDER_LINE_MAX) {
+        fprintf(stderr, "InfluxDB line too long (%zu bytes), dropped\n", n);
+        atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    char* slot = spsc_ring_reserve(&s->ring);
+    if (!slot) {
+        if (s->cfg.policy == INFLUX_QUEUE_SPILL && spill_line(s, line, n) == 0) {
+            atomic_fetch_add_explicit(&s->spilled, 1, memory_order_relaxed);
+            return 0;
+        }
+        atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    memcpy(slot, line, n + 1);
+    spsc_ring_commit(&s->ring);
+    atomic_fetch_add_explicit(&s->pushed, 1, memory_order_relaxed);
+
+    uint32_t depth = spsc_ring_depth(&s->ring);
+    if (depth > atomic_load_explicit(&s->max_depth, memory_order_relaxed))
+        atomic_store_explicit(&s->max_depth, depth, memory_order_relaxed);
+    return 0;
+}
+
+void influx_sender_end_tick(influx_sender_t* s) {
+    /* A lost marker only merges two sweeps into one batch. */
+    char* slot = spsc_ring_reserve(&s->ring);
+    if (slot) {
+        slot[0] = TICK_MARKER;
+        spsc_ring_commit(&s->ring);
+    }
+    sem_post(&s->wake);
+}
+
+void influx_sender_get_stats(influx_sender_t* s, influx_sender_stats_t* out) {
+    out->pushed = atomic_load_explicit(&s->pushed, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&s->dropped, memory_order_relaxed);
+    out->spilled = atomic_load_explicit(&s->spilled, memory_order_relaxed);
+    out->depth = spsc_ring_depth(&s->ring);
+    out->max_depth = atomic_load_explicit(&s->max_depth, memory_order_relaxed);
+}
+
+void influx_sender_stop(influx_sender_t* s) {
+    atomic_store(&s->stop, 1);
+    sem_post(&s->wake);
+    pthread_join(s->thread, NULL);
+
+    sem_destroy(&s->wake);
+    spsc_ring_free(&s->ring);
+    /* Final flush may still hand a failed batch to the spool. */
+    influx_writer_free(&s->writer);
+    if (s->have_spool) spool_close(&s->spool);
+}
@@ -0,0 +1,65 @@
+#include "influx_sink.h"
+#include "influx_line.h"
+
+#include <ctype.h>
+#include <string.h>
+
+int influx_sink_start(influx_sink_t* k, const influx_sink_config_t* cfg) {
+    memset(k, 0, sizeof(*k));
+    k->cfg = *cfg;
+    return influx_sender_start(&k->sender, &k->cfg.sender);
+}
+
+static const char* const* field_names(const influx_sink_t* k,
+                                      const char* sensor) {
+    for (const influx_sink_fields_t* f = k->cfg.fields; f && f->sensor; f++) {
+        if (strcmp(f->sensor, sensor) == 0) return f->fields;
+    }
+    return NULL;
+}
+
+/* Values the sensor reported as unknown are left out of the line. */
+static void influx_sample(sample_sink_t* s, const sensor_ticks_t* t,
+                          uint64_t ts_ms) {
+    influx_sink_t* k = s->state;
+    const char* const* names = field_names(k, t->name);
+    influx_line_t lp;
+    influx_line_init(&lp, k->line, sizeof(k->line));
+    influx_line_begin(&lp, t->name);
+
+    if (k->cfg.device_tag) {
+        char device[16];
+        size_t n = 0;
+        for (; t->name[n] && n < sizeof(device) - 1; n++)
+            device[n] = (char)toupper((unsigned char)t->name[n]);
+        device[n] = '\0';
+        influx_line_tag(&lp, k->cfg.device_tag, device);
+    }
+
+    for (unsigned i = 0; i < t->count; i++) {
+        if (sensor_ticks_status(t, i) != SAMPLE_OK) continue;
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        influx_line_field_fixed(&lp, names ? names[i] : c->field,
+                                sample_channel_value(c, sensor_ticks_raw(t, i)),
+                                c->scale, c->decimals);
+    }
+    if (influx_line_end(&lp, ts_ms) == 0) influx_sender_push(&k->sender, k->line);
+}
+
+static void influx_tick(sample_sink_t* s, uint64_t now_usec) {
+    (void)now_usec;
+    influx_sink_t* k = s->state;
+    influx_sender_end_tick(&k->sender);
+}
+
+static void influx_stop(sample_sink_t* s) {
+    influx_sink_t* k = s->state;
+    influx_sender_stop(&k->sender);
+}
+
+const sample_sink_ops_t influx_sink_ops = {
+    .name = "influx",
+    .sample = influx_sample,
+    .tick = influx_tick,
+    .stop = influx_stop,
+};
@@ -0,0 +1,228 @@
+#include "influx_writer.h"
+#include "sensirion_i2c_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STATS_WINDOW_USEC (60ULL * 1000000ULL)
+
+/* Influx answers every POST; keep the body out of stdout. */
+static size_t discard_response(char* ptr, size_t size, size_t nmemb,
+                               void* userdata) {
+    (void)ptr;
+    (void)userdata;
+    return size * nmemb;
+}
+
+static struct curl_slist* header_list(const char* token, int gzip) {
+    struct curl_slist* h = curl_slist_append(
+        NULL, "Content-Type: text/plain; charset=utf-8");
+    if (token) {
+        char auth[256];
+        snprintf(auth, sizeof(auth), "Authorization: Token %s", token);
+        h = curl_slist_append(h, auth);
+    }
+    if (gzip) h = curl_slist_append(h, "Content-Encoding: gzip");
+    return h;
+}
+
+int influx_writer_init(influx_writer_t* w, const influx_writer_config_t* cfg) {
+    memset(w, 0, sizeof(*w));
+    w->cfg = *cfg;
+    if (w->cfg.max_ticks == 0) w->cfg.max_ticks = 1;
+
+    w->body = malloc(w->cfg.max_bytes);
+    if (!w->body) return -1;
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    w->curl = curl_easy_init();
+    if (!w->curl) {
+        free(w->body);
+        w->body = NULL;
+        return -1;
+    }
+
+    w->headers = header_list(w->cfg.token, 0);
+
+    /* windowBits 15 + 16: gzip wrapper instead of zlib's */
+    if (w->cfg.gzip_level > 0) {
+        int level = w->cfg.gzip_level > 9 ? 9 : w->cfg.gzip_level;
+        if (deflateInit2(&w->zs, level, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) == Z_OK) {
+            w->have_zs = 1;
+            w->gzip_headers = header_list(w->cfg.token, 1);
+        } else {
+            fprintf(stderr, "InfluxDB gzip unavailable, sending plain\n");
+        }
+    }
+
+    curl_easy_setopt(w->curl, CURLOPT_URL, w->cfg.url);
+    curl_easy_setopt(w->curl, CURLOPT_HTTPHEADER, w->headers);
+    curl_easy_setopt(w->curl, CURLOPT_TIMEOUT_MS, w->cfg.timeout_ms);
+    curl_easy_setopt(w->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(w->curl, CURLOPT_WRITEFUNCTION, discard_response);
+
+    w->last_ok = 1;
+    w->window_start_usec = sensirion_i2c_hal_get_time_usec();
+    return 0;
+}
+
+/* Deflate body into w->zbody. Returns the compressed size, or 0 if it
+ * failed or would not be smaller than the input. */
+static size_t gzip_body(influx_writer_t* w, const char* body, size_t len) {
+    size_t bound = deflateBound(&w->zs, (uLong)len);
+    if (bound > w->zcap) {
+        unsigned char* p = realloc(w->zbody, bound);
+        if (!p) return 0;
+        w->zbody = p;
+        w->zcap = bound;
+    }
+
+    deflateReset(&w->zs);
+    w->zs.next_in = (Bytef*)body;
+    w->zs.avail_in = (uInt)len;
+    w->zs.next_out = w->zbody;
+    w->zs.avail_out = (uInt)w->zcap;
+    if (deflate(&w->zs, Z_FINISH) != Z_STREAM_END) return 0;
+    return w->zs.total_out < len ? (size_t)w->zs.total_out : 0;
+}
+
+int influx_writer_post(influx_writer_t* w, const char* body, size_t len) {
+    size_t wire = 0;
+    if (w->have_zs && len >= w->cfg.gzip_min_bytes)
+        wire = gzip_body(w, body, len);
+
+    if (wire) {
+        curl_easy_setopt(w->curl, CURLOPT_HTTPHEADER, w->gzip_headers);
+        curl_easy_setopt(w->curl, CURLOPT_POSTFIELDS, w->zbody);
+    } else {
+        wire = len;
+        curl_easy_setopt(w->curl, CURLOPT_HTTPHEADER, w->headers);
+        curl_easy_setopt(w->curl, CURLOPT_POSTFIELDS, body);
+    }
+    curl_easy_setopt(w->curl, CURLOPT_POSTFIELDSIZE, (long)wire);
+
+    int ret = INFLUX_WRITE_OK;
+    CURLcode res = curl_easy_perform(w->curl);
+    if (res != CURLE_OK) {
+        fprintf(stderr, "InfluxDB write failed: %s\n", curl_easy_strerror(res));
+        ret = INFLUX_WRITE_RETRY;
+    } else {
+        long status = 0;
+        curl_easy_getinfo(w->curl, CURLINFO_RESPONSE_CODE, &status);
+        if (status >= 300) {
+            fprintf(stderr, "InfluxDB write rejected: HTTP %ld\n", status);
+            ret = (status == 429 || status >= 500) ? INFLUX_WRITE_RETRY
+                                                   : INFLUX_WRITE_REJECTED;
+        }
+    }
+
+    /* A 4xx still proves the server is reachable. */
+    w->last_ok = (ret != INFLUX_WRITE_RETRY);
+    w->total.posts++;
+    w->window.posts++;
+    if (ret == INFLUX_WRITE_OK) {
+        w->total.bytes += len;
+        w->window.bytes += len;
+        w->total.wire_bytes += wire;
+        w->window.wire_bytes += wire;
+    } else {
+        w->total.failed_posts++;
+        w->window.failed_posts++;
+    }
+    return ret;
+}
+
+int influx_writer_flush(influx_writer_t* w) {
+    if (w->len == 0) return 0;
+
+    int ret = influx_writer_post(w, w->body, w->len);
+    if (ret == INFLUX_WRITE_RETRY && w->cfg.on_failed) {
+        w->cfg.on_failed(w->cfg.on_failed_ctx, w->body, w->len);
+    }
+
+    w->len = 0;
+    w->ticks = 0;
+    return ret == INFLUX_WRITE_OK ? 0 : -1;
+}
+
+int influx_writer_add_line(influx_writer_t* w, const char* line) {
+    size_t n = strlen(line);
+
+    /* +1 for the separating newline */
+    if (n + 1 > w->cfg.max_bytes) {
+        fprintf(stderr, "InfluxDB line too long (%zu bytes), dropped\n", n);
+        return -1;
+    }
+    if (w->len + n + 1 > w->cfg.max_bytes) {
+        influx_writer_flush(w);
+    }
+
+    if (w->len == 0) w->oldest_usec = sensirion_i2c_hal_get_time_usec();
+    memcpy(w->body + w->len, line, n);
+    w->len += n;
+    w->body[w->len++] = '\n';
+
+    w->total.lines++;
+    w->window.lines++;
+    return 0;
+}
+
+static void report_window(influx_writer_t* w, uint64_t now) {
+    if (now - w->window_start_usec < STATS_WINDOW_USEC) return;
+
+    const influx_writer_stats_t* s = &w->window;
+    printf("InfluxDB: %llu lines in %llu POSTs last minute "
+           "(%llu round-trips saved, %llu failed, %llu bytes",
+           (unsigned long long)s->lines, (unsigned long long)s->posts,
+           (unsigned long long)(s->lines > s->posts ? s->lines - s->posts : 0),
+           (unsigned long long)s->failed_posts, (unsigned long long)s->bytes);
+    if (w->have_zs)
+        printf(", %llu on the wire", (unsigned long long)s->wire_bytes);
+    printf(")\n");
+
+    memset(&w->window, 0, sizeof(w->window));
+    w->window_start_usec = now;
+}
+
+int influx_writer_poll(influx_writer_t* w) {
+    int ret = 0;
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+
+    if (w->len > 0 &&
+        (w->ticks >= w->cfg.max_ticks ||
+         now - w->oldest_usec >= (uint64_t)w->cfg.max_age_ms * 1000)) {
+        ret = influx_writer_flush(w);
+    }
+
+    report_window(w, now);
+    return ret;
+}
+
+int influx_writer_end_tick(influx_writer_t* w) {
+    if (w->len > 0) w->ticks++;
+    return influx_writer_poll(w);
+}
+
+void influx_writer_free(influx_writer_t* w) {
+    if (w->curl) {
+        influx_writer_flush(w);
+        curl_easy_cleanup(w->curl);
+        w->curl = NULL;
+    }
+    curl_slist_free_all(w->headers);
+    curl_slist_free_all(w->gzip_headers);
+    w->headers = NULL;
+    w->gzip_headers = NULL;
+    if (w->have_zs) {
+        deflateEnd(&w->zs);
+        w->have_zs = 0;
+    }
+    free(w->zbody);
+    w->zbody = NULL;
+    w->zcap = 0;
+    free(w->body);
+    w->body = NULL;
+    curl_global_cleanup();
+}
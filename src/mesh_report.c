@@ -0,0 +1,405 @@
+#include "mesh_report.h"
+
+#include <math.h>
+#include <string.h>
+
+#define S SAMPLE_CHANNEL_SIGNED
+#define C (SAMPLE_CHANNEL_SIGNED | SAMPLE_CHANNEL_CELSIUS)
+
+/* Same scales as sensor_ticks.c; frozen here as the wire layout. */
+static const sample_channel_t scd30_channels[] = {
+    {"scd30", "co2", 1, 0, 0},
+    {"scd30", "temperature", 200, 2, C},
+    {"scd30", "humidity", 100, 2, S},
+};
+static const sample_channel_t sen44_channels[] = {
+    {"sen44", "pm1", 1, 0, 0},        {"sen44", "pm2_5", 1, 0, 0},
+    {"sen44", "pm4", 1, 0, 0},        {"sen44", "pm10", 1, 0, 0},
+    {"sen44", "voc", 10, 1, S},       {"sen44", "humidity", 100, 2, S},
+    {"sen44", "temperature", 200, 2, C},
+};
+static const sample_channel_t sen5x_channels[] = {
+    {"sen5x", "pm1", 10, 1, 0},       {"sen5x", "pm2_5", 10, 1, 0},
+    {"sen5x", "pm4", 10, 1, 0},       {"sen5x", "pm10", 10, 1, 0},
+    {"sen5x", "humidity", 100, 2, S}, {"sen5x", "temperature", 200, 2, C},
+    {"sen5x", "voc", 10, 1, S},       {"sen5x", "nox", 10, 1, S},
+};
+static const sample_channel_t sen66_channels[] = {
+    {"sen66", "pm1", 10, 1, 0},       {"sen66", "pm2_5", 10, 1, 0},
+    {"sen66", "pm4", 10, 1, 0},       {"sen66", "pm10", 10, 1, 0},
+    {"sen66", "humidity", 100, 2, S}, {"sen66", "temperature", 200, 2, C},
+    {"sen66", "voc", 10, 1, S},       {"sen66", "nox", 10, 1, S},
+    {"sen66", "co2", 1, 0, 0},
+};
+static const sample_channel_t sfa3x_channels[] = {
+    {"sfa3x", "hcho", 5, 1, S},
+    {"sfa3x", "humidity", 100, 2, S},
+    {"sfa3x", "temperature", 200, 2, C},
+};
+
+#undef S
+#undef C
+
+/* Dead-bands in ticks: 20 ppm CO2, 0.3 °C, 2 %RH, 2 µg/m³ PM, 10 VOC /
+ * 5 NOx index points, 5 ppb HCHO. Steady indoor air stays inside them. */
+static const uint16_t scd30_deadband[] = {20, 60, 200};
+static const uint16_t sen44_deadband[] = {2, 2, 2, 2, 100, 200, 60};
+static const uint16_t sen5x_deadband[] = {20, 20, 20, 20, 200, 60, 100, 50};
+static const uint16_t sen66_deadband[] = {20, 20, 20, 20, 200, 60, 100, 50, 20};
+static const uint16_t sfa3x_deadband[] = {25, 200, 60};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+#define SENSOR(name, model, x) {name, model, COUNT(x##_channels), x##_channels, x##_deadband}
+
+const mesh_report_sensor_t mesh_report_sensors[MESH_REPORT_SENSORS] = {
+    [MESH_REPORT_SCD30] = SENSOR("SCD30", "scd30", scd30),
+    [MESH_REPORT_SEN44] = SENSOR("SEN44", "sen44", sen44),
+    [MESH_REPORT_SEN5X] = SENSOR("SEN55", "sen5x", sen5x),
+    [MESH_REPORT_SEN66] = SENSOR("SEN66", "sen66", sen66),
+    [MESH_REPORT_SFA3X] = SENSOR("SFA3X", "sfa3x", sfa3x),
+};
+
+#undef SENSOR
+
+int mesh_report_slot(const char* model) {
+    for (unsigned i = 0; i < MESH_REPORT_SENSORS; i++) {
+        if (model && strcmp(model, mesh_report_sensors[i].model) == 0) return (int)i;
+    }
+    return -1;
+}
+
+void mesh_report_clear(mesh_report_t* r) {
+    memset(r, 0, sizeof(*r));
+}
+
+static uint16_t all_channels(unsigned slot) {
+    return (uint16_t)((1u << mesh_report_sensors[slot].count) - 1);
+}
+
+void mesh_report_set(mesh_report_t* r, unsigned slot, const uint16_t* raw) {
+    memcpy(r->raw[slot], raw, mesh_report_sensors[slot].count * sizeof(*raw));
+    r->present |= (uint8_t)(1u << slot);
+    r->carried[slot] = all_channels(slot);
+}
+
+uint16_t mesh_report_ticks(unsigned slot, unsigned channel, float value) {
+    const sample_channel_t* c = &mesh_report_sensors[slot].channels[channel];
+    float v = value * (float)c->scale;
+
+    if (c->flags & SAMPLE_CHANNEL_SIGNED) {
+        if (isnan(v) || v < -32768.0f || v > 32766.0f) return 0x7FFF;
+        return (uint16_t)(int16_t)lrintf(v);
+    }
+    if (isnan(v) || v < 0.0f || v > 65534.0f) return 0xFFFF;
+    return (uint16_t)lrintf(v);
+}
+
+/* ---------- Wire format ---------- */
+
+static size_t put_varint(uint8_t* p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(const uint8_t** p, const uint8_t* end, uint32_t* v) {
+    *v = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7) {
+        if (*p >= end) return -1;
+        uint8_t b = *(*p)++;
+        *v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return 0;
+    }
+    return -1;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+size_t mesh_report_encode(const mesh_report_t* r, uint8_t* buf, size_t cap) {
+    size_t n = 3;
+    if (cap < n) return 0;
+    buf[0] = MESH_REPORT_VERSION << 4 | MESH_REPORT_KIND_FULL;
+    buf[1] = r->seq;
+    buf[2] = r->present;
+
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (!(r->present & (1u << s))) continue;
+        unsigned count = mesh_report_sensors[s].count;
+        if (cap - n < 2 * count) return 0;
+        for (unsigned i = 0; i < count; i++) {
+            buf[n++] = (uint8_t)r->raw[s][i];
+            buf[n++] = (uint8_t)(r->raw[s][i] >> 8);
+        }
+    }
+    return n;
+}
+
+/* Changed channels of r against the keyframe: header, then per sensor
+ * the channel mask and the zigzag differences. */
+static size_t encode_delta(const mesh_report_t* r, const mesh_report_t* key,
+                           uint8_t* buf, size_t cap) {
+    uint8_t sensors = 0;
+    size_t n = 4;
+
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (!r->carried[s]) continue;
+        const mesh_report_sensor_t* sensor = &mesh_report_sensors[s];
+        /* mask (2 bytes) and up to 3 bytes per channel */
+        if (cap - n < 2 + 3 * sensor->count) return 0;
+
+        sensors |= (uint8_t)(1u << s);
+        n += put_varint(buf + n, r->carried[s]);
+        for (unsigned i = 0; i < sensor->count; i++) {
+            if (!(r->carried[s] & (1u << i))) continue;
+            const sample_channel_t* c = &sensor->channels[i];
+            int32_t d = sample_channel_value(c, r->raw[s][i]) -
+                        sample_channel_value(c, key->raw[s][i]);
+            n += put_varint(buf + n, zigzag(d));
+        }
+    }
+    buf[0] = MESH_REPORT_VERSION << 4 | MESH_REPORT_KIND_DELTA;
+    buf[1] = r->seq;
+    buf[2] = key->seq;
+    buf[3] = sensors;
+    return n;
+}
+
+static int decode_full(const uint8_t* buf, size_t len, mesh_report_t* out) {
+    if (len < 3 || buf[2] >> MESH_REPORT_SENSORS) return -1;
+    out->present = buf[2];
+
+    size_t n = 3;
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (!(out->present & (1u << s))) continue;
+        unsigned count = mesh_report_sensors[s].count;
+        if (len - n < 2 * count) return -1;
+        for (unsigned i = 0; i < count; i++, n += 2)
+            out->raw[s][i] = (uint16_t)(buf[n] | buf[n + 1] << 8);
+        out->carried[s] = all_channels(s);
+    }
+    return n == len ? 0 : -1;
+}
+
+/* raw gets each difference modulo 2^16, which adds back onto the
+ * keyframe's raw value for signed and unsigned channels alike. */
+static int decode_delta(const uint8_t* buf, size_t len, mesh_report_t* out) {
+    if (len < 4 || buf[3] >> MESH_REPORT_SENSORS) return -1;
+    out->key_seq = buf[2];
+    out->present = buf[3];
+
+    const uint8_t* p = buf + 4;
+    const uint8_t* end = buf + len;
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (!(out->present & (1u << s))) continue;
+        uint32_t mask, v;
+        if (get_varint(&p, end, &mask) != 0 || mask > all_channels(s)) return -1;
+        out->carried[s] = (uint16_t)mask;
+        for (unsigned i = 0; i < mesh_report_sensors[s].count; i++) {
+            if (!(mask & (1u << i))) continue;
+            if (get_varint(&p, end, &v) != 0) return -1;
+            out->raw[s][i] = (uint16_t)unzigzag(v);
+        }
+    }
+    return p == end ? 0 : -1;
+}
+
+int mesh_report_decode(const uint8_t* buf, size_t len, mesh_report_t* out) {
+    mesh_report_clear(out);
+    if (len < 3 || buf[0] >> 4 != MESH_REPORT_VERSION) return -1;
+    out->kind = buf[0] & 0x0F;
+    out->seq = buf[1];
+
+    switch (out->kind) {
+    case MESH_REPORT_KIND_FULL: return decode_full(buf, len, out);
+    case MESH_REPORT_KIND_DELTA: return decode_delta(buf, len, out);
+    default: return -1;
+    }
+}
+
+/* ---------- Keyframes and deltas ---------- */
+
+void mesh_report_stream_init(mesh_report_stream_t* s, unsigned keyframe_every) {
+    memset(s, 0, sizeof(*s));
+    s->keyframe_every = keyframe_every ? keyframe_every : 1;
+}
+
+static int known(unsigned slot, unsigned i, uint16_t raw) {
+    return sample_channel_status(&mesh_report_sensors[slot].channels[i], raw) ==
+           SAMPLE_OK;
+}
+
+/* Mark in r->carried the channels that moved past their dead-band from
+ * what the receiver holds. Returns -1 if only a keyframe can carry the
+ * change: a sensor the keyframe lacks, or a value that became known or
+ * unknown. */
+static int changed_channels(const mesh_report_stream_t* st, mesh_report_t* r) {
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        r->carried[s] = 0;
+        if (!(r->present & (1u << s))) continue;
+        if (!(st->key.present & (1u << s))) return -1;
+
+        const mesh_report_sensor_t* sensor = &mesh_report_sensors[s];
+        for (unsigned i = 0; i < sensor->count; i++) {
+            uint16_t now = r->raw[s][i];
+            uint16_t held = st->current.raw[s][i];
+            if (known(s, i, now) != known(s, i, held)) return -1;
+            if (!known(s, i, now)) continue;
+
+            const sample_channel_t* c = &sensor->channels[i];
+            int32_t d = sample_channel_value(c, now) - sample_channel_value(c, held);
+            if (d > sensor->deadband[i] || -d > sensor->deadband[i])
+                r->carried[s] |= (uint16_t)(1u << i);
+        }
+    }
+    return 0;
+}
+
+static size_t full_size(const mesh_report_t* r) {
+    size_t n = 3;
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (r->present & (1u << s)) n += 2 * mesh_report_sensors[s].count;
+    }
+    return n;
+}
+
+size_t mesh_report_stream_encode(mesh_report_stream_t* s, mesh_report_t* r,
+                                 uint8_t* buf, size_t cap) {
+    uint8_t delta[4 + MESH_REPORT_SENSORS * 2 + 3 * 30];
+    size_t n = 0;
+
+    if (!r->present) return 0;
+    r->seq = s->next_seq;
+    if (s->have_key && ++s->since_key < s->keyframe_every &&
+        changed_channels(s, r) == 0) {
+        n = encode_delta(r, &s->key, delta, sizeof(delta));
+        if (n == 4) return 0;           /* nothing moved past its dead-band */
+    }
+
+    /* a delta no smaller than the full report goes out as a keyframe */
+    if (n > 0 && n < full_size(r) && n <= cap) {
+        for (unsigned k = 0; k < MESH_REPORT_SENSORS; k++) {
+            for (unsigned i = 0; i < MESH_REPORT_MAX_CHANNELS; i++) {
+                if (r->carried[k] & (1u << i)) s->current.raw[k][i] = r->raw[k][i];
+            }
+        }
+        r->kind = MESH_REPORT_KIND_DELTA;
+        r->key_seq = s->key.seq;
+        memcpy(buf, delta, n);
+        s->next_seq++;
+        return n;
+    }
+
+    for (unsigned k = 0; k < MESH_REPORT_SENSORS; k++)
+        r->carried[k] = r->present & (1u << k) ? all_channels(k) : 0;
+    if ((n = mesh_report_encode(r, buf, cap)) == 0) return 0;
+    r->kind = MESH_REPORT_KIND_FULL;
+    r->key_seq = r->seq;
+    s->key = *r;
+    s->current = *r;
+    s->have_key = 1;
+    s->since_key = 0;
+    s->next_seq++;
+    return n;
+}
+
+int mesh_report_stream_decode(mesh_report_stream_t* s, const uint8_t* buf,
+                              size_t len, mesh_report_t* out) {
+    mesh_report_t in;
+    if (mesh_report_decode(buf, len, &in) != 0) return -1;
+
+    if (in.kind == MESH_REPORT_KIND_FULL) {
+        in.key_seq = in.seq;
+        s->key = in;
+        s->current = in;
+        s->have_key = 1;
+        *out = in;
+        return 0;
+    }
+    if (!s->have_key || in.key_seq != s->key.seq) {
+        *out = in;
+        return 1;
+    }
+
+    for (unsigned k = 0; k < MESH_REPORT_SENSORS; k++) {
+        if (!(s->key.present & (1u << k))) continue;
+        for (unsigned i = 0; i < MESH_REPORT_MAX_CHANNELS; i++) {
+            if (in.carried[k] & (1u << i))
+                s->current.raw[k][i] = (uint16_t)(s->key.raw[k][i] + in.raw[k][i]);
+        }
+    }
+    *out = s->current;
+    out->kind = in.kind;
+    out->seq = in.seq;
+    out->key_seq = in.key_seq;
+    memcpy(out->carried, in.carried, sizeof(out->carried));
+    return 0;
+}
+
+/* ---------- Text ---------- */
+
+static void append(char* buf, size_t cap, size_t* pos, const char* s) {
+    size_t n = strlen(s);
+    if (*pos + n >= cap) n = cap - 1 - *pos;
+    memcpy(buf + *pos, s, n);
+    *pos += n;
+    buf[*pos] = '\0';
+}
+
+size_t mesh_report_format(const mesh_report_t* r, unsigned slot, char* buf,
+                          size_t cap) {
+    const mesh_report_sensor_t* sensor = &mesh_report_sensors[slot];
+    char value[16];
+    size_t pos = 0;
+    unsigned valid = 0;
+
+    if (cap == 0) return 0;
+    buf[0] = '\0';
+    append(buf, cap, &pos, sensor->name);
+    append(buf, cap, &pos, " ->");
+
+    for (unsigned i = 0; i < sensor->count; i++) {
+        const sample_channel_t* c = &sensor->channels[i];
+        uint16_t raw = r->raw[slot][i];
+        if (sample_channel_status(c, raw) != SAMPLE_OK) continue;
+
+        append(buf, cap, &pos, valid++ ? ", " : " ");
+        append(buf, cap, &pos, c->field);
+        append(buf, cap, &pos, ": ");
+        sample_channel_format(c, raw, value, sizeof(value));
+        append(buf, cap, &pos, value);
+        if (c->flags & SAMPLE_CHANNEL_CELSIUS) {
+            append(buf, cap, &pos, " C (");
+            sample_channel_format_fahrenheit(c, raw, value, sizeof(value));
+            append(buf, cap, &pos, value);
+            append(buf, cap, &pos, " F)");
+        }
+    }
+    return pos;
+}
+
+void mesh_report_print(const mesh_report_t* r, const char* from, size_t len,
+                       FILE* out) {
+    char line[256];
+
+    if (r->kind == MESH_REPORT_KIND_FULL) fprintf(out, "keyframe %u", r->seq);
+    else fprintf(out, "delta %u on keyframe %u", r->seq, r->key_seq);
+    if (from) fprintf(out, " from %s", from);
+    if (len) fprintf(out, ", %zu bytes", len);
+    fprintf(out, "\n");
+
+    for (unsigned s = 0; s < MESH_REPORT_SENSORS; s++) {
+        if (!r->carried[s]) continue;
+        mesh_report_format(r, s, line, sizeof(line));
+        fprintf(out, "  %s\n", line);
+    }
+}
@@ -0,0 +1,374 @@
+#include "mesh_serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WRITE_TIMEOUT_MS 1000
+#define WAKE_BYTES 32           /* START2 run that switches the node to API mode */
+#define WAKE_SETTLE_NSEC (100 * 1000000L)
+#define DEFAULT_HOP_LIMIT 3
+
+/* protobuf wire types */
+#define WT_VARINT 0
+#define WT_LEN 2
+#define WT_FIXED32 5
+
+/* ---------- Framing ---------- */
+
+void mesh_frame_reader_feed(mesh_frame_reader_t* r, const uint8_t* data,
+                            size_t n, mesh_serial_frame_fn fn, void* ctx) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t b = data[i];
+
+        if (r->len == 0) {
+            if (b == MESH_SERIAL_START1) r->buf[r->len++] = b;
+            else r->noise++;
+            continue;
+        }
+        if (r->len == 1 && b != MESH_SERIAL_START2) {
+            r->noise++;
+            r->len = 0;
+            if (b == MESH_SERIAL_START1) r->buf[r->len++] = b;
+            else r->noise++;
+            continue;
+        }
+
+        r->buf[r->len++] = b;
+        if (r->len < 4) continue;
+
+        size_t flen = (size_t)r->buf[2] << 8 | r->buf[3];
+        if (flen > MESH_SERIAL_MAX_FRAME) {
+            /* not a real header; drop it and look for the next one */
+            r->noise += 4;
+            r->len = 0;
+            continue;
+        }
+        if (r->len == 4 + flen) {
+            r->frames++;
+            if (fn) fn(ctx, r->buf + 4, flen);
+            r->len = 0;
+        }
+    }
+}
+
+/* ---------- protobuf encoding ---------- */
+
+static size_t put_varint(uint8_t* p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t put_key(uint8_t* p, uint32_t field, uint32_t wire_type) {
+    return put_varint(p, (uint64_t)field << 3 | wire_type);
+}
+
+static size_t put_fixed32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return 4;
+}
+
+static size_t put_bytes(uint8_t* p, uint32_t field, const uint8_t* data,
+                        size_t len) {
+    size_t n = put_key(p, field, WT_LEN);
+    n += put_varint(p + n, len);
+    memcpy(p + n, data, len);
+    return n + len;
+}
+
+/* Header in front of a ToRadio already written at frame + 4. */
+static size_t finish_frame(uint8_t* frame, size_t len) {
+    frame[0] = MESH_SERIAL_START1;
+    frame[1] = MESH_SERIAL_START2;
+    frame[2] = (uint8_t)(len >> 8);
+    frame[3] = (uint8_t)len;
+    return 4 + len;
+}
+
+/* ---------- Port ---------- */
+
+static int write_all(mesh_serial_t* m, const uint8_t* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(m->fd, buf, len);
+        if (n > 0) {
+            buf += n;
+            len -= (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            struct pollfd pfd = {.fd = m->fd, .events = POLLOUT};
+            if (poll(&pfd, 1, WRITE_TIMEOUT_MS) > 0 && !(pfd.revents & (POLLERR | POLLHUP)))
+                continue;
+        }
+        m->write_errors++;
+        mesh_serial_close(m);
+        return -1;
+    }
+    return 0;
+}
+
+static int send_frame(mesh_serial_t* m, uint8_t* frame, size_t len) {
+    if (mesh_serial_reopen(m) != 0) return -1;
+    if (write_all(m, frame, finish_frame(frame, len)) != 0) return -1;
+    m->frames_out++;
+    return 0;
+}
+
+static int want_config(mesh_serial_t* m) {
+    uint8_t frame[16];
+    size_t n = put_key(frame + 4, 3, WT_VARINT);
+    n += put_varint(frame + 4 + n, m->next_id++);
+    return write_all(m, frame, finish_frame(frame, n));
+}
+
+int mesh_serial_open(mesh_serial_t* m, const char* path) {
+    memset(m, 0, sizeof(*m));
+    m->fd = -1;
+    m->path = path;
+    m->hop_limit = DEFAULT_HOP_LIMIT;
+
+    /* packet ids only need to differ between runs */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    m->next_id = (uint32_t)(ts.tv_nsec ^ ts.tv_sec ^ getpid()) | 1;
+
+    return mesh_serial_reopen(m);
+}
+
+int mesh_serial_reopen(mesh_serial_t* m) {
+    if (m->fd >= 0) return 0;
+
+    int fd = open(m->path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    m->fd = fd;
+    m->rx.len = 0;
+
+    uint8_t wake[WAKE_BYTES];
+    memset(wake, MESH_SERIAL_START2, sizeof(wake));
+    if (write_all(m, wake, sizeof(wake)) != 0) return -1;
+    struct timespec settle = {0, WAKE_SETTLE_NSEC};
+    nanosleep(&settle, NULL);
+    return want_config(m);
+}
+
+void mesh_serial_close(mesh_serial_t* m) {
+    if (m->fd >= 0) close(m->fd);
+    m->fd = -1;
+}
+
+int mesh_serial_send_data(mesh_serial_t* m, uint32_t portnum,
+                          const uint8_t* payload, size_t len, uint32_t to,
+                          uint32_t channel) {
+    uint8_t data[MESH_SERIAL_PAYLOAD_MAX + 16];
+    uint8_t packet[sizeof(data) + 32];
+    uint8_t frame[4 + sizeof(packet) + 8];
+    if (len > MESH_SERIAL_PAYLOAD_MAX) len = MESH_SERIAL_PAYLOAD_MAX;
+
+    /* Data { portnum = 1; payload = 2 } */
+    size_t d = put_key(data, 1, WT_VARINT);
+    d += put_varint(data + d, portnum);
+    d += put_bytes(data + d, 2, payload, len);
+
+    /* MeshPacket { to = 2; channel = 3; decoded = 4; id = 6; hop_limit = 9 } */
+    size_t p = put_key(packet, 2, WT_FIXED32);
+    p += put_fixed32(packet + p, to);
+    if (channel) {
+        p += put_key(packet + p, 3, WT_VARINT);
+        p += put_varint(packet + p, channel);
+    }
+    p += put_bytes(packet + p, 4, data, d);
+    p += put_key(packet + p, 6, WT_FIXED32);
+    p += put_fixed32(packet + p, m->next_id++);
+    p += put_key(packet + p, 9, WT_VARINT);
+    p += put_varint(packet + p, m->hop_limit);
+
+    /* ToRadio { packet = 1 } */
+    size_t n = put_bytes(frame + 4, 1, packet, p);
+    return send_frame(m, frame, n);
+}
+
+int mesh_serial_send_text(mesh_serial_t* m, const char* text) {
+    return mesh_serial_send_data(m, MESH_PORT_TEXT_MESSAGE,
+                                 (const uint8_t*)text, strlen(text),
+                                 MESH_SERIAL_BROADCAST, 0);
+}
+
+int mesh_serial_poll(mesh_serial_t* m, mesh_serial_frame_fn fn, void* ctx) {
+    uint8_t buf[256];
+    while (m->fd >= 0) {
+        ssize_t n = read(m->fd, buf, sizeof(buf));
+        if (n > 0) {
+            mesh_frame_reader_feed(&m->rx, buf, (size_t)n, fn, ctx);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return 0;
+        if (n == 0) {
+            /* VMIN 0 reads 0 both when idle and after a hang-up */
+            struct pollfd pfd = {.fd = m->fd, .events = POLLIN};
+            if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & (POLLHUP | POLLERR)))
+                return 0;
+        }
+        mesh_serial_close(m);
+        return -1;
+    }
+    return -1;
+}
+
+/* ---------- protobuf decoding ---------- */
+
+static int get_varint(const uint8_t** p, const uint8_t* end, uint64_t* v) {
+    *v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return -1;
+        uint8_t b = *(*p)++;
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return 0;
+    }
+    return -1;
+}
+
+typedef struct {
+    uint32_t field;
+    uint32_t wire_type;
+    uint64_t value;          /* varint / fixed32 */
+    const uint8_t* data;     /* length-delimited */
+    size_t len;
+} pb_field_t;
+
+/* Next field of [*p, end). Returns 1, 0 at the end, -1 if malformed. */
+static int next_field(const uint8_t** p, const uint8_t* end, pb_field_t* f) {
+    uint64_t key;
+    if (*p == end) return 0;
+    if (get_varint(p, end, &key) != 0) return -1;
+    f->field = (uint32_t)(key >> 3);
+    f->wire_type = (uint32_t)(key & 7);
+
+    switch (f->wire_type) {
+    case WT_VARINT:
+        return get_varint(p, end, &f->value) == 0 ? 1 : -1;
+    case WT_FIXED32:
+        if (end - *p < 4) return -1;
+        f->value = (uint32_t)(*p)[0] | (uint32_t)(*p)[1] << 8 |
+                   (uint32_t)(*p)[2] << 16 | (uint32_t)(*p)[3] << 24;
+        *p += 4;
+        return 1;
+    case 1: /* fixed64 */
+        if (end - *p < 8) return -1;
+        *p += 8;
+        return 1;
+    case WT_LEN: {
+        uint64_t len;
+        if (get_varint(p, end, &len) != 0 || len > (uint64_t)(end - *p)) return -1;
+        f->data = *p;
+        f->len = (size_t)len;
+        *p += len;
+        return 1;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int decode_data(const uint8_t* p, const uint8_t* end,
+                       mesh_to_radio_t* out) {
+    pb_field_t f;
+    int r;
+    while ((r = next_field(&p, end, &f)) == 1) {
+        if (f.field == 1 && f.wire_type == WT_VARINT) out->portnum = (uint32_t)f.value;
+        if (f.field == 2 && f.wire_type == WT_LEN) {
+            out->payload = f.data;
+            out->payload_len = f.len;
+        }
+    }
+    return r;
+}
+
+static int decode_packet(const uint8_t* p, const uint8_t* end,
+                         mesh_to_radio_t* out) {
+    pb_field_t f;
+    int r;
+    while ((r = next_field(&p, end, &f)) == 1) {
+        switch (f.field) {
+        case 1: out->from = (uint32_t)f.value; break;
+        case 2: out->to = (uint32_t)f.value; break;
+        case 3: out->channel = (uint32_t)f.value; break;
+        case 4:
+            if (f.wire_type != WT_LEN || decode_data(f.data, f.data + f.len, out) != 0)
+                return -1;
+            break;
+        case 6: out->id = (uint32_t)f.value; break;
+        case 9: out->hop_limit = (uint32_t)f.value; break;
+        }
+    }
+    return r;
+}
+
+/* ToRadio and FromRadio differ only in where the packet is. */
+static int decode_radio(const uint8_t* msg, size_t len, uint32_t packet_field,
+                        mesh_to_radio_t* out) {
+    const uint8_t* p = msg;
+    const uint8_t* end = msg + len;
+    pb_field_t f;
+    int r;
+
+    memset(out, 0, sizeof(*out));
+    while ((r = next_field(&p, end, &f)) == 1) {
+        if (f.field == packet_field && f.wire_type == WT_LEN) {
+            out->is_packet = 1;
+            if (decode_packet(f.data, f.data + f.len, out) != 0) return -1;
+        } else if (packet_field == 1 && f.field == 3 &&
+                   f.wire_type == WT_VARINT) {
+            out->want_config_id = (uint32_t)f.value;
+        }
+    }
+    return r;
+}
+
+int mesh_decode_to_radio(const uint8_t* msg, size_t len, mesh_to_radio_t* out) {
+    /* ToRadio { packet = 1; want_config_id = 3 } */
+    return decode_radio(msg, len, 1, out);
+}
+
+int mesh_decode_from_radio(const uint8_t* msg, size_t len,
+                           mesh_to_radio_t* out) {
+    /* FromRadio { packet = 2 } */
+    return decode_radio(msg, len, 2, out);
+}
+
+size_t mesh_encode_config_complete(uint32_t id, uint8_t* buf) {
+    /* FromRadio { config_complete_id = 7 } */
+    size_t n = put_key(buf + 4, 7, WT_VARINT);
+    n += put_varint(buf + 4 + n, id);
+    return finish_frame(buf, n);
+}
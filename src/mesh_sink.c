@@ -0,0 +1,231 @@
+#include "mesh_sink.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* ---------- Message text ---------- */
+
+static void append(char* buf, size_t cap, size_t* pos, const char* s) {
+    size_t n = strlen(s);
+    if (*pos + n >= cap) n = cap - 1 - *pos;
+    memcpy(buf + *pos, s, n);
+    *pos += n;
+    buf[*pos] = '\0';
+}
+
+/* "SEN66 -> pm1: 5.4, ..., temperature: 22.57 C (72.63 F)" from the newest
+ * sample. Returns the length, 0 if no value was valid. */
+static size_t format_message(const sensor_ticks_t* t, char* buf, size_t cap) {
+    char value[16];
+    size_t pos = 0;
+    unsigned valid = 0;
+
+    for (size_t i = 0; t->name[i] && pos < cap - 1; i++)
+        buf[pos++] = (char)toupper((unsigned char)t->name[i]);
+    buf[pos] = '\0';
+    append(buf, cap, &pos, " ->");
+
+    for (unsigned i = 0; i < t->count; i++) {
+        if (sensor_ticks_status(t, i) != SAMPLE_OK) continue;
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        uint16_t raw = sensor_ticks_raw(t, i);
+
+        append(buf, cap, &pos, valid++ ? ", " : " ");
+        append(buf, cap, &pos, c->field);
+        append(buf, cap, &pos, ": ");
+        sample_channel_format(c, raw, value, sizeof(value));
+        append(buf, cap, &pos, value);
+        if (c->flags & SAMPLE_CHANNEL_CELSIUS) {
+            append(buf, cap, &pos, " C (");
+            sample_channel_format_fahrenheit(c, raw, value, sizeof(value));
+            append(buf, cap, &pos, value);
+            append(buf, cap, &pos, " F)");
+        }
+    }
+    return valid ? pos : 0;
+}
+
+/* ---------- Radio side (sender thread) ---------- */
+
+static void wake(mesh_sink_t* m) {
+    uint64_t one = 1;
+    if (write(m->wake_fd, &one, sizeof(one)) < 0) {
+        /* counter full: the thread is awake anyway */
+    }
+}
+
+static void* mesh_main(void* arg) {
+    mesh_sink_t* m = arg;
+
+    while (!atomic_load(&m->stop)) {
+        const mesh_sink_msg_t* msg;
+        while (!atomic_load(&m->stop) && (msg = spsc_ring_peek(&m->ring))) {
+            if (mesh_serial_send_data(&m->radio, msg->portnum, msg->data,
+                                      msg->len, MESH_SERIAL_BROADCAST, 0) == 0) {
+                if (msg->portnum == MESH_PORT_TEXT_MESSAGE)
+                    printf("%.*s\n", (int)msg->len, (const char*)msg->data);
+                else
+                    printf("Meshtastic: %s %u, %u bytes\n",
+                           (msg->data[0] & 0x0F) == MESH_REPORT_KIND_FULL ? "keyframe" : "delta",
+                           msg->data[1], msg->len);
+                atomic_fetch_add_explicit(&m->sent, 1, memory_order_relaxed);
+            } else {
+                fprintf(stderr, "Meshtastic send failed: %s\n", strerror(errno));
+                atomic_fetch_add_explicit(&m->failed, 1, memory_order_relaxed);
+            }
+            spsc_ring_release(&m->ring);
+        }
+
+        /* Sleep until the queue fills or the node says something. Its
+         * output is not used, only kept from piling up; a closed port
+         * is reopened by the next send. */
+        struct pollfd pfd[2] = {
+            {.fd = m->wake_fd, .events = POLLIN},
+            {.fd = m->radio.fd, .events = POLLIN},
+        };
+        if (poll(pfd, 2, -1) < 0) continue;
+        if (pfd[0].revents & POLLIN) {
+            uint64_t n;
+            if (read(m->wake_fd, &n, sizeof(n)) < 0) {
+                /* nothing to clear */
+            }
+        }
+        if (pfd[1].revents && mesh_serial_poll(&m->radio, NULL, NULL) != 0)
+            fprintf(stderr, "Meshtastic: %s hung up\n", m->cfg.port);
+    }
+    return NULL;
+}
+
+int mesh_sink_start(mesh_sink_t* m, const mesh_sink_config_t* cfg) {
+    memset(m, 0, sizeof(*m));
+    m->cfg = *cfg;
+    if (m->cfg.queue_msgs == 0) m->cfg.queue_msgs = 1;
+    mesh_report_stream_init(&m->stream, m->cfg.keyframe_every);
+
+    /* a node that is not plugged in yet is retried on every send */
+    if (mesh_serial_open(&m->radio, m->cfg.port) != 0)
+        fprintf(stderr, "Meshtastic: %s: %s\n", m->cfg.port, strerror(errno));
+    if (spsc_ring_init(&m->ring, m->cfg.queue_msgs, sizeof(mesh_sink_msg_t)) != 0) {
+        mesh_serial_close(&m->radio);
+        return -1;
+    }
+    m->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m->wake_fd < 0) {
+        spsc_ring_free(&m->ring);
+        mesh_serial_close(&m->radio);
+        return -1;
+    }
+    atomic_init(&m->stop, 0);
+    if (pthread_create(&m->thread, NULL, mesh_main, m) != 0) {
+        close(m->wake_fd);
+        spsc_ring_free(&m->ring);
+        mesh_serial_close(&m->radio);
+        return -1;
+    }
+    return 0;
+}
+
+/* ---------- Acquisition side ---------- */
+
+static void mesh_sample(sample_sink_t* s, const sensor_ticks_t* t,
+                        uint64_t ts_ms) {
+    (void)ts_ms;
+    mesh_sink_t* m = s->state;
+    for (unsigned i = 0; i < m->count; i++) {
+        if (m->sensors[i] == t) return;
+    }
+    if (m->count < SENSOR_SCHED_MAX) m->sensors[m->count++] = t;
+}
+
+static mesh_sink_msg_t* reserve(mesh_sink_t* m, uint16_t portnum) {
+    mesh_sink_msg_t* msg = spsc_ring_reserve(&m->ring);
+    if (!msg) {
+        atomic_fetch_add_explicit(&m->dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+    msg->portnum = portnum;
+    return msg;
+}
+
+/* The newest sample in the report's channel layout, invalid values as
+ * the sensor's "unknown" marker. Returns 0, or -1 for a model the report
+ * has no slot for. */
+static int add_to_report(mesh_report_t* r, const sensor_ticks_t* t) {
+    int slot = mesh_report_slot(t->model);
+    uint16_t raw[MESH_REPORT_MAX_CHANNELS];
+
+    if (slot < 0 || t->count != mesh_report_sensors[slot].count) return -1;
+    for (unsigned i = 0; i < t->count; i++) {
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        raw[i] = sensor_ticks_status(t, i) == SAMPLE_OK ? sensor_ticks_raw(t, i)
+                 : c->flags & SAMPLE_CHANNEL_SIGNED     ? 0x7FFF
+                                                        : 0xFFFF;
+    }
+    mesh_report_set(r, (unsigned)slot, raw);
+    return 0;
+}
+
+/* Once per period, every sensor with a sample newer than the one it last
+ * sent: one report, or one text message each. */
+static void mesh_tick(sample_sink_t* s, uint64_t now_usec) {
+    mesh_sink_t* m = s->state;
+    uint64_t period = (uint64_t)m->cfg.period_ms * 1000;
+    mesh_report_t report;
+    mesh_sink_msg_t* msg;
+
+    if (m->next_usec == 0) {
+        m->next_usec = now_usec + period;
+        return;
+    }
+    if (now_usec < m->next_usec) return;
+    m->next_usec += period;
+    if (m->next_usec <= now_usec) m->next_usec = now_usec + period;
+
+    mesh_report_clear(&report);
+    for (unsigned i = 0; i < m->count; i++) {
+        const sensor_ticks_t* t = m->sensors[i];
+        if (t->t_usec <= m->sent_usec[i]) continue;
+        m->sent_usec[i] = t->t_usec;
+
+        if (!m->cfg.text) {
+            add_to_report(&report, t);
+            continue;
+        }
+        if (!(msg = reserve(m, MESH_PORT_TEXT_MESSAGE))) continue;
+        msg->len = (uint16_t)format_message(t, (char*)msg->data, sizeof(msg->data));
+        if (msg->len) spsc_ring_commit(&m->ring);
+    }
+    if (report.present && (msg = reserve(m, MESH_PORT_PRIVATE))) {
+        msg->len = (uint16_t)mesh_report_stream_encode(&m->stream, &report,
+                                                       msg->data, sizeof(msg->data));
+        if (msg->len) spsc_ring_commit(&m->ring);
+    }
+    wake(m);
+}
+
+/* Messages still queued are not worth holding shutdown for. */
+static void mesh_stop(sample_sink_t* s) {
+    mesh_sink_t* m = s->state;
+    atomic_store(&m->stop, 1);
+    wake(m);
+    pthread_join(m->thread, NULL);
+
+    printf("Meshtastic: %llu sent, %llu failed, %llu dropped, %u unsent\n",
+           (unsigned long long)m->sent, (unsigned long long)m->failed,
+           (unsigned long long)m->dropped, spsc_ring_depth(&m->ring));
+    close(m->wake_fd);
+    spsc_ring_free(&m->ring);
+    mesh_serial_close(&m->radio);
+}
+
+const sample_sink_ops_t mesh_sink_ops = {
+    .name = "meshtastic",
+    .sample = mesh_sample,
+    .tick = mesh_tick,
+    .stop = mesh_stop,
+};
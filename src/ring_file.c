@@ -0,0 +1,198 @@
+#include "ring_file.h"
+#include "sensirion_i2c_hal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RING_FILE_MAGIC 0x474E4952u /* "RING" little-endian */
+#define RING_FILE_VERSION 1
+#define RING_FILE_HEADER 4096
+#define RING_FILE_NAME 24
+
+/* In host byte order: the file belongs to the machine that wrote it. */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t channels;
+    uint32_t capacity;
+    uint64_t state_bytes;
+    int64_t offset_ms;       /* wall - HAL time at the last tick */
+    uint64_t saved_ms;       /* wall time of the last tick */
+    char names[SAMPLE_STORE_MAX][2][RING_FILE_NAME];  /* sensor, field */
+    uint64_t head[SAMPLE_STORE_MAX];
+} ring_file_header_t;
+
+_Static_assert(sizeof(ring_file_header_t) <= RING_FILE_HEADER, "ring file header");
+
+static size_t align_up(size_t n) {
+    return (n + SAMPLE_RING_CACHELINE - 1) & ~(size_t)(SAMPLE_RING_CACHELINE - 1);
+}
+
+static ring_file_header_t* header(const ring_file_t* rf) {
+    return (ring_file_header_t*)rf->map;
+}
+
+/* The ring whose time column channel i shares, NULL if it has its own. */
+static const sample_ring_t* time_of(const sample_store_t* s, unsigned i) {
+    return s->channels[i].ring.shared_time ? &s->channels[i - 1].ring : NULL;
+}
+
+/* The header's layout for rf->store: what an existing file has to match. */
+static void layout(const ring_file_t* rf, ring_file_header_t* h) {
+    const sample_store_t* s = rf->store;
+    memset(h, 0, sizeof(*h));
+    h->magic = RING_FILE_MAGIC;
+    h->version = RING_FILE_VERSION;
+    h->channels = s ? s->count : 0;
+    h->capacity = h->channels ? sample_ring_capacity(&s->channels[0].ring) : 0;
+    h->state_bytes = rf->cfg.state_bytes;
+    for (unsigned i = 0; i < h->channels; i++) {
+        snprintf(h->names[i][0], RING_FILE_NAME, "%s", s->channels[i].sensor);
+        snprintf(h->names[i][1], RING_FILE_NAME, "%s", s->channels[i].field);
+    }
+}
+
+static int same_layout(const ring_file_header_t* a, const ring_file_header_t* b) {
+    return a->magic == b->magic && a->version == b->version &&
+           a->channels == b->channels && a->capacity == b->capacity &&
+           a->state_bytes == b->state_bytes &&
+           memcmp(a->names, b->names, sizeof(a->names)) == 0;
+}
+
+static void save(ring_file_t* rf, uint64_t now_usec) {
+    ring_file_header_t* h = header(rf);
+    sample_clock_sync(&rf->clock);
+    h->offset_ms = rf->clock.offset_usec / 1000;
+    h->saved_ms = sample_clock_wall_ms(&rf->clock, now_usec);
+    for (unsigned i = 0; i < h->channels; i++) h->head[i] = rf->store->channels[i].ring.head;
+}
+
+int ring_file_open(ring_file_t* rf, const ring_file_config_t* cfg,
+                   sample_store_t* store) {
+    memset(rf, 0, sizeof(*rf));
+    rf->cfg = *cfg;
+    rf->store = store;
+    rf->fd = -1;
+
+    ring_file_header_t want;
+    layout(rf, &want);
+    size_t rings_size = 0;
+    for (unsigned i = 0; i < want.channels; i++)
+        rings_size += sample_ring_bytes(want.capacity, !time_of(store, i));
+    rf->size = RING_FILE_HEADER + rings_size + align_up(cfg->state_bytes);
+
+    rf->fd = open(cfg->path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (rf->fd < 0) return -1;
+    struct stat st;
+    if (fstat(rf->fd, &st) != 0) goto fail;
+    int fresh = (size_t)st.st_size != rf->size;
+    if (fresh && (ftruncate(rf->fd, 0) != 0 || ftruncate(rf->fd, (off_t)rf->size) != 0))
+        goto fail;
+
+    void* map = mmap(NULL, rf->size, PROT_READ | PROT_WRITE, MAP_SHARED, rf->fd, 0);
+    if (map == MAP_FAILED) goto fail;
+    rf->map = map;
+    ring_file_header_t* h = header(rf);
+    if (!fresh && !same_layout(h, &want)) {
+        memset(rf->map, 0, rf->size);
+        fresh = 1;
+    }
+    if (fresh) memcpy(h, &want, sizeof(want));
+
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+    sample_clock_sync(&rf->clock);
+    uint8_t* rings = rf->map + RING_FILE_HEADER;
+    rf->state = rings + rings_size;
+
+    if (!fresh) {
+        uint64_t wall = sample_clock_wall_ms(&rf->clock, now);
+        rf->resumed = 1;
+        rf->age_ms = wall > h->saved_ms ? wall - h->saved_ms : 0;
+        rf->warm = cfg->max_age_ms == 0 || rf->age_ms <= cfg->max_age_ms;
+        if (!rf->warm) memset(rf->state, 0, cfg->state_bytes);
+
+    }
+
+    uint8_t* p = rings;
+    for (unsigned i = 0; i < want.channels; i++) {
+        sample_ring_t* r = &store->channels[i].ring;
+        const sample_ring_t* time = time_of(store, i);
+        sample_ring_free(r);
+        sample_ring_attach(r, p, want.capacity, h->head[i], time);
+        p += sample_ring_bytes(want.capacity, !time);
+    }
+
+    /* HAL time of the old run to HAL time of this one */
+    int64_t shift = fresh ? 0 : h->offset_ms - rf->clock.offset_usec / 1000;
+    for (unsigned i = 0; shift && i < want.channels; i++) {
+        sample_ring_t* r = &store->channels[i].ring;
+        if (r->shared_time) continue;
+        for (uint32_t j = 0; j < want.capacity; j++) r->t_ms[j] += (uint64_t)shift;
+    }
+    save(rf, now);
+    rf->last_sync_usec = now;
+    return 0;
+
+fail:;
+    int err = errno;
+    close(rf->fd);
+    rf->fd = -1;
+    errno = err;
+    return -1;
+}
+
+void ring_file_tick(ring_file_t* rf, uint64_t now_usec) {
+    if (!rf->map) return;
+    save(rf, now_usec);
+    if (now_usec - rf->last_sync_usec >= (uint64_t)rf->cfg.sync_ms * 1000) {
+        msync(rf->map, rf->size, MS_SYNC);
+        rf->last_sync_usec = now_usec;
+        rf->syncs++;
+    }
+}
+
+void ring_file_close(ring_file_t* rf) {
+    if (!rf->map) return;
+    save(rf, sensirion_i2c_hal_get_time_usec());
+    msync(rf->map, rf->size, MS_SYNC);
+    rf->syncs++;
+    for (unsigned i = 0; i < header(rf)->channels; i++)
+        sample_ring_free(&rf->store->channels[i].ring);
+    munmap(rf->map, rf->size);
+    close(rf->fd);
+    rf->map = NULL;
+    rf->state = NULL;
+    rf->fd = -1;
+}
+
+/* ---------- Sink ---------- */
+
+static void ring_file_sample(sample_sink_t* s, const sensor_ticks_t* t,
+                             uint64_t ts_ms) {
+    /* the sample is already in the mapped ring */
+    (void)s;
+    (void)t;
+    (void)ts_ms;
+}
+
+static void ring_file_sink_tick(sample_sink_t* s, uint64_t now_usec) {
+    ring_file_tick(s->state, now_usec);
+}
+
+static void ring_file_stop(sample_sink_t* s) {
+    ring_file_t* rf = s->state;
+    ring_file_close(rf);
+    printf("Ring file: %llu syncs\n", (unsigned long long)rf->syncs);
+}
+
+const sample_sink_ops_t ring_file_sink_ops = {
+    .name = "ring-file",
+    .sample = ring_file_sample,
+    .tick = ring_file_sink_tick,
+    .stop = ring_file_stop,
+};
@@ -0,0 +1,20 @@
+#include "sample_clock.h"
+#include "sensirion_i2c_hal.h"
+
+#include <time.h>
+
+void sample_clock_sync(sample_clock_t* c) {
+    struct timespec rt;
+    uint64_t mono = sensirion_i2c_hal_get_time_usec();
+    clock_gettime(CLOCK_REALTIME, &rt);
+    uint64_t wall = (uint64_t)rt.tv_sec * 1000000 + (uint64_t)rt.tv_nsec / 1000;
+    c->offset_usec = (int64_t)(wall - mono);
+}
+
+uint64_t sample_clock_wall_ms(const sample_clock_t* c, uint64_t mono_usec) {
+    return (uint64_t)((int64_t)mono_usec + c->offset_usec) / 1000;
+}
+
+uint64_t sample_clock_wall_ns(const sample_clock_t* c, uint64_t mono_usec) {
+    return (uint64_t)((int64_t)mono_usec + c->offset_usec) * 1000;
+}
@@ -0,0 +1,158 @@
+#include "sample_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t column_bytes(uint32_t cap, size_t size) {
+    size_t bytes = (size_t)cap * size;
+    return (bytes + SAMPLE_RING_CACHELINE - 1) & ~(size_t)(SAMPLE_RING_CACHELINE - 1);
+}
+
+/* Column of cap elements on its own cache lines. */
+static void* column(uint32_t cap, size_t size) {
+    size_t bytes = column_bytes(cap, size);
+    void* p = aligned_alloc(SAMPLE_RING_CACHELINE, bytes);
+    if (p) memset(p, 0, bytes);
+    return p;
+}
+
+int sample_ring_init(sample_ring_t* r, uint32_t capacity,
+                     const sample_ring_t* time) {
+    uint32_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    memset(r, 0, sizeof(*r));
+    r->shared_time = time != NULL;
+    r->t_ms = time ? time->t_ms : column(cap, sizeof(*r->t_ms));
+    r->raw = column(cap, sizeof(*r->raw));
+    r->status = column(cap, sizeof(*r->status));
+    if (!r->t_ms || !r->raw || !r->status) {
+        sample_ring_free(r);
+        return -1;
+    }
+    r->mask = cap - 1;
+    return 0;
+}
+
+void sample_ring_free(sample_ring_t* r) {
+    if (!r->attached) {
+        if (!r->shared_time) free(r->t_ms);
+        free(r->raw);
+        free(r->status);
+    }
+    r->t_ms = NULL;
+    r->raw = NULL;
+    r->status = NULL;
+}
+
+size_t sample_ring_bytes(uint32_t capacity, int own_time) {
+    return (own_time ? column_bytes(capacity, sizeof(uint64_t)) : 0) +
+           column_bytes(capacity, sizeof(uint16_t)) +
+           column_bytes(capacity, sizeof(uint8_t));
+}
+
+void sample_ring_attach(sample_ring_t* r, void* mem, uint32_t capacity,
+                        uint64_t head, const sample_ring_t* time) {
+    uint8_t* p = mem;
+    r->shared_time = time != NULL;
+    if (time) {
+        r->t_ms = time->t_ms;
+    } else {
+        r->t_ms = (uint64_t*)p;
+        p += column_bytes(capacity, sizeof(uint64_t));
+    }
+    r->raw = (uint16_t*)p;
+    p += column_bytes(capacity, sizeof(uint16_t));
+    r->status = p;
+    r->mask = capacity - 1;
+    r->head = head;
+    r->attached = 1;
+}
+
+static sample_span_t span(const sample_ring_t* r, uint32_t i, uint32_t len) {
+    sample_span_t s = {&r->t_ms[i], &r->raw[i], &r->status[i], len};
+    return s;
+}
+
+unsigned sample_ring_window(const sample_ring_t* r, uint64_t* from,
+                            uint32_t max, sample_span_t out[2]) {
+    uint64_t oldest = sample_ring_oldest(r);
+    if (*from < oldest) *from = oldest;
+    if (*from >= r->head || max == 0) return 0;
+
+    uint64_t avail = r->head - *from;
+    uint32_t n = avail < max ? (uint32_t)avail : max;
+    uint32_t i = (uint32_t)*from & r->mask;
+    uint32_t first = r->mask + 1 - i;
+
+    if (n <= first) {
+        out[0] = span(r, i, n);
+        return 1;
+    }
+    out[0] = span(r, i, first);
+    out[1] = span(r, 0, n - first);
+    return 2;
+}
+
+unsigned sample_ring_last(const sample_ring_t* r, uint32_t n,
+                          sample_span_t out[2]) {
+    uint64_t from = r->head > n ? r->head - n : 0;
+    return sample_ring_window(r, &from, n, out);
+}
+
+/* ---------- Channel store ---------- */
+
+void sample_store_init(sample_store_t* s, uint32_t capacity) {
+    memset(s, 0, sizeof(*s));
+    s->capacity = capacity;
+}
+
+void sample_store_free(sample_store_t* s) {
+    for (unsigned i = 0; i < s->count; i++) sample_ring_free(&s->channels[i].ring);
+    s->count = 0;
+}
+
+int sample_store_add(sample_store_t* s, const char* sensor, const char* field,
+                     uint16_t scale, uint8_t decimals, uint8_t flags) {
+    if (s->count == SAMPLE_STORE_MAX) return -1;
+
+    sample_channel_t* c = &s->channels[s->count];
+    const sample_channel_t* prev = s->count ? &s->channels[s->count - 1] : NULL;
+    const sample_ring_t* time =
+        prev && strcmp(prev->sensor, sensor) == 0 ? &prev->ring : NULL;
+    if (sample_ring_init(&c->ring, s->capacity, time) != 0) return -1;
+    c->sensor = sensor;
+    c->field = field;
+    c->scale = scale ? scale : 1;
+    c->decimals = decimals > 4 ? 4 : decimals;
+    c->flags = flags;
+    return (int)s->count++;
+}
+
+int sample_format_fixed(int32_t value, uint16_t scale, uint8_t decimals,
+                        char* buf, size_t len) {
+    static const uint32_t pow10[] = {1, 10, 100, 1000, 10000};
+    unsigned d = decimals > 4 ? 4 : decimals;
+    uint64_t mag = value < 0 ? (uint64_t)(-(int64_t)value) : (uint64_t)value;
+    uint64_t q = (mag * pow10[d] * 2 + scale) / (2 * (uint64_t)scale);
+    int neg = value < 0 && q != 0;
+
+    /* digits right to left */
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    for (unsigned i = 0; i < d; i++, q /= 10) *--p = (char)('0' + q % 10);
+    if (d) *--p = '.';
+    do {
+        *--p = (char)('0' + q % 10);
+        q /= 10;
+    } while (q);
+    if (neg) *--p = '-';
+
+    size_t n = (size_t)(tmp + sizeof(tmp) - p);
+    if (len) {
+        size_t k = n < len ? n : len - 1;
+        memcpy(buf, p, k);
+        buf[k] = '\0';
+    }
+    return (int)n;
+}
@@ -0,0 +1,93 @@
+#include "sample_sink.h"
+#include "sensirion_i2c_hal.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void sample_sink_set_init(sample_sink_set_t* set) {
+    memset(set, 0, sizeof(*set));
+    sample_clock_sync(&set->clock);
+}
+
+int sample_sink_set_add(sample_sink_set_t* set, const sample_sink_ops_t* ops,
+                        void* state) {
+    if (set->count == SAMPLE_SINK_MAX) return -1;
+    set->sinks[set->count].ops = ops;
+    set->sinks[set->count].state = state;
+    set->count++;
+    return 0;
+}
+
+void sample_sink_set_publish(const sensor_ticks_t* t, void* user) {
+    sample_sink_set_t* set = user;
+    uint64_t ts = sample_clock_wall_ms(&set->clock, t->t_usec);
+    for (unsigned i = 0; i < set->count; i++)
+        set->sinks[i].ops->sample(&set->sinks[i], t, ts);
+}
+
+void sample_sink_set_tick(sample_sink_set_t* set) {
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+    for (unsigned i = 0; i < set->count; i++) {
+        if (set->sinks[i].ops->tick) set->sinks[i].ops->tick(&set->sinks[i], now);
+    }
+    sample_clock_sync(&set->clock);
+}
+
+void sample_sink_set_stop(sample_sink_set_t* set) {
+    for (unsigned i = 0; i < set->count; i++) {
+        if (set->sinks[i].ops->stop) set->sinks[i].ops->stop(&set->sinks[i]);
+    }
+    set->count = 0;
+}
+
+/* ---------- stdout ---------- */
+
+/* One "--- time ---" header per second in which samples arrived. */
+static void print_header(void) {
+    static time_t last;
+    time_t now = time(NULL);
+    if (now == last) return;
+    last = now;
+
+    char timestamp[32];
+    struct tm tm_info;
+    if (localtime_r(&now, &tm_info) == NULL) {
+        snprintf(timestamp, sizeof(timestamp), "1970-01-01 00:00:00");
+    } else {
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+    }
+    printf("\n--- %s ---\n", timestamp);
+}
+
+static void stdout_sample(sample_sink_t* s, const sensor_ticks_t* t,
+                          uint64_t ts_ms) {
+    (void)s;
+    (void)ts_ms;
+    char value[16];
+
+    print_header();
+    for (const char* p = t->name; *p; p++) putchar(toupper((unsigned char)*p));
+    printf(" ->");
+    for (unsigned i = 0; i < t->count; i++) {
+        const sample_channel_t* c = sensor_ticks_channel(t, i);
+        uint16_t raw = sensor_ticks_raw(t, i);
+        if (sensor_ticks_status(t, i) != SAMPLE_OK) {
+            printf("%s %s: unknown", i ? "," : "", c->field);
+            continue;
+        }
+        sample_channel_format(c, raw, value, sizeof(value));
+        printf("%s %s: %s", i ? "," : "", c->field, value);
+        if (c->flags & SAMPLE_CHANNEL_CELSIUS) {
+            sample_channel_format_fahrenheit(c, raw, value, sizeof(value));
+            printf(" (%s °F)", value);
+        }
+    }
+    printf("\n");
+}
+
+const sample_sink_ops_t sample_sink_stdout_ops = {
+    .name = "stdout",
+    .sample = stdout_sample,
+};
@@ -43,12 +43,16 @@
 
 #define sensirion_hal_sleep_us sensirion_i2c_hal_sleep_usec
 
-static uint8_t communication_buffer[18] = {0};
-
-static uint8_t _i2c_address;
+/* Device behind the legacy API: default bus, address from scd30_init(). */
+static scd30_dev_t _dev = {SENSIRION_I2C_HAL_DEFAULT_FD, 0, {0}};
 
 void scd30_init(uint8_t i2c_address) {
-    _i2c_address = i2c_address;
+    _dev.address = i2c_address;
+}
+
+void scd30_dev_init(scd30_dev_t* dev, int fd, uint8_t i2c_address) {
+    dev->fd = fd;
+    dev->address = i2c_address;
 }
 
 int16_t scd30_await_data_ready() {
@@ -81,16 +85,66 @@ int16_t scd30_blocking_read_measurement_data(float* co2_concentration,
     return local_error;
 }
 
-int16_t scd30_start_periodic_measurement(uint16_t ambient_pressure) {
+int16_t scd30_dev_try_read_measurement_data(scd30_dev_t* dev,
+                                            float* co2_concentration,
+                                            float* temperature,
+                                            float* humidity) {
+    return scd30_dev_poll_measurement_data(dev, co2_concentration, temperature,
+                                           humidity, 0);
+}
+
+int16_t scd30_try_read_measurement_data(float* co2_concentration,
+                                        float* temperature, float* humidity) {
+    return scd30_dev_try_read_measurement_data(&_dev, co2_concentration,
+                                               temperature, humidity);
+}
+
+int16_t scd30_dev_poll_measurement_data(scd30_dev_t* dev,
+                                        float* co2_concentration,
+                                        float* temperature, float* humidity,
+                                        uint32_t timeout_ms) {
+    uint16_t data_ready = 0;
+    int16_t local_error = NO_ERROR;
+    uint64_t deadline =
+        sensirion_i2c_hal_get_time_usec() + (uint64_t)timeout_ms * 1000;
+
+    for (;;) {
+        local_error = scd30_dev_get_data_ready(dev, &data_ready);
+        if (local_error != NO_ERROR) {
+            return local_error;
+        }
+        if (data_ready) {
+            break;
+        }
+        uint64_t now = sensirion_i2c_hal_get_time_usec();
+        if (now >= deadline) {
+            return DATA_NOT_READY_ERROR;
+        }
+        uint64_t left = deadline - now;
+        sensirion_hal_sleep_us(left < 100000 ? (uint32_t)left : 100000);
+    }
+    return scd30_dev_read_measurement_data(dev, co2_concentration, temperature,
+                                           humidity);
+}
+
+int16_t scd30_poll_measurement_data(float* co2_concentration,
+                                    float* temperature, float* humidity,
+                                    uint32_t timeout_ms) {
+    return scd30_dev_poll_measurement_data(&_dev, co2_concentration,
+                                           temperature, humidity, timeout_ms);
+}
+
+int16_t scd30_dev_start_periodic_measurement(scd30_dev_t* dev,
+                                             uint16_t ambient_pressure) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x10);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, ambient_pressure);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -98,14 +152,18 @@ int16_t scd30_start_periodic_measurement(uint16_t ambient_pressure) {
     return local_error;
 }
 
-int16_t scd30_stop_periodic_measurement() {
+int16_t scd30_start_periodic_measurement(uint16_t ambient_pressure) {
+    return scd30_dev_start_periodic_measurement(&_dev, ambient_pressure);
+}
+
+int16_t scd30_dev_stop_periodic_measurement(scd30_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x104);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -113,16 +171,20 @@ int16_t scd30_stop_periodic_measurement() {
     return local_error;
 }
 
+int16_t scd30_stop_periodic_measurement() {
+    return scd30_dev_stop_periodic_measurement(&_dev);
+}
+
 int16_t scd30_set_measurement_interval(uint16_t interval) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x4600);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr,
                                                         local_offset, interval);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -132,17 +194,17 @@ int16_t scd30_set_measurement_interval(uint16_t interval) {
 
 int16_t scd30_get_measurement_interval(uint16_t* interval) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x4600);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -150,19 +212,20 @@ int16_t scd30_get_measurement_interval(uint16_t* interval) {
     return local_error;
 }
 
-int16_t scd30_get_data_ready(uint16_t* data_ready_flag) {
+int16_t scd30_dev_get_data_ready(scd30_dev_t* dev, uint16_t* data_ready_flag) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x202);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                                     buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -170,20 +233,26 @@ int16_t scd30_get_data_ready(uint16_t* data_ready_flag) {
     return local_error;
 }
 
-int16_t scd30_read_measurement_data(float* co2_concentration,
-                                    float* temperature, float* humidity) {
+int16_t scd30_get_data_ready(uint16_t* data_ready_flag) {
+    return scd30_dev_get_data_ready(&_dev, data_ready_flag);
+}
+
+int16_t scd30_dev_read_measurement_data(scd30_dev_t* dev,
+                                        float* co2_concentration,
+                                        float* temperature, float* humidity) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x300);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 12);
+    local_error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                                     buffer_ptr, 12);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -193,16 +262,22 @@ int16_t scd30_read_measurement_data(float* co2_concentration,
     return local_error;
 }
 
+int16_t scd30_read_measurement_data(float* co2_concentration,
+                                    float* temperature, float* humidity) {
+    return scd30_dev_read_measurement_data(&_dev, co2_concentration,
+                                           temperature, humidity);
+}
+
 int16_t scd30_activate_auto_calibration(uint16_t do_activate) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5306);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, do_activate);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -212,17 +287,17 @@ int16_t scd30_activate_auto_calibration(uint16_t do_activate) {
 
 int16_t scd30_get_auto_calibration_status(uint16_t* is_active) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5306);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -232,14 +307,14 @@ int16_t scd30_get_auto_calibration_status(uint16_t* is_active) {
 
 int16_t scd30_force_recalibration(uint16_t co2_ref_concentration) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5204);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, co2_ref_concentration);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -249,17 +324,17 @@ int16_t scd30_force_recalibration(uint16_t co2_ref_concentration) {
 
 int16_t scd30_get_force_recalibration_status(uint16_t* co2_ref_concentration) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5204);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -269,14 +344,14 @@ int16_t scd30_get_force_recalibration_status(uint16_t* co2_ref_concentration) {
 
 int16_t scd30_set_temperature_offset(uint16_t temperature_offset) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5403);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, temperature_offset);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -286,17 +361,17 @@ int16_t scd30_set_temperature_offset(uint16_t temperature_offset) {
 
 int16_t scd30_get_temperature_offset(uint16_t* temperature_offset) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5403);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -306,17 +381,17 @@ int16_t scd30_get_temperature_offset(uint16_t* temperature_offset) {
 
 int16_t scd30_get_altitude_compensation(uint16_t* altitude) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5102);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -326,14 +401,14 @@ int16_t scd30_get_altitude_compensation(uint16_t* altitude) {
 
 int16_t scd30_set_altitude_compensation(uint16_t altitude) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5102);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr,
                                                         local_offset, altitude);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -343,17 +418,17 @@ int16_t scd30_set_altitude_compensation(uint16_t altitude) {
 
 int16_t scd30_read_firmware_version(uint8_t* major, uint8_t* minor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd100);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(10 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -362,17 +437,33 @@ int16_t scd30_read_firmware_version(uint8_t* major, uint8_t* minor) {
     return local_error;
 }
 
-int16_t scd30_soft_reset() {
+int16_t scd30_dev_soft_reset_nowait(scd30_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd304);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
-    sensirion_i2c_hal_sleep_usec(2000 * 1000);
     return local_error;
 }
+
+int16_t scd30_dev_soft_reset(scd30_dev_t* dev) {
+    int16_t local_error = scd30_dev_soft_reset_nowait(dev);
+    if (local_error != NO_ERROR) {
+        return local_error;
+    }
+    sensirion_i2c_hal_sleep_usec(SCD30_SOFT_RESET_USEC);
+    return local_error;
+}
+
+int16_t scd30_soft_reset() {
+    return scd30_dev_soft_reset(&_dev);
+}
+
+int16_t scd30_soft_reset_nowait() {
+    return scd30_dev_soft_reset_nowait(&_dev);
+}
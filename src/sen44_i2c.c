@@ -43,13 +43,22 @@
 
 #define SEN44_I2C_ADDRESS 0x69
 
-int16_t sen44_start_measurement(void) {
+/* Device behind the legacy API: default bus, fixed address. */
+static sen44_dev_t _dev = {SENSIRION_I2C_HAL_DEFAULT_FD, SEN44_I2C_ADDRESS};
+
+void sen44_dev_init(sen44_dev_t* dev, int fd, uint8_t i2c_address) {
+    dev->fd = fd;
+    dev->address = i2c_address;
+}
+
+int16_t sen44_dev_start_measurement(sen44_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x21);
 
-    error = sensirion_i2c_write_data(SEN44_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
@@ -57,13 +66,18 @@ int16_t sen44_start_measurement(void) {
     return NO_ERROR;
 }
 
-int16_t sen44_stop_measurement(void) {
+int16_t sen44_start_measurement(void) {
+    return sen44_dev_start_measurement(&_dev);
+}
+
+int16_t sen44_dev_stop_measurement(sen44_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x104);
 
-    error = sensirion_i2c_write_data(SEN44_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
@@ -71,20 +85,26 @@ int16_t sen44_stop_measurement(void) {
     return NO_ERROR;
 }
 
-int16_t sen44_read_data_ready(bool* data_ready) {
+int16_t sen44_stop_measurement(void) {
+    return sen44_dev_stop_measurement(&_dev);
+}
+
+int16_t sen44_dev_read_data_ready(sen44_dev_t* dev, bool* data_ready) {
     int16_t error;
     uint8_t buffer[3];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x202);
 
-    error = sensirion_i2c_write_data(SEN44_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
 
     sensirion_i2c_hal_sleep_usec(5000);
 
-    error = sensirion_i2c_read_data_inplace(SEN44_I2C_ADDRESS, &buffer[0], 2);
+    error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                               &buffer[0], 2);
     if (error) {
         return error;
     }
@@ -92,6 +112,10 @@ int16_t sen44_read_data_ready(bool* data_ready) {
     return NO_ERROR;
 }
 
+int16_t sen44_read_data_ready(bool* data_ready) {
+    return sen44_dev_read_data_ready(&_dev, data_ready);
+}
+
 int16_t sen44_read_measured_pm_values(
     uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
     uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
@@ -132,24 +156,26 @@ int16_t sen44_read_measured_pm_values(
     return NO_ERROR;
 }
 
-int16_t sen44_read_measured_mass_concentration_and_ambient_values_ticks(
-    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
-    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
-    int16_t* voc_index, int16_t* ambient_humidity,
-    int16_t* ambient_temperature) {
+int16_t sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+    sen44_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* voc_index,
+    int16_t* ambient_humidity, int16_t* ambient_temperature) {
     int16_t error;
     uint8_t buffer[21];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x374);
 
-    error = sensirion_i2c_write_data(SEN44_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
 
     sensirion_i2c_hal_sleep_usec(10000);
 
-    error = sensirion_i2c_read_data_inplace(SEN44_I2C_ADDRESS, &buffer[0], 14);
+    error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                               &buffer[0], 14);
     if (error) {
         return error;
     }
@@ -163,17 +189,29 @@ int16_t sen44_read_measured_mass_concentration_and_ambient_values_ticks(
     return NO_ERROR;
 }
 
-int16_t sen44_read_measured_mass_concentration_and_ambient_values(
+int16_t sen44_read_measured_mass_concentration_and_ambient_values_ticks(
     uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
     uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
-    float* voc_index, float* ambient_humidity, float* ambient_temperature) {
+    int16_t* voc_index, int16_t* ambient_humidity,
+    int16_t* ambient_temperature) {
+    return sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+        &_dev, mass_concentration_pm1p0, mass_concentration_pm2p5,
+        mass_concentration_pm4p0, mass_concentration_pm10p0, voc_index,
+        ambient_humidity, ambient_temperature);
+}
+
+int16_t sen44_dev_read_measured_mass_concentration_and_ambient_values(
+    sen44_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, float* voc_index,
+    float* ambient_humidity, float* ambient_temperature) {
     int16_t error = 0;
     int16_t voc_index_ticks;
     int16_t ambient_humidity_ticks;
     int16_t ambient_temperature_ticks;
 
-    error = sen44_read_measured_mass_concentration_and_ambient_values_ticks(
-        mass_concentration_pm1p0, mass_concentration_pm2p5,
+    error = sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+        dev, mass_concentration_pm1p0, mass_concentration_pm2p5,
         mass_concentration_pm4p0, mass_concentration_pm10p0, &voc_index_ticks,
         &ambient_humidity_ticks, &ambient_temperature_ticks);
     if (error) {
@@ -186,6 +224,16 @@ int16_t sen44_read_measured_mass_concentration_and_ambient_values(
     return NO_ERROR;
 }
 
+int16_t sen44_read_measured_mass_concentration_and_ambient_values(
+    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
+    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
+    float* voc_index, float* ambient_humidity, float* ambient_temperature) {
+    return sen44_dev_read_measured_mass_concentration_and_ambient_values(
+        &_dev, mass_concentration_pm1p0, mass_concentration_pm2p5,
+        mass_concentration_pm4p0, mass_concentration_pm10p0, voc_index,
+        ambient_humidity, ambient_temperature);
+}
+
 int16_t sen44_read_measured_ambient_values_ticks(int16_t* voc_index,
                                                  int16_t* ambient_humidity,
                                                  int16_t* ambient_temperature) {
@@ -388,16 +436,33 @@ int16_t sen44_clear_device_status(void) {
     return NO_ERROR;
 }
 
-int16_t sen44_device_reset(void) {
+int16_t sen44_dev_device_reset_nowait(sen44_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0xD304);
 
-    error = sensirion_i2c_write_data(SEN44_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
-    sensirion_i2c_hal_sleep_usec(100000);
     return NO_ERROR;
 }
+
+int16_t sen44_dev_device_reset(sen44_dev_t* dev) {
+    int16_t error = sen44_dev_device_reset_nowait(dev);
+    if (error) {
+        return error;
+    }
+    sensirion_i2c_hal_sleep_usec(SEN44_DEVICE_RESET_USEC);
+    return NO_ERROR;
+}
+
+int16_t sen44_device_reset(void) {
+    return sen44_dev_device_reset(&_dev);
+}
+
+int16_t sen44_device_reset_nowait(void) {
+    return sen44_dev_device_reset_nowait(&_dev);
+}
@@ -44,16 +44,25 @@
 
 #define SEN5X_I2C_ADDRESS 0x69
 
+/* Device behind the legacy API: default bus, fixed address. */
+static sen5x_dev_t _dev = {SENSIRION_I2C_HAL_DEFAULT_FD, SEN5X_I2C_ADDRESS};
+
+void sen5x_dev_init(sen5x_dev_t* dev, int fd, uint8_t i2c_address) {
+    dev->fd = fd;
+    dev->address = i2c_address;
+}
+
 #define UINT_INVALID 0xFFFF
 #define INT_INVALID 0x7FFF
 
-int16_t sen5x_start_measurement(void) {
+int16_t sen5x_dev_start_measurement(sen5x_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x21);
 
-    error = sensirion_i2c_write_data(SEN5X_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
@@ -61,6 +70,10 @@ int16_t sen5x_start_measurement(void) {
     return NO_ERROR;
 }
 
+int16_t sen5x_start_measurement(void) {
+    return sen5x_dev_start_measurement(&_dev);
+}
+
 int16_t sen5x_start_measurement_without_pm(void) {
     int16_t error;
     uint8_t buffer[2];
@@ -75,13 +88,14 @@ int16_t sen5x_start_measurement_without_pm(void) {
     return NO_ERROR;
 }
 
-int16_t sen5x_stop_measurement(void) {
+int16_t sen5x_dev_stop_measurement(sen5x_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x104);
 
-    error = sensirion_i2c_write_data(SEN5X_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
@@ -89,20 +103,26 @@ int16_t sen5x_stop_measurement(void) {
     return NO_ERROR;
 }
 
-int16_t sen5x_read_data_ready(bool* data_ready) {
+int16_t sen5x_stop_measurement(void) {
+    return sen5x_dev_stop_measurement(&_dev);
+}
+
+int16_t sen5x_dev_read_data_ready(sen5x_dev_t* dev, bool* data_ready) {
     int16_t error;
     uint8_t buffer[3];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x202);
 
-    error = sensirion_i2c_write_data(SEN5X_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
 
     sensirion_i2c_hal_sleep_usec(20000);
 
-    error = sensirion_i2c_read_data_inplace(SEN5X_I2C_ADDRESS, &buffer[0], 2);
+    error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                               &buffer[0], 2);
     if (error) {
         return error;
     }
@@ -110,13 +130,18 @@ int16_t sen5x_read_data_ready(bool* data_ready) {
     return NO_ERROR;
 }
 
-int16_t sen5x_read_measured_values(float* mass_concentration_pm1p0,
-                                   float* mass_concentration_pm2p5,
-                                   float* mass_concentration_pm4p0,
-                                   float* mass_concentration_pm10p0,
-                                   float* ambient_humidity,
-                                   float* ambient_temperature, float* voc_index,
-                                   float* nox_index) {
+int16_t sen5x_read_data_ready(bool* data_ready) {
+    return sen5x_dev_read_data_ready(&_dev, data_ready);
+}
+
+int16_t sen5x_dev_read_measured_values(sen5x_dev_t* dev,
+                                       float* mass_concentration_pm1p0,
+                                       float* mass_concentration_pm2p5,
+                                       float* mass_concentration_pm4p0,
+                                       float* mass_concentration_pm10p0,
+                                       float* ambient_humidity,
+                                       float* ambient_temperature,
+                                       float* voc_index, float* nox_index) {
     int16_t error;
 
     uint16_t mass_concentration_pm1p0_int;
@@ -128,8 +153,8 @@ int16_t sen5x_read_measured_values(float* mass_concentration_pm1p0,
     int16_t voc_index_int;
     int16_t nox_index_int;
 
-    error = sen5x_read_measured_values_as_integers(
-        &mass_concentration_pm1p0_int, &mass_concentration_pm2p5_int,
+    error = sen5x_dev_read_measured_values_as_integers(
+        dev, &mass_concentration_pm1p0_int, &mass_concentration_pm2p5_int,
         &mass_concentration_pm4p0_int, &mass_concentration_pm10p0_int,
         &ambient_humidity_int, &ambient_temperature_int, &voc_index_int,
         &nox_index_int);
@@ -162,24 +187,41 @@ int16_t sen5x_read_measured_values(float* mass_concentration_pm1p0,
     return NO_ERROR;
 }
 
-int16_t sen5x_read_measured_values_as_integers(
-    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
-    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
-    int16_t* ambient_humidity, int16_t* ambient_temperature, int16_t* voc_index,
-    int16_t* nox_index) {
+int16_t sen5x_read_measured_values(float* mass_concentration_pm1p0,
+                                   float* mass_concentration_pm2p5,
+                                   float* mass_concentration_pm4p0,
+                                   float* mass_concentration_pm10p0,
+                                   float* ambient_humidity,
+                                   float* ambient_temperature, float* voc_index,
+                                   float* nox_index) {
+    return sen5x_dev_read_measured_values(&_dev, mass_concentration_pm1p0,
+                                          mass_concentration_pm2p5,
+                                          mass_concentration_pm4p0,
+                                          mass_concentration_pm10p0,
+                                          ambient_humidity, ambient_temperature,
+                                          voc_index, nox_index);
+}
+
+int16_t sen5x_dev_read_measured_values_as_integers(
+    sen5x_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* ambient_humidity,
+    int16_t* ambient_temperature, int16_t* voc_index, int16_t* nox_index) {
     int16_t error;
     uint8_t buffer[24];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0x3C4);
 
-    error = sensirion_i2c_write_data(SEN5X_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
 
     sensirion_i2c_hal_sleep_usec(20000);
 
-    error = sensirion_i2c_read_data_inplace(SEN5X_I2C_ADDRESS, &buffer[0], 16);
+    error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                               &buffer[0], 16);
     if (error) {
         return error;
     }
@@ -194,6 +236,21 @@ int16_t sen5x_read_measured_values_as_integers(
     return NO_ERROR;
 }
 
+int16_t sen5x_read_measured_values_as_integers(
+    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
+    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
+    int16_t* ambient_humidity, int16_t* ambient_temperature, int16_t* voc_index,
+    int16_t* nox_index) {
+    return sen5x_dev_read_measured_values_as_integers(&_dev,
+                                                      mass_concentration_pm1p0,
+                                                      mass_concentration_pm2p5,
+                                                      mass_concentration_pm4p0,
+                                                      mass_concentration_pm10p0,
+                                                      ambient_humidity,
+                                                      ambient_temperature,
+                                                      voc_index, nox_index);
+}
+
 int16_t sen5x_read_measured_raw_values(int16_t* raw_humidity,
                                        int16_t* raw_temperature,
                                        uint16_t* raw_voc, uint16_t* raw_nox) {
@@ -818,16 +875,33 @@ int16_t sen5x_read_and_clear_device_status(uint32_t* device_status) {
     return NO_ERROR;
 }
 
-int16_t sen5x_device_reset(void) {
+int16_t sen5x_dev_device_reset_nowait(sen5x_dev_t* dev) {
     int16_t error;
     uint8_t buffer[2];
     uint16_t offset = 0;
     offset = sensirion_i2c_add_command_to_buffer(&buffer[0], offset, 0xD304);
 
-    error = sensirion_i2c_write_data(SEN5X_I2C_ADDRESS, &buffer[0], offset);
+    error = sensirion_i2c_write_data_fd(dev->fd, dev->address, &buffer[0],
+                                        offset);
     if (error) {
         return error;
     }
-    sensirion_i2c_hal_sleep_usec(200000);
     return NO_ERROR;
 }
+
+int16_t sen5x_dev_device_reset(sen5x_dev_t* dev) {
+    int16_t error = sen5x_dev_device_reset_nowait(dev);
+    if (error) {
+        return error;
+    }
+    sensirion_i2c_hal_sleep_usec(SEN5X_DEVICE_RESET_USEC);
+    return NO_ERROR;
+}
+
+int16_t sen5x_device_reset(void) {
+    return sen5x_dev_device_reset(&_dev);
+}
+
+int16_t sen5x_device_reset_nowait(void) {
+    return sen5x_dev_device_reset_nowait(&_dev);
+}
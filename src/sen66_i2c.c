@@ -43,12 +43,16 @@
 
 #define sensirion_hal_sleep_us sensirion_i2c_hal_sleep_usec
 
-static uint8_t communication_buffer[48] = {0};
-
-static uint8_t _i2c_address;
+/* Device behind the legacy API: default bus, address from sen66_init(). */
+static sen66_dev_t _dev = {SENSIRION_I2C_HAL_DEFAULT_FD, 0, {0}};
 
 void sen66_init(uint8_t i2c_address) {
-    _i2c_address = i2c_address;
+    _dev.address = i2c_address;
+}
+
+void sen66_dev_init(sen66_dev_t* dev, int fd, uint8_t i2c_address) {
+    dev->fd = fd;
+    dev->address = i2c_address;
 }
 
 float sen66_signal_mass_concentration_pm1p0(
@@ -144,13 +148,14 @@ uint16_t sen66_signal_co2(uint16_t co2_raw) {
     return co2;
 }
 
-int16_t sen66_read_measured_values(float* mass_concentration_pm1p0,
-                                   float* mass_concentration_pm2p5,
-                                   float* mass_concentration_pm4p0,
-                                   float* mass_concentration_pm10p0,
-                                   float* humidity, float* temperature,
-                                   float* voc_index, float* nox_index,
-                                   uint16_t* co2) {
+int16_t sen66_dev_read_measured_values(sen66_dev_t* dev,
+                                       float* mass_concentration_pm1p0,
+                                       float* mass_concentration_pm2p5,
+                                       float* mass_concentration_pm4p0,
+                                       float* mass_concentration_pm10p0,
+                                       float* humidity, float* temperature,
+                                       float* voc_index, float* nox_index,
+                                       uint16_t* co2) {
     uint16_t mass_concentration_pm1p0_raw = 0;
     uint16_t mass_concentration_pm2p5_raw = 0;
     uint16_t mass_concentration_pm4p0_raw = 0;
@@ -161,8 +166,8 @@ int16_t sen66_read_measured_values(float* mass_concentration_pm1p0,
     int16_t nox_index_raw = 0;
     uint16_t co2_raw = 0;
     int16_t local_error = 0;
-    local_error = sen66_read_measured_values_as_integers(
-        &mass_concentration_pm1p0_raw, &mass_concentration_pm2p5_raw,
+    local_error = sen66_dev_read_measured_values_as_integers(
+        dev, &mass_concentration_pm1p0_raw, &mass_concentration_pm2p5_raw,
         &mass_concentration_pm4p0_raw, &mass_concentration_pm10p0_raw,
         &humidity_raw, &temperature_raw, &voc_index_raw, &nox_index_raw,
         &co2_raw);
@@ -185,6 +190,21 @@ int16_t sen66_read_measured_values(float* mass_concentration_pm1p0,
     return local_error;
 }
 
+int16_t sen66_read_measured_values(float* mass_concentration_pm1p0,
+                                   float* mass_concentration_pm2p5,
+                                   float* mass_concentration_pm4p0,
+                                   float* mass_concentration_pm10p0,
+                                   float* humidity, float* temperature,
+                                   float* voc_index, float* nox_index,
+                                   uint16_t* co2) {
+    return sen66_dev_read_measured_values(&_dev, mass_concentration_pm1p0,
+                                          mass_concentration_pm2p5,
+                                          mass_concentration_pm4p0,
+                                          mass_concentration_pm10p0, humidity,
+                                          temperature, voc_index, nox_index,
+                                          co2);
+}
+
 int16_t sen66_read_number_concentration_values(
     float* number_concentration_pm0p5, float* number_concentration_pm1p0,
     float* number_concentration_pm2p5, float* number_concentration_pm4p0,
@@ -215,14 +235,14 @@ int16_t sen66_read_number_concentration_values(
     return local_error;
 }
 
-int16_t sen66_start_continuous_measurement() {
+int16_t sen66_dev_start_continuous_measurement(sen66_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x21);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -230,14 +250,18 @@ int16_t sen66_start_continuous_measurement() {
     return local_error;
 }
 
-int16_t sen66_stop_measurement() {
+int16_t sen66_start_continuous_measurement() {
+    return sen66_dev_start_continuous_measurement(&_dev);
+}
+
+int16_t sen66_dev_stop_measurement(sen66_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x104);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -245,19 +269,25 @@ int16_t sen66_stop_measurement() {
     return local_error;
 }
 
-int16_t sen66_get_data_ready(uint8_t* padding, bool* data_ready) {
+int16_t sen66_stop_measurement() {
+    return sen66_dev_stop_measurement(&_dev);
+}
+
+int16_t sen66_dev_get_data_ready(sen66_dev_t* dev, uint8_t* padding,
+                                 bool* data_ready) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x202);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                                     buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -266,23 +296,29 @@ int16_t sen66_get_data_ready(uint8_t* padding, bool* data_ready) {
     return local_error;
 }
 
-int16_t sen66_read_measured_values_as_integers(
-    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
-    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
-    int16_t* ambient_humidity, int16_t* ambient_temperature, int16_t* voc_index,
-    int16_t* nox_index, uint16_t* co2) {
+int16_t sen66_get_data_ready(uint8_t* padding, bool* data_ready) {
+    return sen66_dev_get_data_ready(&_dev, padding, data_ready);
+}
+
+int16_t sen66_dev_read_measured_values_as_integers(
+    sen66_dev_t* dev, uint16_t* mass_concentration_pm1p0,
+    uint16_t* mass_concentration_pm2p5, uint16_t* mass_concentration_pm4p0,
+    uint16_t* mass_concentration_pm10p0, int16_t* ambient_humidity,
+    int16_t* ambient_temperature, int16_t* voc_index, int16_t* nox_index,
+    uint16_t* co2) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x300);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 18);
+    local_error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                                     buffer_ptr, 18);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -302,22 +338,38 @@ int16_t sen66_read_measured_values_as_integers(
     return local_error;
 }
 
+int16_t sen66_read_measured_values_as_integers(
+    uint16_t* mass_concentration_pm1p0, uint16_t* mass_concentration_pm2p5,
+    uint16_t* mass_concentration_pm4p0, uint16_t* mass_concentration_pm10p0,
+    int16_t* ambient_humidity, int16_t* ambient_temperature, int16_t* voc_index,
+    int16_t* nox_index, uint16_t* co2) {
+    return sen66_dev_read_measured_values_as_integers(&_dev,
+                                                      mass_concentration_pm1p0,
+                                                      mass_concentration_pm2p5,
+                                                      mass_concentration_pm4p0,
+                                                      mass_concentration_pm10p0,
+                                                      ambient_humidity,
+                                                      ambient_temperature,
+                                                      voc_index, nox_index,
+                                                      co2);
+}
+
 int16_t sen66_read_number_concentration_values_as_integers(
     uint16_t* number_concentration_pm0p5, uint16_t* number_concentration_pm1p0,
     uint16_t* number_concentration_pm2p5, uint16_t* number_concentration_pm4p0,
     uint16_t* number_concentration_pm10p0) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x316);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 10);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 10);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -339,17 +391,17 @@ int16_t sen66_read_measured_raw_values(int16_t* raw_humidity,
                                        uint16_t* raw_voc, uint16_t* raw_nox,
                                        uint16_t* raw_co2) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x405);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 10);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 10);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -363,12 +415,12 @@ int16_t sen66_read_measured_raw_values(int16_t* raw_humidity,
 
 int16_t sen66_start_fan_cleaning() {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x5607);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -380,7 +432,7 @@ int16_t sen66_set_temperature_offset_parameters(int16_t offset, int16_t slope,
                                                 uint16_t time_constant,
                                                 uint16_t slot) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x60b2);
@@ -393,7 +445,7 @@ int16_t sen66_set_temperature_offset_parameters(int16_t offset, int16_t slope,
     local_offset =
         sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr, local_offset, slot);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -406,7 +458,7 @@ int16_t sen66_set_voc_algorithm_tuning_parameters(
     int16_t learning_time_gain_hours, int16_t gating_max_duration_minutes,
     int16_t std_initial, int16_t gain_factor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x60d0);
@@ -423,7 +475,7 @@ int16_t sen66_set_voc_algorithm_tuning_parameters(
     local_offset = sensirion_i2c_add_int16_t_to_buffer(buffer_ptr, local_offset,
                                                        gain_factor);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -436,17 +488,17 @@ int16_t sen66_get_voc_algorithm_tuning_parameters(
     int16_t* learning_time_gain_hours, int16_t* gating_max_duration_minutes,
     int16_t* std_initial, int16_t* gain_factor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x60d0);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 12);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 12);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -467,7 +519,7 @@ int16_t sen66_set_nox_algorithm_tuning_parameters(
     int16_t learning_time_gain_hours, int16_t gating_max_duration_minutes,
     int16_t std_initial, int16_t gain_factor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x60e1);
@@ -484,7 +536,7 @@ int16_t sen66_set_nox_algorithm_tuning_parameters(
     local_offset = sensirion_i2c_add_int16_t_to_buffer(buffer_ptr, local_offset,
                                                        gain_factor);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -497,17 +549,17 @@ int16_t sen66_get_nox_algorithm_tuning_parameters(
     int16_t* learning_time_gain_hours, int16_t* gating_max_duration_minutes,
     int16_t* std_initial, int16_t* gain_factor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x60e1);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 12);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 12);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -527,7 +579,7 @@ int16_t sen66_set_temperature_acceleration_parameters(uint16_t k, uint16_t p,
                                                       uint16_t t1,
                                                       uint16_t t2) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6100);
@@ -540,7 +592,7 @@ int16_t sen66_set_temperature_acceleration_parameters(uint16_t k, uint16_t p,
     local_offset =
         sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr, local_offset, t2);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -551,7 +603,7 @@ int16_t sen66_set_temperature_acceleration_parameters(uint16_t k, uint16_t p,
 int16_t sen66_set_voc_algorithm_state(const uint8_t* state,
                                       uint16_t state_size) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6181);
@@ -559,7 +611,7 @@ int16_t sen66_set_voc_algorithm_state(const uint8_t* state,
                                       state_size);
 
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -568,17 +620,17 @@ int16_t sen66_set_voc_algorithm_state(const uint8_t* state,
 
 int16_t sen66_get_voc_algorithm_state(uint8_t* state, uint16_t state_size) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6181);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 8);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 8);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -590,19 +642,19 @@ int16_t
 sen66_perform_forced_co2_recalibration(uint16_t target_co2_concentration,
                                        uint16_t* correction) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6707);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, target_co2_concentration);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(500 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -612,14 +664,14 @@ sen66_perform_forced_co2_recalibration(uint16_t target_co2_concentration,
 
 int16_t sen66_set_co2_sensor_automatic_self_calibration(uint16_t status) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6711);
     local_offset =
         sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr, local_offset, status);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -630,17 +682,17 @@ int16_t sen66_set_co2_sensor_automatic_self_calibration(uint16_t status) {
 int16_t sen66_get_co2_sensor_automatic_self_calibration(uint8_t* padding,
                                                         bool* status) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6711);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -651,14 +703,14 @@ int16_t sen66_get_co2_sensor_automatic_self_calibration(uint8_t* padding,
 
 int16_t sen66_set_ambient_pressure(uint16_t ambient_pressure) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6720);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(
         buffer_ptr, local_offset, ambient_pressure);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -668,17 +720,17 @@ int16_t sen66_set_ambient_pressure(uint16_t ambient_pressure) {
 
 int16_t sen66_get_ambient_pressure(uint16_t* ambient_pressure) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6720);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -688,14 +740,14 @@ int16_t sen66_get_ambient_pressure(uint16_t* ambient_pressure) {
 
 int16_t sen66_set_sensor_altitude(uint16_t altitude) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6736);
     local_offset = sensirion_i2c_add_uint16_t_to_buffer(buffer_ptr,
                                                         local_offset, altitude);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -705,17 +757,17 @@ int16_t sen66_set_sensor_altitude(uint16_t altitude) {
 
 int16_t sen66_get_sensor_altitude(uint16_t* altitude) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6736);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -725,12 +777,12 @@ int16_t sen66_get_sensor_altitude(uint16_t* altitude) {
 
 int16_t sen66_activate_sht_heater() {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6765);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -741,17 +793,17 @@ int16_t sen66_activate_sht_heater() {
 int16_t sen66_get_sht_heater_measurements(int16_t* humidity,
                                           int16_t* temperature) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6790);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 4);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 4);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -763,17 +815,17 @@ int16_t sen66_get_sht_heater_measurements(int16_t* humidity,
 int16_t sen66_get_product_name(int8_t* product_name,
                                uint16_t product_name_size) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd014);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 32);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 32);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -785,17 +837,17 @@ int16_t sen66_get_product_name(int8_t* product_name,
 int16_t sen66_get_serial_number(int8_t* serial_number,
                                 uint16_t serial_number_size) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd033);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 32);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 32);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -806,17 +858,17 @@ int16_t sen66_get_serial_number(int8_t* serial_number,
 
 int16_t sen66_get_version(uint8_t* firmware_major, uint8_t* firmware_minor) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd100);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 2);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 2);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -827,17 +879,17 @@ int16_t sen66_get_version(uint8_t* firmware_major, uint8_t* firmware_minor) {
 
 int16_t sen66_read_device_status(sen66_device_status* device_status) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd206);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 4);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 4);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -847,17 +899,17 @@ int16_t sen66_read_device_status(sen66_device_status* device_status) {
 
 int16_t sen66_read_and_clear_device_status(sen66_device_status* device_status) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd210);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(20 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 4);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 4);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -865,17 +917,33 @@ int16_t sen66_read_and_clear_device_status(sen66_device_status* device_status) {
     return local_error;
 }
 
-int16_t sen66_device_reset() {
+int16_t sen66_dev_device_reset_nowait(sen66_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd304);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
-    sensirion_i2c_hal_sleep_usec(1200 * 1000);
     return local_error;
 }
+
+int16_t sen66_dev_device_reset(sen66_dev_t* dev) {
+    int16_t local_error = sen66_dev_device_reset_nowait(dev);
+    if (local_error != NO_ERROR) {
+        return local_error;
+    }
+    sensirion_i2c_hal_sleep_usec(SEN66_DEVICE_RESET_USEC);
+    return local_error;
+}
+
+int16_t sen66_device_reset() {
+    return sen66_dev_device_reset(&_dev);
+}
+
+int16_t sen66_device_reset_nowait() {
+    return sen66_dev_device_reset_nowait(&_dev);
+}
@@ -34,7 +34,69 @@
 #include "sensirion_config.h"
 #include "sensirion_i2c_hal.h"
 
-uint8_t sensirion_i2c_generate_crc(const uint8_t* data, uint16_t count) {
+/*
+ * Lookup tables for the CRC-8 (polynomial 0x31, init 0xFF), built by the
+ * preprocessor.
+ *
+ * Shifting a byte through the CRC register is linear over GF(2), so the
+ * result for any byte is the XOR of the results for its set bits.
+ * CRC8_B0..7 are those eight basis values after one byte of shifting,
+ * CRC8_W0..7 after two bytes. Each table entry is then just an XOR
+ * combination of a basis, which keeps the macro expansion small.
+ */
+#define CRC8_SHIFT1(c) \
+    ((((c) << 1) & 0xFF) ^ ((((c) >> 7) & 1) * CRC8_POLYNOMIAL))
+#define CRC8_SHIFT2(c) CRC8_SHIFT1(CRC8_SHIFT1(c))
+#define CRC8_SHIFT8(c) CRC8_SHIFT2(CRC8_SHIFT2(CRC8_SHIFT2(CRC8_SHIFT2(c))))
+
+#define CRC8_COMBINE(x, B)                                                 \
+    ((((x) >> 0) & 1) * B##0 ^ (((x) >> 1) & 1) * B##1 ^                   \
+     (((x) >> 2) & 1) * B##2 ^ (((x) >> 3) & 1) * B##3 ^                   \
+     (((x) >> 4) & 1) * B##4 ^ (((x) >> 5) & 1) * B##5 ^                   \
+     (((x) >> 6) & 1) * B##6 ^ (((x) >> 7) & 1) * B##7)
+
+enum {
+    CRC8_B0 = CRC8_SHIFT8(0x01),
+    CRC8_B1 = CRC8_SHIFT8(0x02),
+    CRC8_B2 = CRC8_SHIFT8(0x04),
+    CRC8_B3 = CRC8_SHIFT8(0x08),
+    CRC8_B4 = CRC8_SHIFT8(0x10),
+    CRC8_B5 = CRC8_SHIFT8(0x20),
+    CRC8_B6 = CRC8_SHIFT8(0x40),
+    CRC8_B7 = CRC8_SHIFT8(0x80),
+};
+
+enum {
+    CRC8_W0 = CRC8_COMBINE(CRC8_B0, CRC8_B),
+    CRC8_W1 = CRC8_COMBINE(CRC8_B1, CRC8_B),
+    CRC8_W2 = CRC8_COMBINE(CRC8_B2, CRC8_B),
+    CRC8_W3 = CRC8_COMBINE(CRC8_B3, CRC8_B),
+    CRC8_W4 = CRC8_COMBINE(CRC8_B4, CRC8_B),
+    CRC8_W5 = CRC8_COMBINE(CRC8_B5, CRC8_B),
+    CRC8_W6 = CRC8_COMBINE(CRC8_B6, CRC8_B),
+    CRC8_W7 = CRC8_COMBINE(CRC8_B7, CRC8_B),
+};
+
+#define CRC8_ROW4(n, B)                                                    \
+    CRC8_COMBINE((n), B), CRC8_COMBINE((n) + 1, B),                        \
+        CRC8_COMBINE((n) + 2, B), CRC8_COMBINE((n) + 3, B)
+#define CRC8_ROW16(n, B)                                                   \
+    CRC8_ROW4((n), B), CRC8_ROW4((n) + 4, B), CRC8_ROW4((n) + 8, B),       \
+        CRC8_ROW4((n) + 12, B)
+#define CRC8_ROW64(n, B)                                                   \
+    CRC8_ROW16((n), B), CRC8_ROW16((n) + 16, B), CRC8_ROW16((n) + 32, B),  \
+        CRC8_ROW16((n) + 48, B)
+#define CRC8_TABLE(B)                                                      \
+    CRC8_ROW64(0, B), CRC8_ROW64(64, B), CRC8_ROW64(128, B),               \
+        CRC8_ROW64(192, B)
+
+/* crc8_table[x]: register after shifting in one byte x */
+static const uint8_t crc8_table[256] = {CRC8_TABLE(CRC8_B)};
+/* crc8_word_table[x] == crc8_table[crc8_table[x]]: two bytes, x then 0 */
+static const uint8_t crc8_word_table[256] = {CRC8_TABLE(CRC8_W)};
+
+uint8_t sensirion_i2c_generate_crc_bitwise(const uint8_t* data,
+                                           uint16_t count) {
     uint16_t current_byte;
     uint8_t crc = CRC8_INIT;
     uint8_t crc_bit;
@@ -52,6 +114,51 @@ uint8_t sensirion_i2c_generate_crc(const uint8_t* data, uint16_t count) {
     return crc;
 }
 
+uint8_t sensirion_i2c_generate_crc(const uint8_t* data, uint16_t count) {
+    uint16_t i = 0;
+    uint8_t crc = CRC8_INIT;
+
+    /* slice-by-2: both lookups are independent of each other */
+    for (; i + 1 < count; i += 2) {
+        crc = crc8_word_table[crc ^ data[i]] ^ crc8_table[data[i + 1]];
+    }
+    if (i < count) {
+        crc = crc8_table[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint8_t sensirion_i2c_generate_crc_word(const uint8_t* data) {
+    return crc8_word_table[CRC8_INIT ^ data[0]] ^ crc8_table[data[1]];
+}
+
+int8_t sensirion_i2c_crc_self_test(void) {
+    static const uint8_t odd[3] = {0xBE, 0xEF, 0x92};
+    uint8_t word[SENSIRION_WORD_SIZE];
+    uint32_t w;
+
+    for (w = 0; w <= 0xFFFF; ++w) {
+        word[0] = (uint8_t)(w >> 8);
+        word[1] = (uint8_t)w;
+        uint8_t ref = sensirion_i2c_generate_crc_bitwise(word, 2);
+        if (sensirion_i2c_generate_crc(word, 2) != ref ||
+            sensirion_i2c_generate_crc_word(word) != ref ||
+            sensirion_i2c_generate_crc(word, 1) !=
+                sensirion_i2c_generate_crc_bitwise(word, 1))
+            return CRC_ERROR;
+    }
+    /* odd lengths exercise the single-byte tail */
+    if (sensirion_i2c_generate_crc(odd, sizeof(odd)) !=
+        sensirion_i2c_generate_crc_bitwise(odd, sizeof(odd)))
+        return CRC_ERROR;
+    /* datasheet example: 0xBEEF -> 0x92 */
+    word[0] = 0xBE;
+    word[1] = 0xEF;
+    if (sensirion_i2c_generate_crc_word(word) != 0x92)
+        return CRC_ERROR;
+    return NO_ERROR;
+}
+
 int8_t sensirion_i2c_check_crc(const uint8_t* data, uint16_t count,
                                uint8_t checksum) {
     if (sensirion_i2c_generate_crc(data, count) != checksum)
@@ -77,9 +184,8 @@ uint16_t sensirion_i2c_fill_cmd_send_buf(uint8_t* buf, uint16_t cmd,
         buf[idx++] = (uint8_t)((args[i] & 0xFF00) >> 8);
         buf[idx++] = (uint8_t)((args[i] & 0x00FF) >> 0);
 
-        uint8_t crc = sensirion_i2c_generate_crc((uint8_t*)&buf[idx - 2],
-                                                 SENSIRION_WORD_SIZE);
-        buf[idx++] = crc;
+        buf[idx] = sensirion_i2c_generate_crc_word(&buf[idx - 2]);
+        idx++;
     }
     return idx;
 }
@@ -99,10 +205,9 @@ int16_t sensirion_i2c_read_words_as_bytes(uint8_t address, uint8_t* data,
     /* check the CRC for each word */
     for (i = 0, j = 0; i < size; i += SENSIRION_WORD_SIZE + CRC8_LEN) {
 
-        ret = sensirion_i2c_check_crc(&buf8[i], SENSIRION_WORD_SIZE,
-                                      buf8[i + SENSIRION_WORD_SIZE]);
-        if (ret != NO_ERROR)
-            return ret;
+        if (sensirion_i2c_generate_crc_word(&buf8[i]) !=
+            buf8[i + SENSIRION_WORD_SIZE])
+            return CRC_ERROR;
 
         data[j++] = buf8[i];
         data[j++] = buf8[i + 1];
@@ -194,13 +299,13 @@ uint16_t sensirion_i2c_add_uint32_t_to_buffer(uint8_t* buffer, uint16_t offset,
                                               uint32_t data) {
     buffer[offset++] = (uint8_t)((data & 0xFF000000) >> 24);
     buffer[offset++] = (uint8_t)((data & 0x00FF0000) >> 16);
-    buffer[offset] = sensirion_i2c_generate_crc(
-        &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    buffer[offset] = sensirion_i2c_generate_crc_word(
+        &buffer[offset - SENSIRION_WORD_SIZE]);
     offset++;
     buffer[offset++] = (uint8_t)((data & 0x0000FF00) >> 8);
     buffer[offset++] = (uint8_t)((data & 0x000000FF) >> 0);
-    buffer[offset] = sensirion_i2c_generate_crc(
-        &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    buffer[offset] = sensirion_i2c_generate_crc_word(
+        &buffer[offset - SENSIRION_WORD_SIZE]);
     offset++;
 
     return offset;
@@ -215,8 +320,8 @@ uint16_t sensirion_i2c_add_uint16_t_to_buffer(uint8_t* buffer, uint16_t offset,
                                               uint16_t data) {
     buffer[offset++] = (uint8_t)((data & 0xFF00) >> 8);
     buffer[offset++] = (uint8_t)((data & 0x00FF) >> 0);
-    buffer[offset] = sensirion_i2c_generate_crc(
-        &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    buffer[offset] = sensirion_i2c_generate_crc_word(
+        &buffer[offset - SENSIRION_WORD_SIZE]);
     offset++;
 
     return offset;
@@ -238,13 +343,13 @@ uint16_t sensirion_i2c_add_float_to_buffer(uint8_t* buffer, uint16_t offset,
 
     buffer[offset++] = (uint8_t)((convert.uint32_data & 0xFF000000) >> 24);
     buffer[offset++] = (uint8_t)((convert.uint32_data & 0x00FF0000) >> 16);
-    buffer[offset] = sensirion_i2c_generate_crc(
-        &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    buffer[offset] = sensirion_i2c_generate_crc_word(
+        &buffer[offset - SENSIRION_WORD_SIZE]);
     offset++;
     buffer[offset++] = (uint8_t)((convert.uint32_data & 0x0000FF00) >> 8);
     buffer[offset++] = (uint8_t)((convert.uint32_data & 0x000000FF) >> 0);
-    buffer[offset] = sensirion_i2c_generate_crc(
-        &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+    buffer[offset] = sensirion_i2c_generate_crc_word(
+        &buffer[offset - SENSIRION_WORD_SIZE]);
     offset++;
 
     return offset;
@@ -263,8 +368,8 @@ uint16_t sensirion_i2c_add_bytes_to_buffer(uint8_t* buffer, uint16_t offset,
         buffer[offset++] = data[i];
         buffer[offset++] = data[i + 1];
 
-        buffer[offset] = sensirion_i2c_generate_crc(
-            &buffer[offset - SENSIRION_WORD_SIZE], SENSIRION_WORD_SIZE);
+        buffer[offset] = sensirion_i2c_generate_crc_word(
+            &buffer[offset - SENSIRION_WORD_SIZE]);
         offset++;
     }
 
@@ -276,10 +381,39 @@ int16_t sensirion_i2c_write_data(uint8_t address, const uint8_t* data,
     return sensirion_i2c_hal_write(address, data, data_length);
 }
 
+int16_t sensirion_i2c_write_data_fd(int fd, uint8_t address,
+                                    const uint8_t* data, uint16_t data_length) {
+    return sensirion_i2c_hal_write_fd(fd, address, data, data_length);
+}
+
+/* Check every word's CRC and squeeze the CRC bytes out, in place. */
+static int16_t check_and_compact(uint8_t* buffer, uint16_t size) {
+    uint16_t i, j;
+
+    for (i = 0, j = 0; i < size; i += SENSIRION_WORD_SIZE + CRC8_LEN) {
+
+        if (sensirion_i2c_generate_crc_word(&buffer[i]) !=
+            buffer[i + SENSIRION_WORD_SIZE]) {
+            return CRC_ERROR;
+        }
+        buffer[j++] = buffer[i];
+        buffer[j++] = buffer[i + 1];
+    }
+
+    return NO_ERROR;
+}
+
 int16_t sensirion_i2c_read_data_inplace(uint8_t address, uint8_t* buffer,
                                         uint16_t expected_data_length) {
+    return sensirion_i2c_read_data_inplace_fd(SENSIRION_I2C_HAL_DEFAULT_FD,
+                                              address, buffer,
+                                              expected_data_length);
+}
+
+int16_t sensirion_i2c_read_data_inplace_fd(int fd, uint8_t address,
+                                           uint8_t* buffer,
+                                           uint16_t expected_data_length) {
     int16_t error;
-    uint16_t i, j;
     uint16_t size = (expected_data_length / SENSIRION_WORD_SIZE) *
                     (SENSIRION_WORD_SIZE + CRC8_LEN);
 
@@ -287,21 +421,50 @@ int16_t sensirion_i2c_read_data_inplace(uint8_t address, uint8_t* buffer,
         return BYTE_NUM_ERROR;
     }
 
-    error = sensirion_i2c_hal_read(address, buffer, size);
+    error = sensirion_i2c_hal_read_fd(fd, address, buffer, size);
     if (error) {
         return error;
     }
+    return check_and_compact(buffer, size);
+}
 
-    for (i = 0, j = 0; i < size; i += SENSIRION_WORD_SIZE + CRC8_LEN) {
+int16_t sensirion_i2c_read_data_batch_fd(int fd,
+                                         sensirion_i2c_read_req_t* reqs,
+                                         uint16_t count) {
+    sensirion_i2c_hal_msg_t msgs[SENSIRION_I2C_BATCH_MAX];
+    int16_t error;
+    int16_t result = NO_ERROR;
+    uint16_t done, i, n;
 
-        error = sensirion_i2c_check_crc(&buffer[i], SENSIRION_WORD_SIZE,
-                                        buffer[i + SENSIRION_WORD_SIZE]);
-        if (error) {
-            return error;
+    for (i = 0; i < count; i++) {
+        if (reqs[i].expected_data_length % SENSIRION_WORD_SIZE != 0) {
+            return BYTE_NUM_ERROR;
         }
-        buffer[j++] = buffer[i];
-        buffer[j++] = buffer[i + 1];
     }
 
-    return NO_ERROR;
+    for (done = 0; done < count; done += n) {
+        n = count - done;
+        if (n > SENSIRION_I2C_BATCH_MAX) {
+            n = SENSIRION_I2C_BATCH_MAX;
+        }
+        for (i = 0; i < n; i++) {
+            msgs[i].address = reqs[done + i].address;
+            msgs[i].read = 1;
+            msgs[i].count =
+                (reqs[done + i].expected_data_length / SENSIRION_WORD_SIZE) *
+                (SENSIRION_WORD_SIZE + CRC8_LEN);
+            msgs[i].data = reqs[done + i].buffer;
+        }
+
+        /* a failing message fails the whole submission */
+        error = sensirion_i2c_hal_transfer_fd(fd, msgs, n);
+        for (i = 0; i < n; i++) {
+            reqs[done + i].error =
+                error ? error : check_and_compact(msgs[i].data, msgs[i].count);
+            if (reqs[done + i].error && !result) {
+                result = reqs[done + i].error;
+            }
+        }
+    }
+    return result;
 }
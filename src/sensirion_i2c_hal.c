@@ -1,21 +1,64 @@
 #include "sensirion_i2c_hal.h"
 #include <unistd.h>
-#include <sys/time.h>
+#include <time.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
 #include <errno.h>
 
+/* One entry per open adapter. slave is the address last set with
+ * I2C_SLAVE on that fd, -1 when unknown, so repeated transfers to the
+ * same device cost one syscall instead of two. rdwr is set when the
+ * adapter takes plain I2C messages through I2C_RDWR. */
+typedef struct {
+    int fd;
+    int slave;
+    int rdwr;
+} hal_bus_t;
+
+static hal_bus_t buses[SENSIRION_I2C_HAL_MAX_BUSES];
+static unsigned nbuses;
 static int i2c_fd = -1;
 
+static hal_bus_t* find_bus(int fd) {
+    for (unsigned i = 0; i < nbuses; i++) {
+        if (buses[i].fd == fd) return &buses[i];
+    }
+    return NULL;
+}
+
 void sensirion_i2c_hal_init(void) {
-    const char *i2c_bus = "/dev/i2c-1"; // adjust for your platform
-    i2c_fd = open(i2c_bus, O_RDWR);
-    if (i2c_fd < 0) {
+    i2c_fd = sensirion_i2c_hal_open_bus(SENSIRION_I2C_HAL_DEFAULT_BUS);
+}
+
+int sensirion_i2c_hal_open_bus(unsigned bus) {
+    char path[32];
+    if (nbuses == SENSIRION_I2C_HAL_MAX_BUSES) return -1;
+
+    snprintf(path, sizeof(path), "/dev/i2c-%u", bus);
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
         perror("I2C open failed");
+        return -1;
     }
+    unsigned long funcs = 0;
+    buses[nbuses].fd = fd;
+    buses[nbuses].slave = -1;
+    buses[nbuses].rdwr = ioctl(fd, I2C_FUNCS, &funcs) == 0 &&
+                         (funcs & I2C_FUNC_I2C);
+    nbuses++;
+    return fd;
+}
+
+void sensirion_i2c_hal_close_bus(int fd) {
+    hal_bus_t* b = find_bus(fd);
+    if (!b) return;
+    close(fd);
+    *b = buses[--nbuses];
+    if (fd == i2c_fd) i2c_fd = -1;
 }
 
 void sensirion_i2c_hal_sleep_usec(uint32_t useconds) {
@@ -23,19 +66,79 @@ void sensirion_i2c_hal_sleep_usec(uint32_t useconds) {
 }
 
 uint64_t sensirion_i2c_hal_get_time_usec(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
 }
 
-int8_t sensirion_i2c_hal_write(uint8_t address, const uint8_t* data, uint16_t count) {
-    if (ioctl(i2c_fd, I2C_SLAVE, address) < 0) return -1;
-    if (write(i2c_fd, data, count) != count) return -1;
+static int select_slave(int fd, uint8_t address) {
+    hal_bus_t* b = find_bus(fd);
+    if (b && b->slave == address) return 0;
+    if (ioctl(fd, I2C_SLAVE, address) < 0) {
+        if (b) b->slave = -1;
+        return -1;
+    }
+    if (b) b->slave = address;
     return 0;
 }
 
-int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
-    if (ioctl(i2c_fd, I2C_SLAVE, address) < 0) return -1;
-    if (read(i2c_fd, data, count) != count) return -1;
+int8_t sensirion_i2c_hal_write_fd(int fd, uint8_t address, const uint8_t* data, uint16_t count) {
+    if (fd == SENSIRION_I2C_HAL_DEFAULT_FD) fd = i2c_fd;
+    if (select_slave(fd, address) < 0) return -1;
+    if (write(fd, data, count) != count) return -1;
     return 0;
 }
+
+int8_t sensirion_i2c_hal_read_fd(int fd, uint8_t address, uint8_t* data, uint16_t count) {
+    if (fd == SENSIRION_I2C_HAL_DEFAULT_FD) fd = i2c_fd;
+    if (select_slave(fd, address) < 0) return -1;
+    if (read(fd, data, count) != count) return -1;
+    return 0;
+}
+
+static int8_t transfer_split(int fd, sensirion_i2c_hal_msg_t* msgs, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        int8_t err = msgs[i].read
+            ? sensirion_i2c_hal_read_fd(fd, msgs[i].address, msgs[i].data, msgs[i].count)
+            : sensirion_i2c_hal_write_fd(fd, msgs[i].address, msgs[i].data, msgs[i].count);
+        if (err) return err;
+    }
+    return 0;
+}
+
+int8_t sensirion_i2c_hal_transfer_fd(int fd, sensirion_i2c_hal_msg_t* msgs, uint16_t count) {
+    struct i2c_msg km[I2C_RDWR_IOCTL_MAX_MSGS];
+    if (fd == SENSIRION_I2C_HAL_DEFAULT_FD) fd = i2c_fd;
+
+    hal_bus_t* b = find_bus(fd);
+    if (!b || !b->rdwr) return transfer_split(fd, msgs, count);
+
+    /* The kernel caps one I2C_RDWR call at I2C_RDWR_IOCTL_MAX_MSGS. */
+    for (uint16_t done = 0; done < count;) {
+        uint16_t n = count - done;
+        if (n > I2C_RDWR_IOCTL_MAX_MSGS) n = I2C_RDWR_IOCTL_MAX_MSGS;
+        for (uint16_t i = 0; i < n; i++) {
+            km[i].addr = msgs[done + i].address;
+            km[i].flags = msgs[done + i].read ? I2C_M_RD : 0;
+            km[i].len = msgs[done + i].count;
+            km[i].buf = msgs[done + i].data;
+        }
+        struct i2c_rdwr_ioctl_data req = {km, n};
+        if (ioctl(fd, I2C_RDWR, &req) < 0) {
+            if (errno != EOPNOTSUPP && errno != ENOTTY) return -1;
+            /* adapter refused combined messages: stop trying */
+            b->rdwr = 0;
+            return transfer_split(fd, msgs + done, count - done);
+        }
+        done += n;
+    }
+    return 0;
+}
+
+int8_t sensirion_i2c_hal_write(uint8_t address, const uint8_t* data, uint16_t count) {
+    return sensirion_i2c_hal_write_fd(i2c_fd, address, data, count);
+}
+
+int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
+    return sensirion_i2c_hal_read_fd(i2c_fd, address, data, count);
+}
@@ -0,0 +1,142 @@
+#include "sensor_bringup.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c_hal.h"
+#include "scd30_i2c.h"
+#include "sen44_i2c.h"
+#include "sen5x_i2c.h"
+#include "sen66_i2c.h"
+#include "sfa3x_i2c.h"
+
+#include <string.h>
+
+void sensor_bringup_init(sensor_bringup_t* b) {
+    memset(b, 0, sizeof(*b));
+}
+
+int sensor_bringup_add(sensor_bringup_t* b, const char* name,
+                       sensor_bringup_fn reset, uint32_t reset_usec,
+                       sensor_bringup_fn start, void* ctx) {
+    if (b->count == SENSOR_BRINGUP_MAX) return -1;
+
+    sensor_bringup_entry_t* e = &b->entries[b->count++];
+    memset(e, 0, sizeof(*e));
+    e->name = name;
+    e->reset = reset;
+    e->reset_usec = reset_usec;
+    e->start = start;
+    e->ctx = ctx;
+    return 0;
+}
+
+int sensor_bringup_run(sensor_bringup_t* b) {
+    int failed = 0;
+    b->t0_usec = sensirion_i2c_hal_get_time_usec();
+
+    for (unsigned i = 0; i < b->count; i++) {
+        sensor_bringup_entry_t* e = &b->entries[i];
+        if (e->reset) e->error = e->reset(e->ctx);
+        /* the settle time counts from when the command went out */
+        e->due_usec = sensirion_i2c_hal_get_time_usec() + e->reset_usec;
+        if (e->error != NO_ERROR) failed++;
+    }
+
+    for (;;) {
+        sensor_bringup_entry_t* next = NULL;
+        for (unsigned i = 0; i < b->count; i++) {
+            sensor_bringup_entry_t* e = &b->entries[i];
+            if (e->error != NO_ERROR || e->started) continue;
+            if (!next || e->due_usec < next->due_usec) next = e;
+        }
+        if (!next) break;
+
+        uint64_t now = sensirion_i2c_hal_get_time_usec();
+        if (next->due_usec > now) {
+            sensirion_i2c_hal_sleep_usec((uint32_t)(next->due_usec - now));
+        }
+        next->error = next->start(next->ctx);
+        if (next->error != NO_ERROR) {
+            failed++;
+            continue;
+        }
+        next->started = 1;
+        next->started_usec = sensirion_i2c_hal_get_time_usec() - b->t0_usec;
+    }
+    return failed;
+}
+
+static const sensor_sched_entry_t* find_entry(const sensor_sched_t* s,
+                                              const char* name) {
+    for (unsigned i = 0; i < s->count; i++) {
+        if (strcmp(s->entries[i].name, name) == 0) return &s->entries[i];
+    }
+    return NULL;
+}
+
+int sensor_bringup_report(sensor_bringup_t* b, const sensor_sched_t* s,
+                          FILE* out) {
+    int waiting = 0;
+
+    for (unsigned i = 0; i < b->count; i++) {
+        sensor_bringup_entry_t* e = &b->entries[i];
+        if (!e->started || e->reported) continue;
+
+        const sensor_sched_entry_t* se = find_entry(s, e->name);
+        if (!se) continue;
+        if (se->stats.samples == 0) {
+            waiting++;
+            continue;
+        }
+        e->reported = 1;
+        fprintf(out, "%s: started after %.2f s, first sample after %.2f s\n",
+                e->name, e->started_usec / 1e6,
+                (se->stats.first_sample_usec - b->t0_usec) / 1e6);
+    }
+    return waiting;
+}
+
+int16_t sensor_bringup_scd30_reset(void* ctx) {
+    return ctx ? scd30_dev_soft_reset_nowait(ctx) : scd30_soft_reset_nowait();
+}
+
+int16_t sensor_bringup_scd30_start(void* ctx) {
+    return ctx ? scd30_dev_start_periodic_measurement(ctx, 0)
+               : scd30_start_periodic_measurement(0);
+}
+
+int16_t sensor_bringup_sen44_reset(void* ctx) {
+    return ctx ? sen44_dev_device_reset_nowait(ctx)
+               : sen44_device_reset_nowait();
+}
+
+int16_t sensor_bringup_sen44_start(void* ctx) {
+    return ctx ? sen44_dev_start_measurement(ctx) : sen44_start_measurement();
+}
+
+int16_t sensor_bringup_sen5x_reset(void* ctx) {
+    return ctx ? sen5x_dev_device_reset_nowait(ctx)
+               : sen5x_device_reset_nowait();
+}
+
+int16_t sensor_bringup_sen5x_start(void* ctx) {
+    return ctx ? sen5x_dev_start_measurement(ctx) : sen5x_start_measurement();
+}
+
+int16_t sensor_bringup_sen66_reset(void* ctx) {
+    return ctx ? sen66_dev_device_reset_nowait(ctx)
+               : sen66_device_reset_nowait();
+}
+
+int16_t sensor_bringup_sen66_start(void* ctx) {
+    return ctx ? sen66_dev_start_continuous_measurement(ctx)
+               : sen66_start_continuous_measurement();
+}
+
+int16_t sensor_bringup_sfa3x_reset(void* ctx) {
+    return ctx ? sfa3x_dev_device_reset_nowait(ctx)
+               : sfa3x_device_reset_nowait();
+}
+
+int16_t sensor_bringup_sfa3x_start(void* ctx) {
+    return ctx ? sfa3x_dev_start_continuous_measurement(ctx)
+               : sfa3x_start_continuous_measurement();
+}
@@ -0,0 +1,149 @@
+#include "sensor_sched.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c_hal.h"
+#include "scd30_i2c.h"
+#include "sen44_i2c.h"
+#include "sen5x_i2c.h"
+#include "sen66_i2c.h"
+
+#include <string.h>
+
+void sensor_sched_init(sensor_sched_t* s, uint32_t poll_ms, uint32_t max_sleep_ms) {
+    memset(s, 0, sizeof(*s));
+    s->poll_usec = poll_ms * 1000u;
+    s->max_sleep_usec = max_sleep_ms * 1000u;
+}
+
+int sensor_sched_add(sensor_sched_t* s, const char* name, uint32_t interval_ms,
+                     sensor_ready_fn ready, sensor_read_fn read, void* ctx) {
+    if (s->count == SENSOR_SCHED_MAX) return -1;
+
+    sensor_sched_entry_t* e = &s->entries[s->count++];
+    memset(e, 0, sizeof(*e));
+    e->name = name;
+    e->interval_usec = interval_ms * 1000u;
+    e->ready = ready;
+    e->read = read;
+    e->ctx = ctx;
+    /* first sample lands one interval after start */
+    e->due_usec = sensirion_i2c_hal_get_time_usec() + e->interval_usec;
+    return 0;
+}
+
+/* Poll one step early: the next sample is due one interval after the
+ * last, and coming back a step before it keeps the read within one poll
+ * step of the sample without drifting late. */
+static void service(sensor_sched_t* s, sensor_sched_entry_t* e, uint64_t now,
+                    int* samples) {
+    if (e->ready) {
+        bool ready = false;
+        e->stats.polls++;
+        if (e->ready(e->ctx, &ready) != NO_ERROR) {
+            e->stats.errors++;
+            e->due_usec = now + e->interval_usec;
+            return;
+        }
+        if (!ready) {
+            e->stats.not_ready++;
+            e->due_usec = now + s->poll_usec;
+            return;
+        }
+    }
+
+    int16_t err = e->read(e->ctx);
+    if (err == DATA_NOT_READY_ERROR) {
+        /* reader checked the flag itself (e.g. scd30 try-read) */
+        e->stats.not_ready++;
+        e->due_usec = now + s->poll_usec;
+        return;
+    }
+    if (err != NO_ERROR) {
+        e->stats.errors++;
+        e->due_usec = now + e->interval_usec;
+        return;
+    }
+    if (e->stats.samples++ == 0) {
+        e->stats.first_sample_usec = sensirion_i2c_hal_get_time_usec();
+    }
+    (*samples)++;
+
+    uint32_t early = e->ready && s->poll_usec < e->interval_usec ? s->poll_usec : 0;
+    e->due_usec = now + e->interval_usec - early;
+}
+
+int sensor_sched_service(sensor_sched_t* s) {
+    int samples = 0;
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+
+    for (unsigned i = 0; i < s->count; i++) {
+        if (s->entries[i].due_usec <= now) {
+            service(s, &s->entries[i], now, &samples);
+            /* driver calls take real bus time */
+            now = sensirion_i2c_hal_get_time_usec();
+        }
+    }
+    return samples;
+}
+
+uint64_t sensor_sched_next_due(const sensor_sched_t* s) {
+    uint64_t next = UINT64_MAX;
+    for (unsigned i = 0; i < s->count; i++) {
+        if (s->entries[i].due_usec < next) next = s->entries[i].due_usec;
+    }
+    return next;
+}
+
+int sensor_sched_run(sensor_sched_t* s) {
+    int samples = sensor_sched_service(s);
+    uint64_t now = sensirion_i2c_hal_get_time_usec();
+
+    uint64_t next = sensor_sched_next_due(s);
+    if (next > now + s->max_sleep_usec) next = now + s->max_sleep_usec;
+    if (next > now) sensirion_i2c_hal_sleep_usec((uint32_t)(next - now));
+    return samples;
+}
+
+/* HAL time is CLOCK_MONOTONIC, so deadlines go to the timer as they are. */
+static void arm_next(sensor_sched_t* s) {
+    uint64_t next = sensor_sched_next_due(s);
+    if (next != UINT64_MAX) event_loop_arm_at(s->loop, s->timer, next);
+}
+
+static void on_timer(void* ctx, uint64_t expirations) {
+    sensor_sched_t* s = ctx;
+    (void)expirations;
+    sensor_sched_service(s);
+    arm_next(s);
+}
+
+int sensor_sched_attach(sensor_sched_t* s, event_loop_t* ev) {
+    s->loop = ev;
+    s->timer = event_loop_add_timer(ev, on_timer, s);
+    if (s->timer < 0) return -1;
+    arm_next(s);
+    return 0;
+}
+
+int16_t sensor_sched_scd30_ready(void* ctx, bool* data_ready) {
+    uint16_t flag = 0;
+    int16_t err = ctx ? scd30_dev_get_data_ready(ctx, &flag)
+                      : scd30_get_data_ready(&flag);
+    *data_ready = flag != 0;
+    return err;
+}
+
+int16_t sensor_sched_sen44_ready(void* ctx, bool* data_ready) {
+    return ctx ? sen44_dev_read_data_ready(ctx, data_ready)
+               : sen44_read_data_ready(data_ready);
+}
+
+int16_t sensor_sched_sen5x_ready(void* ctx, bool* data_ready) {
+    return ctx ? sen5x_dev_read_data_ready(ctx, data_ready)
+               : sen5x_read_data_ready(data_ready);
+}
+
+int16_t sensor_sched_sen66_ready(void* ctx, bool* data_ready) {
+    uint8_t padding;
+    return ctx ? sen66_dev_get_data_ready(ctx, &padding, data_ready)
+               : sen66_get_data_ready(&padding, data_ready);
+}
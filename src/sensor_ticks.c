@@ -0,0 +1,223 @@
+#include "sensor_ticks.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c_hal.h"
+#include "sensor_sched.h"
+#include "scd30_i2c.h"
+#include "sen44_i2c.h"
+#include "sen5x_i2c.h"
+#include "sen66_i2c.h"
+#include "sfa3x_i2c.h"
+
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    const char* field;
+    uint16_t scale;
+    uint8_t decimals;
+    uint8_t flags;
+} channel_def_t;
+
+#define S SAMPLE_CHANNEL_SIGNED
+#define C (SAMPLE_CHANNEL_SIGNED | SAMPLE_CHANNEL_CELSIUS)
+
+/* Scales from the datasheets; the SCD30 ones are ours (its wire format
+ * is float, see sensor_ticks_read_scd30()). */
+static const channel_def_t scd30_defs[] = {
+    {"co2", 1, 0, 0}, {"temperature", 200, 2, C}, {"humidity", 100, 2, S},
+};
+static const channel_def_t sen44_defs[] = {
+    {"pm1", 1, 0, 0}, {"pm2_5", 1, 0, 0}, {"pm4", 1, 0, 0}, {"pm10", 1, 0, 0},
+    {"voc", 10, 1, S}, {"humidity", 100, 2, S}, {"temperature", 200, 2, C},
+};
+static const channel_def_t sen5x_defs[] = {
+    {"pm1", 10, 1, 0}, {"pm2_5", 10, 1, 0}, {"pm4", 10, 1, 0},
+    {"pm10", 10, 1, 0}, {"humidity", 100, 2, S}, {"temperature", 200, 2, C},
+    {"voc", 10, 1, S}, {"nox", 10, 1, S},
+};
+static const channel_def_t sen66_defs[] = {
+    {"pm1", 10, 1, 0}, {"pm2_5", 10, 1, 0}, {"pm4", 10, 1, 0},
+    {"pm10", 10, 1, 0}, {"humidity", 100, 2, S}, {"temperature", 200, 2, C},
+    {"voc", 10, 1, S}, {"nox", 10, 1, S}, {"co2", 1, 0, 0},
+};
+static const channel_def_t sfa3x_defs[] = {
+    {"hcho", 5, 1, S}, {"humidity", 100, 2, S}, {"temperature", 200, 2, C},
+};
+
+#undef S
+#undef C
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static int add(sensor_ticks_t* t, sample_store_t* store, const char* name,
+               const char* const* fields, void* dev, const char* model,
+               const channel_def_t* defs, unsigned n) {
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->model = model;
+    t->store = store;
+    t->first = (int)store->count;
+    t->count = n;
+    t->dev = dev;
+
+    for (unsigned i = 0; i < n; i++) {
+        const char* field = fields ? fields[i] : defs[i].field;
+        if (sample_store_add(store, name, field, defs[i].scale,
+                             defs[i].decimals, defs[i].flags) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Append one sample to every channel, or a read-error marker if the read
+ * failed. DATA_NOT_READY_ERROR is a retry, not a gap, and appends
+ * nothing. */
+static int16_t commit(sensor_ticks_t* t, int16_t err, const uint16_t* raw) {
+    if (err == DATA_NOT_READY_ERROR) return err;
+
+    t->t_usec = sensirion_i2c_hal_get_time_usec();
+    for (unsigned i = 0; i < t->count; i++) {
+        sample_channel_t* c = &t->store->channels[t->first + (int)i];
+        uint8_t status = err ? SAMPLE_READ_ERROR
+                             : sample_channel_status(c, raw[i]);
+        sample_ring_append(&c->ring, t->t_usec, err ? 0 : raw[i], status);
+    }
+    if (err == NO_ERROR && t->on_sample) t->on_sample(t, t->user);
+    return err;
+}
+
+int sensor_ticks_add_scd30(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev) {
+    return add(t, store, name, fields, dev, "scd30", scd30_defs,
+               COUNT(scd30_defs));
+}
+
+int sensor_ticks_add_sen44(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev) {
+    return add(t, store, name, fields, dev, "sen44", sen44_defs,
+               COUNT(sen44_defs));
+}
+
+int sensor_ticks_add_sen5x(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev) {
+    return add(t, store, name, fields, dev, "sen5x", sen5x_defs,
+               COUNT(sen5x_defs));
+}
+
+int sensor_ticks_add_sen66(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev) {
+    return add(t, store, name, fields, dev, "sen66", sen66_defs,
+               COUNT(sen66_defs));
+}
+
+int sensor_ticks_add_sfa3x(sensor_ticks_t* t, sample_store_t* store,
+                           const char* name, const char* const* fields,
+                           void* dev) {
+    return add(t, store, name, fields, dev, "sfa3x", sfa3x_defs,
+               COUNT(sfa3x_defs));
+}
+
+/* float to ticks, with NaN and out-of-range values as "unknown" */
+static uint16_t ticks_u16(float v, float scale) {
+    if (isnan(v) || v < 0.0f || v * scale > 65534.0f) return 0xFFFF;
+    return (uint16_t)lrintf(v * scale);
+}
+
+static uint16_t ticks_i16(float v, float scale) {
+    if (isnan(v) || v * scale < -32768.0f || v * scale > 32766.0f)
+        return 0x7FFF;
+    return (uint16_t)(int16_t)lrintf(v * scale);
+}
+
+int16_t sensor_ticks_read_scd30(void* ctx) {
+    sensor_ticks_t* t = ctx;
+    float co2 = 0.0f, temperature = 0.0f, humidity = 0.0f;
+    int16_t err = t->dev ? scd30_dev_read_measurement_data(
+                               t->dev, &co2, &temperature, &humidity)
+                         : scd30_read_measurement_data(&co2, &temperature,
+                                                       &humidity);
+    uint16_t raw[3] = {ticks_u16(co2, 1.0f), ticks_i16(temperature, 200.0f),
+                       ticks_i16(humidity, 100.0f)};
+    return commit(t, err, raw);
+}
+
+int16_t sensor_ticks_read_sen44(void* ctx) {
+    sensor_ticks_t* t = ctx;
+    uint16_t pm[4] = {0};
+    int16_t voc = 0, humidity = 0, temperature = 0;
+    int16_t err;
+    if (t->dev) {
+        err = sen44_dev_read_measured_mass_concentration_and_ambient_values_ticks(
+            t->dev, &pm[0], &pm[1], &pm[2], &pm[3], &voc, &humidity,
+            &temperature);
+    } else {
+        err = sen44_read_measured_mass_concentration_and_ambient_values_ticks(
+            &pm[0], &pm[1], &pm[2], &pm[3], &voc, &humidity, &temperature);
+    }
+    uint16_t raw[7] = {pm[0], pm[1], pm[2], pm[3], (uint16_t)voc,
+                       (uint16_t)humidity, (uint16_t)temperature};
+    return commit(t, err, raw);
+}
+
+int16_t sensor_ticks_read_sen5x(void* ctx) {
+    sensor_ticks_t* t = ctx;
+    uint16_t pm[4] = {0};
+    int16_t humidity = 0, temperature = 0, voc = 0, nox = 0;
+    int16_t err = t->dev ? sen5x_dev_read_measured_values_as_integers(
+                               t->dev, &pm[0], &pm[1], &pm[2], &pm[3],
+                               &humidity, &temperature, &voc, &nox)
+                         : sen5x_read_measured_values_as_integers(
+                               &pm[0], &pm[1], &pm[2], &pm[3], &humidity,
+                               &temperature, &voc, &nox);
+    uint16_t raw[8] = {pm[0], pm[1], pm[2], pm[3], (uint16_t)humidity,
+                       (uint16_t)temperature, (uint16_t)voc, (uint16_t)nox};
+    return commit(t, err, raw);
+}
+
+int16_t sensor_ticks_read_sen66(void* ctx) {
+    sensor_ticks_t* t = ctx;
+    uint16_t pm[4] = {0}, co2 = 0;
+    int16_t humidity = 0, temperature = 0, voc = 0, nox = 0;
+    int16_t err = t->dev ? sen66_dev_read_measured_values_as_integers(
+                               t->dev, &pm[0], &pm[1], &pm[2], &pm[3],
+                               &humidity, &temperature, &voc, &nox, &co2)
+                         : sen66_read_measured_values_as_integers(
+                               &pm[0], &pm[1], &pm[2], &pm[3], &humidity,
+                               &temperature, &voc, &nox, &co2);
+    uint16_t raw[9] = {pm[0], pm[1], pm[2], pm[3], (uint16_t)humidity,
+                       (uint16_t)temperature, (uint16_t)voc, (uint16_t)nox,
+                       co2};
+    return commit(t, err, raw);
+}
+
+int16_t sensor_ticks_read_sfa3x(void* ctx) {
+    sensor_ticks_t* t = ctx;
+    int16_t hcho = 0, humidity = 0, temperature = 0;
+    int16_t err = t->dev ? sfa3x_dev_read_measured_values_as_integers(
+                               t->dev, &hcho, &humidity, &temperature)
+                         : sfa3x_read_measured_values_as_integers(
+                               &hcho, &humidity, &temperature);
+    uint16_t raw[3] = {(uint16_t)hcho, (uint16_t)humidity,
+                       (uint16_t)temperature};
+    return commit(t, err, raw);
+}
+
+int16_t sensor_ticks_ready_scd30(void* ctx, bool* data_ready) {
+    return sensor_sched_scd30_ready(((sensor_ticks_t*)ctx)->dev, data_ready);
+}
+
+int16_t sensor_ticks_ready_sen44(void* ctx, bool* data_ready) {
+    return sensor_sched_sen44_ready(((sensor_ticks_t*)ctx)->dev, data_ready);
+}
+
+int16_t sensor_ticks_ready_sen5x(void* ctx, bool* data_ready) {
+    return sensor_sched_sen5x_ready(((sensor_ticks_t*)ctx)->dev, data_ready);
+}
+
+int16_t sensor_ticks_ready_sen66(void* ctx, bool* data_ready) {
+    return sensor_sched_sen66_ready(((sensor_ticks_t*)ctx)->dev, data_ready);
+}
@@ -43,12 +43,16 @@
 
 #define sensirion_hal_sleep_us sensirion_i2c_hal_sleep_usec
 
-static uint8_t communication_buffer[48] = {0};
-
-static uint8_t _i2c_address;
+/* Device behind the legacy API: default bus, address from sfa3x_init(). */
+static sfa3x_dev_t _dev = {SENSIRION_I2C_HAL_DEFAULT_FD, 0, {0}};
 
 void sfa3x_init(uint8_t i2c_address) {
-    _i2c_address = i2c_address;
+    _dev.address = i2c_address;
+}
+
+void sfa3x_dev_init(sfa3x_dev_t* dev, int fd, uint8_t i2c_address) {
+    dev->fd = fd;
+    dev->address = i2c_address;
 }
 
 float sfa3x_signal_hcho(int16_t hcho_raw) {
@@ -69,14 +73,15 @@ float sfa3x_signal_temperature(int16_t temperature_raw) {
     return temperature;
 }
 
-int16_t sfa3x_read_measured_values(float* hcho, float* humidity,
-                                   float* temperature) {
+int16_t sfa3x_dev_read_measured_values(sfa3x_dev_t* dev, float* hcho,
+                                       float* humidity, float* temperature) {
     int16_t hcho_raw = 0;
     int16_t humidity_raw = 0;
     int16_t temperature_raw = 0;
     int16_t local_error = 0;
-    local_error = sfa3x_read_measured_values_as_integers(
-        &hcho_raw, &humidity_raw, &temperature_raw);
+    local_error = sfa3x_dev_read_measured_values_as_integers(dev, &hcho_raw,
+                                                             &humidity_raw,
+                                                             &temperature_raw);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -86,14 +91,19 @@ int16_t sfa3x_read_measured_values(float* hcho, float* humidity,
     return local_error;
 }
 
-int16_t sfa3x_start_continuous_measurement() {
+int16_t sfa3x_read_measured_values(float* hcho, float* humidity,
+                                   float* temperature) {
+    return sfa3x_dev_read_measured_values(&_dev, hcho, humidity, temperature);
+}
+
+int16_t sfa3x_dev_start_continuous_measurement(sfa3x_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x6);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -101,14 +111,18 @@ int16_t sfa3x_start_continuous_measurement() {
     return local_error;
 }
 
-int16_t sfa3x_stop_measurement() {
+int16_t sfa3x_start_continuous_measurement() {
+    return sfa3x_dev_start_continuous_measurement(&_dev);
+}
+
+int16_t sfa3x_dev_stop_measurement(sfa3x_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x104);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -116,20 +130,27 @@ int16_t sfa3x_stop_measurement() {
     return local_error;
 }
 
-int16_t sfa3x_read_measured_values_as_integers(int16_t* hcho, int16_t* humidity,
-                                               int16_t* temperature) {
+int16_t sfa3x_stop_measurement() {
+    return sfa3x_dev_stop_measurement(&_dev);
+}
+
+int16_t sfa3x_dev_read_measured_values_as_integers(sfa3x_dev_t* dev,
+                                                   int16_t* hcho,
+                                                   int16_t* humidity,
+                                                   int16_t* temperature) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0x327);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(5 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 6);
+    local_error = sensirion_i2c_read_data_inplace_fd(dev->fd, dev->address,
+                                                     buffer_ptr, 6);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -139,20 +160,26 @@ int16_t sfa3x_read_measured_values_as_integers(int16_t* hcho, int16_t* humidity,
     return local_error;
 }
 
+int16_t sfa3x_read_measured_values_as_integers(int16_t* hcho, int16_t* humidity,
+                                               int16_t* temperature) {
+    return sfa3x_dev_read_measured_values_as_integers(&_dev, hcho, humidity,
+                                                      temperature);
+}
+
 int16_t sfa3x_get_device_marking(int8_t* device_marking,
                                  uint16_t device_marking_size) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = _dev.buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd060);
     local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+        sensirion_i2c_write_data(_dev.address, buffer_ptr, local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
     sensirion_i2c_hal_sleep_usec(2 * 1000);
-    local_error = sensirion_i2c_read_data_inplace(_i2c_address, buffer_ptr, 32);
+    local_error = sensirion_i2c_read_data_inplace(_dev.address, buffer_ptr, 32);
     if (local_error != NO_ERROR) {
         return local_error;
     }
@@ -161,17 +188,33 @@ int16_t sfa3x_get_device_marking(int8_t* device_marking,
     return local_error;
 }
 
-int16_t sfa3x_device_reset() {
+int16_t sfa3x_dev_device_reset_nowait(sfa3x_dev_t* dev) {
     int16_t local_error = NO_ERROR;
-    uint8_t* buffer_ptr = communication_buffer;
+    uint8_t* buffer_ptr = dev->buffer;
     uint16_t local_offset = 0;
     local_offset =
         sensirion_i2c_add_command16_to_buffer(buffer_ptr, local_offset, 0xd304);
-    local_error =
-        sensirion_i2c_write_data(_i2c_address, buffer_ptr, local_offset);
+    local_error = sensirion_i2c_write_data_fd(dev->fd, dev->address, buffer_ptr,
+                                              local_offset);
     if (local_error != NO_ERROR) {
         return local_error;
     }
-    sensirion_i2c_hal_sleep_usec(1000 * 1000);
     return local_error;
 }
+
+int16_t sfa3x_dev_device_reset(sfa3x_dev_t* dev) {
+    int16_t local_error = sfa3x_dev_device_reset_nowait(dev);
+    if (local_error != NO_ERROR) {
+        return local_error;
+    }
+    sensirion_i2c_hal_sleep_usec(SFA3X_DEVICE_RESET_USEC);
+    return local_error;
+}
+
+int16_t sfa3x_device_reset() {
+    return sfa3x_dev_device_reset(&_dev);
+}
+
+int16_t sfa3x_device_reset_nowait() {
+    return sfa3x_dev_device_reset_nowait(&_dev);
+}
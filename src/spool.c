@@ -0,0 +1,406 @@
+#include "spool.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SPOOL_MAGIC 0x314C5053u /* "SPL1" little-endian */
+#define SPOOL_HDR_SIZE 12
+
+static uint32_t crc32_table[256];
+static pthread_once_t crc32_once = PTHREAD_ONCE_INIT;
+
+static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+        crc32_table[i] = c;
+    }
+}
+
+static uint32_t crc32(const void* data, size_t len) {
+    const uint8_t* p = data;
+    uint32_t c = 0xFFFFFFFFu;
+    while (len--) c = crc32_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+static void put_le32(uint8_t* b, uint32_t v) {
+    b[0] = (uint8_t)v;
+    b[1] = (uint8_t)(v >> 8);
+    b[2] = (uint8_t)(v >> 16);
+    b[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t* b) {
+    return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 |
+           (uint32_t)b[3] << 24;
+}
+
+static uint64_t now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void seg_path(const spool_t* sp, uint32_t id, char* buf, size_t len) {
+    snprintf(buf, len, "%s/seg-%08u.log", sp->cfg.dir, id);
+}
+
+/* Make segment creation/removal itself durable. */
+static void sync_dir(const spool_t* sp) {
+    int dfd = open(sp->cfg.dir, O_RDONLY | O_DIRECTORY);
+    if (dfd < 0) return;
+    fsync(dfd);
+    close(dfd);
+}
+
+static ssize_t read_full(int fd, void* buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = read(fd, (uint8_t*)buf + got, len - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+    return (ssize_t)got;
+}
+
+/* fdatasync the active segment with the lock dropped, so appends go on
+ * meanwhile. Only the maintaining thread replaces sp->fd, so it stays
+ * open. Bytes appended during the call are still counted as unsynced. */
+static void sync_active(spool_t* sp) {
+    if (sp->fd < 0 || sp->unsynced_bytes == 0) return;
+    int fd = sp->fd;
+    size_t bytes = sp->unsynced_bytes;
+
+    pthread_mutex_unlock(&sp->lock);
+    fdatasync(fd);
+    pthread_mutex_lock(&sp->lock);
+
+    sp->unsynced_bytes -= bytes;
+    sp->unsynced_since_usec = sp->unsynced_bytes ? now_usec() : 0;
+    sp->stats.syncs++;
+}
+
+static void drop_oldest_locked(spool_t* sp) {
+    char path[512];
+    seg_path(sp, sp->first_id, path, sizeof(path));
+    if (unlink(path) == 0) {
+        sp->stats.segments--;
+        sp->stats.dropped_segments++;
+        fprintf(stderr, "Spool full, dropped %s\n", path);
+    }
+    sp->first_id++;
+}
+
+static int open_active_locked(spool_t* sp) {
+    char path[512];
+
+    while (sp->stats.segments >= sp->cfg.max_segments &&
+           sp->first_id < sp->active_id) {
+        drop_oldest_locked(sp);
+    }
+
+    seg_path(sp, sp->active_id, path, sizeof(path));
+    sp->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (sp->fd < 0) {
+        perror("Spool segment open failed");
+        return -1;
+    }
+    sp->active_bytes = 0;
+    sp->stats.segments++;
+    return 0;
+}
+
+/* Start the next segment and close the old one. Appends move to the new
+ * segment at once; the old one is synced and closed with the lock
+ * dropped. */
+static void rotate(spool_t* sp) {
+    int old = sp->fd;
+    size_t unsynced = sp->unsynced_bytes;
+
+    sp->fd = -1;
+    sp->active_id++;
+    sp->active_bytes = 0;
+    sp->unsynced_bytes = 0;
+    sp->unsynced_since_usec = 0;
+    open_active_locked(sp);
+
+    pthread_mutex_unlock(&sp->lock);
+    if (old >= 0) {
+        if (unsynced) fdatasync(old);
+        close(old);
+    }
+    sync_dir(sp);
+    pthread_mutex_lock(&sp->lock);
+    if (old >= 0 && unsynced) sp->stats.syncs++;
+}
+
+int spool_open(spool_t* sp, const spool_config_t* cfg) {
+    memset(sp, 0, sizeof(*sp));
+    sp->cfg = *cfg;
+    sp->fd = -1;
+    if (sp->cfg.max_segments < 2) sp->cfg.max_segments = 2;
+    pthread_once(&crc32_once, crc32_init);
+
+    if (mkdir(cfg->dir, 0755) != 0 && errno != EEXIST) {
+        perror("Spool mkdir failed");
+        return -1;
+    }
+
+    DIR* d = opendir(cfg->dir);
+    if (!d) {
+        perror("Spool opendir failed");
+        return -1;
+    }
+    uint32_t lo = UINT32_MAX, hi = 0;
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        unsigned id;
+        char tail;
+        if (sscanf(e->d_name, "seg-%8u.lo%c", &id, &tail) == 2 && tail == 'g') {
+            if (id < lo) lo = id;
+            if (id > hi) hi = id;
+            sp->stats.segments++;
+        }
+    }
+    closedir(d);
+
+    /* Never append behind a possibly torn tail: start a fresh segment. */
+    sp->first_id = sp->stats.segments ? lo : 1;
+    sp->active_id = sp->stats.segments ? hi + 1 : 1;
+    sp->read_id = sp->first_id;
+
+    sp->batch = malloc(sp->cfg.replay_bytes);
+    if (!sp->batch) return -1;
+    pthread_mutex_init(&sp->lock, NULL);
+
+    if (sp->stats.segments)
+        printf("Spool: %u segment(s) pending replay in %s\n",
+               sp->stats.segments, cfg->dir);
+    if (open_active_locked(sp) == 0) sync_dir(sp);
+    return 0;
+}
+
+int spool_append(spool_t* sp, const char* data, size_t len) {
+    if (len == 0 || len > sp->cfg.replay_bytes) return -1;
+
+    uint8_t hdr[SPOOL_HDR_SIZE];
+    put_le32(&hdr[0], SPOOL_MAGIC);
+    put_le32(&hdr[4], (uint32_t)len);
+    put_le32(&hdr[8], crc32(data, len));
+    struct iovec iov[2] = {
+        {.iov_base = hdr, .iov_len = sizeof(hdr)},
+        {.iov_base = (void*)data, .iov_len = len},
+    };
+    size_t total = sizeof(hdr) + len;
+
+    pthread_mutex_lock(&sp->lock);
+    if (sp->fd < 0) {
+        /* spool_maintain() opens a new one */
+        pthread_mutex_unlock(&sp->lock);
+        return -1;
+    }
+
+    ssize_t n = writev(sp->fd, iov, 2);
+    if (n != (ssize_t)total) {
+        /* Cut the partial record so replay does not flag the tail. */
+        if (n > 0 && ftruncate(sp->fd, (off_t)sp->active_bytes) != 0) {
+            perror("Spool truncate failed");
+        }
+        pthread_mutex_unlock(&sp->lock);
+        perror("Spool write failed");
+        return -1;
+    }
+
+    sp->active_bytes += total;
+    if (sp->unsynced_bytes == 0) sp->unsynced_since_usec = now_usec();
+    sp->unsynced_bytes += total;
+    sp->stats.appended++;
+    sp->stats.appended_bytes += len;
+    pthread_mutex_unlock(&sp->lock);
+    return 0;
+}
+
+void spool_maintain(spool_t* sp) {
+    pthread_mutex_lock(&sp->lock);
+    if (sp->fd < 0) {
+        if (open_active_locked(sp) == 0) {
+            pthread_mutex_unlock(&sp->lock);
+            sync_dir(sp);
+            return;
+        }
+    } else if (sp->active_bytes >= sp->cfg.segment_bytes) {
+        rotate(sp);
+    } else if (sp->unsynced_bytes >= sp->cfg.sync_bytes ||
+               (sp->unsynced_bytes > 0 &&
+                now_usec() - sp->unsynced_since_usec >=
+                    (uint64_t)sp->cfg.sync_interval_ms * 1000)) {
+        sync_active(sp);
+    }
+    pthread_mutex_unlock(&sp->lock);
+}
+
+int spool_pending(spool_t* sp) {
+    pthread_mutex_lock(&sp->lock);
+    int pending = sp->first_id < sp->active_id || sp->active_bytes > 0;
+    pthread_mutex_unlock(&sp->lock);
+    return pending;
+}
+
+static void count_replayed(spool_t* sp, uint64_t records, size_t bytes) {
+    pthread_mutex_lock(&sp->lock);
+    sp->stats.replayed += records;
+    sp->stats.replayed_bytes += bytes;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+static void count_corrupt(spool_t* sp, const char* path) {
+    pthread_mutex_lock(&sp->lock);
+    sp->stats.corrupt++;
+    pthread_mutex_unlock(&sp->lock);
+    fprintf(stderr, "Spool: damaged record in %s, skipping rest of segment\n",
+            path);
+}
+
+/* Mark segment id as fully consumed. It may already have been dropped
+ * by a concurrent append that needed the space. */
+static void finish_segment(spool_t* sp, uint32_t id) {
+    char path[512];
+    seg_path(sp, id, path, sizeof(path));
+
+    pthread_mutex_lock(&sp->lock);
+    if (sp->first_id == id) {
+        if (unlink(path) == 0) sp->stats.segments--;
+        sp->first_id++;
+    }
+    pthread_mutex_unlock(&sp->lock);
+    sp->read_off = 0;
+}
+
+int spool_replay(spool_t* sp, spool_send_fn send, void* ctx,
+                 uint32_t max_batches) {
+    uint32_t batches = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&sp->lock);
+        if (sp->first_id == sp->active_id) {
+            if (sp->active_bytes == 0) {
+                pthread_mutex_unlock(&sp->lock);
+                return 0;
+            }
+            rotate(sp);
+        }
+        if (sp->read_id != sp->first_id) {
+            sp->read_id = sp->first_id;
+            sp->read_off = 0;
+        }
+        uint32_t id = sp->read_id;
+        pthread_mutex_unlock(&sp->lock);
+
+        if (batches >= max_batches) return 1;
+
+        char path[512];
+        seg_path(sp, id, path, sizeof(path));
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            finish_segment(sp, id);
+            continue;
+        }
+        if (lseek(fd, (off_t)sp->read_off, SEEK_SET) < 0) {
+            close(fd);
+            finish_segment(sp, id);
+            continue;
+        }
+
+        size_t off = sp->read_off;
+        size_t batch_start = off;
+        size_t blen = 0;
+        uint64_t records = 0;
+
+        for (;;) {
+            uint8_t hdr[SPOOL_HDR_SIZE];
+            ssize_t n = read_full(fd, hdr, sizeof(hdr));
+            if (n == 0) break;
+
+            uint32_t len = n == SPOOL_HDR_SIZE ? get_le32(&hdr[4]) : 0;
+            if (n != SPOOL_HDR_SIZE || get_le32(&hdr[0]) != SPOOL_MAGIC ||
+                len == 0 || len > sp->cfg.replay_bytes) {
+                count_corrupt(sp, path);
+                break;
+            }
+
+            if (blen + len > sp->cfg.replay_bytes) {
+                if (send(ctx, sp->batch, blen) != 0) {
+                    sp->read_off = batch_start;
+                    close(fd);
+                    return -1;
+                }
+                count_replayed(sp, records, blen);
+                batches++;
+                blen = 0;
+                records = 0;
+                batch_start = off;
+                if (batches >= max_batches) {
+                    sp->read_off = off;
+                    close(fd);
+                    return 1;
+                }
+            }
+
+            if (read_full(fd, sp->batch + blen, len) != (ssize_t)len ||
+                crc32(sp->batch + blen, len) != get_le32(&hdr[8])) {
+                count_corrupt(sp, path);
+                break;
+            }
+            blen += len;
+            off += SPOOL_HDR_SIZE + len;
+            records++;
+        }
+        close(fd);
+
+        if (blen > 0) {
+            if (send(ctx, sp->batch, blen) != 0) {
+                sp->read_off = batch_start;
+                return -1;
+            }
+            count_replayed(sp, records, blen);
+            batches++;
+        }
+        finish_segment(sp, id);
+    }
+}
+
+void spool_get_stats(spool_t* sp, spool_stats_t* out) {
+    pthread_mutex_lock(&sp->lock);
+    *out = sp->stats;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+void spool_close(spool_t* sp) {
+    pthread_mutex_lock(&sp->lock);
+    if (sp->fd >= 0) {
+        sync_active(sp);
+        close(sp->fd);
+        sp->fd = -1;
+        /* nothing was spilled: leave no empty segment to replay */
+        if (sp->active_bytes == 0) {
+            char path[512];
+            seg_path(sp, sp->active_id, path, sizeof(path));
+            if (unlink(path) == 0) sp->stats.segments--;
+        }
+    }
+    pthread_mutex_unlock(&sp->lock);
+    pthread_mutex_destroy(&sp->lock);
+    free(sp->batch);
+    sp->batch = NULL;
+}
@@ -0,0 +1,51 @@
+#include "spsc_ring.h"
+
+#include <stdlib.h>
+
+int spsc_ring_init(spsc_ring_t* r, uint32_t capacity, size_t slot_size) {
+    uint32_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    r->slots = malloc((size_t)cap * slot_size);
+    if (!r->slots) return -1;
+    r->mask = cap - 1;
+    r->slot_size = slot_size;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void spsc_ring_free(spsc_ring_t* r) {
+    free(r->slots);
+    r->slots = NULL;
+}
+
+void* spsc_ring_reserve(spsc_ring_t* r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) return NULL;
+    return r->slots + (size_t)(head & r->mask) * r->slot_size;
+}
+
+void spsc_ring_commit(spsc_ring_t* r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+const void* spsc_ring_peek(spsc_ring_t* r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (head == tail) return NULL;
+    return r->slots + (size_t)(tail & r->mask) * r->slot_size;
+}
+
+void spsc_ring_release(spsc_ring_t* r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+}
+
+uint32_t spsc_ring_depth(const spsc_ring_t* r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return head - tail;
+}
@@ -0,0 +1,530 @@
+#include "tsdb.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define TSDB_MAGIC 0x42445354u       /* "TSDB" little-endian */
+#define TSDB_BLOCK_MAGIC 0x31425354u /* "TSB1" */
+#define TSDB_VERSION 1
+#define TSDB_FILE_HEADER 512
+#define TSDB_COLUMN_BYTES (TSDB_FIELD_MAX + 4)
+#define TSDB_BLOCK_FIXED 32
+#define TSDB_MAX_SPAN_MS (24u * 3600 * 1000)
+
+/* Worst case per row: '1111' + 32 bits of time, '1111' + 16 bits of value */
+#define TIME_STREAM_BYTES (TSDB_BLOCK_MAX_ROWS * 36 / 8 + 8)
+#define VALUE_STREAM_BYTES (TSDB_BLOCK_MAX_ROWS * 20 / 8 + 8)
+
+static void put_le16(uint8_t* b, uint16_t v) {
+    b[0] = (uint8_t)v;
+    b[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t* b, uint32_t v) {
+    put_le16(b, (uint16_t)v);
+    put_le16(b + 2, (uint16_t)(v >> 16));
+}
+
+static void put_le64(uint8_t* b, uint64_t v) {
+    put_le32(b, (uint32_t)v);
+    put_le32(b + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_le16(const uint8_t* b) {
+    return (uint16_t)(b[0] | b[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t* b) {
+    return (uint32_t)get_le16(b) | (uint32_t)get_le16(b + 2) << 16;
+}
+
+static uint64_t get_le64(const uint8_t* b) {
+    return (uint64_t)get_le32(b) | (uint64_t)get_le32(b + 4) << 32;
+}
+
+static size_t block_header_bytes(unsigned columns) {
+    return TSDB_BLOCK_FIXED + 4 * (columns + 1);
+}
+
+static uint32_t block_crc(const uint8_t* block, size_t len) {
+    return (uint32_t)crc32(0L, block + 16, (uInt)(len - 16));
+}
+
+/* ---------- Bit streams ---------- */
+
+/* n bits of v, most significant first, into a zeroed stream. */
+static void put_bits(uint8_t* s, size_t* bits, uint64_t v, unsigned n) {
+    while (n) {
+        unsigned room = 8 - (unsigned)(*bits & 7);
+        unsigned take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        s[*bits >> 3] |= (uint8_t)(chunk << (room - take));
+        *bits += take;
+        n -= take;
+    }
+}
+
+typedef struct {
+    const uint8_t* p;
+    size_t len;              /* bytes */
+    size_t pos;              /* bits read */
+} bit_reader_t;
+
+/* Next n (1..32) bits without consuming them; zeros past the end. */
+static uint32_t peek_bits(const bit_reader_t* b, unsigned n) {
+    size_t byte = b->pos >> 3;
+    uint64_t w = 0;
+    if (byte + 8 <= b->len) {
+        for (unsigned i = 0; i < 8; i++) w = w << 8 | b->p[byte + i];
+    } else {
+        for (unsigned i = 0; i < 8; i++)
+            w = w << 8 | (byte + i < b->len ? b->p[byte + i] : 0);
+    }
+    return (uint32_t)((w << (b->pos & 7)) >> (64 - n));
+}
+
+static uint32_t get_bits(bit_reader_t* b, unsigned n) {
+    uint32_t v = peek_bits(b, n);
+    b->pos += n;
+    return v;
+}
+
+/* Consume a '0', '10', '110', '1110' or '1111' prefix and return the
+ * bucket it selects, 0..4. */
+static unsigned get_prefix(bit_reader_t* b) {
+    uint32_t v = peek_bits(b, 4);
+    unsigned bucket = v < 8 ? 0 : v < 12 ? 1 : v < 14 ? 2 : v < 15 ? 3 : 4;
+    b->pos += bucket < 4 ? bucket + 1 : 4;
+    return bucket;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/* Delta-of-delta of a timestamp, in ms */
+static const unsigned time_bits[4] = {0, 7, 9, 12};
+
+static void put_time(uint8_t* s, size_t* bits, int32_t dod) {
+    uint32_t zz = zigzag(dod);
+    if (zz == 0) put_bits(s, bits, 0, 1);
+    else if (zz < 1u << 7) put_bits(s, bits, 0x2u << 7 | zz, 2 + 7);
+    else if (zz < 1u << 9) put_bits(s, bits, 0x6u << 9 | zz, 3 + 9);
+    else if (zz < 1u << 12) put_bits(s, bits, 0xEu << 12 | zz, 4 + 12);
+    else put_bits(s, bits, (uint64_t)0xF << 32 | zz, 4 + 32);
+}
+
+static int32_t get_time(bit_reader_t* b) {
+    unsigned bucket = get_prefix(b);
+    if (bucket == 0) return 0;
+    return unzigzag(get_bits(b, bucket < 4 ? time_bits[bucket] : 32));
+}
+
+/* Value: delta to the previous row in ticks, or the raw value for a jump */
+static const unsigned value_bits[4] = {0, 3, 6, 10};
+
+static void put_value(uint8_t* s, size_t* bits, uint16_t raw, uint16_t prev) {
+    uint32_t zz = zigzag((int16_t)(uint16_t)(raw - prev));
+    if (zz == 0) put_bits(s, bits, 0, 1);
+    else if (zz < 1u << 3) put_bits(s, bits, 0x2u << 3 | zz, 2 + 3);
+    else if (zz < 1u << 6) put_bits(s, bits, 0x6u << 6 | zz, 3 + 6);
+    else if (zz < 1u << 10) put_bits(s, bits, 0xEu << 10 | zz, 4 + 10);
+    else put_bits(s, bits, 0xFu << 16 | raw, 4 + 16);
+}
+
+static uint16_t get_value(bit_reader_t* b, uint16_t prev) {
+    unsigned bucket = get_prefix(b);
+    if (bucket == 0) return prev;
+    if (bucket == 4) return (uint16_t)get_bits(b, 16);
+    return (uint16_t)(prev + unzigzag(get_bits(b, value_bits[bucket])));
+}
+
+/* ---------- Writer ---------- */
+
+static void encode_file_header(uint8_t* h, const tsdb_column_t* columns,
+                               unsigned count) {
+    memset(h, 0, TSDB_FILE_HEADER);
+    put_le32(h, TSDB_MAGIC);
+    put_le16(h + 4, TSDB_VERSION);
+    put_le16(h + 6, (uint16_t)count);
+    for (unsigned i = 0; i < count; i++) {
+        uint8_t* c = h + 8 + i * TSDB_COLUMN_BYTES;
+        strncpy((char*)c, columns[i].field, TSDB_FIELD_MAX - 1);
+        put_le16(c + TSDB_FIELD_MAX, columns[i].scale);
+        c[TSDB_FIELD_MAX + 2] = columns[i].decimals;
+        c[TSDB_FIELD_MAX + 3] = columns[i].flags;
+    }
+}
+
+/* Length of the block at pos if its header is sound, else 0. */
+static uint32_t block_len(const uint8_t* map, uint64_t pos, uint64_t size,
+                          unsigned columns) {
+    if (pos + TSDB_BLOCK_FIXED > size) return 0;
+    const uint8_t* b = map + pos;
+    uint32_t len = get_le32(b + 4);
+    uint32_t rows = get_le32(b + 8);
+    size_t min = block_header_bytes(columns);
+    size_t max = min + TIME_STREAM_BYTES + columns * VALUE_STREAM_BYTES;
+    if (get_le32(b) != TSDB_BLOCK_MAGIC || len < min || len > max || len % 8 ||
+        len > size - pos || rows == 0 || rows > TSDB_BLOCK_MAX_ROWS)
+        return 0;
+    return len;
+}
+
+/* Past a damaged block at pos: the next 8-byte boundary with a sound
+ * header and a good CRC, or size if nothing after pos is a block. */
+static uint64_t resync(const uint8_t* map, uint64_t pos, uint64_t size,
+                       unsigned columns) {
+    for (pos += 8; pos + TSDB_BLOCK_FIXED <= size; pos += 8) {
+        uint32_t len = block_len(map, pos, size, columns);
+        if (len && block_crc(map + pos, len) == get_le32(map + pos + 12)) return pos;
+    }
+    return size;
+}
+
+/* Walk the blocks after the file header and cut off a torn tail: a
+ * block that runs past the end, or the last block with a bad CRC. A
+ * damaged block with good ones after it is left in place and skipped
+ * (w->damaged). Leaves w->end and w->t_last at the last good block. */
+static int recover(tsdb_writer_t* w, uint64_t size) {
+    uint64_t pos = TSDB_FILE_HEADER;
+    uint64_t last = 0;               /* offset of the last block */
+    uint64_t t_before = 0;           /* t_last of the one before it */
+
+    if (size > TSDB_FILE_HEADER) {
+        void* p = mmap(NULL, size, PROT_READ, MAP_SHARED, w->fd, 0);
+        if (p == MAP_FAILED) return -1;
+        const uint8_t* map = p;
+
+        while (pos < size) {
+            uint32_t len = block_len(map, pos, size, w->columns);
+            if (len == 0) {
+                uint64_t next = resync(map, pos, size, w->columns);
+                if (next == size) break;         /* the tail */
+                w->damaged += next - pos;
+                pos = next;
+                continue;
+            }
+            t_before = w->t_last;
+            w->t_last = get_le64(map + pos + 24);
+            last = pos;
+            pos += len;
+        }
+
+        /* Only the tail can be half-written: check the last block's CRC */
+        if (last && block_crc(map + last, (size_t)(pos - last)) != get_le32(map + last + 12)) {
+            pos = last;
+            w->t_last = t_before;
+        }
+        munmap(p, size);
+    }
+    if (pos < size && ftruncate(w->fd, (off_t)pos) != 0) return -1;
+    w->end = pos;
+    return 0;
+}
+
+int tsdb_writer_open(tsdb_writer_t* w, const char* path,
+                     const tsdb_column_t* columns, unsigned count,
+                     uint32_t block_ms) {
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+    if (count == 0 || count > TSDB_MAX_COLUMNS) {
+        errno = EINVAL;
+        return -1;
+    }
+    w->columns = count;
+    w->block_ms = block_ms && block_ms < TSDB_MAX_SPAN_MS ? block_ms : TSDB_MAX_SPAN_MS;
+
+    size_t streams = TIME_STREAM_BYTES + count * VALUE_STREAM_BYTES;
+    w->buf = calloc(1, 2 * streams + block_header_bytes(count) + 8);
+    if (!w->buf) return -1;
+    w->stream[0] = w->buf;
+    for (unsigned i = 0; i < count; i++)
+        w->stream[i + 1] = w->buf + TIME_STREAM_BYTES + i * VALUE_STREAM_BYTES;
+
+    w->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (w->fd < 0) goto fail;
+    struct stat st;
+    if (fstat(w->fd, &st) != 0) goto fail;
+
+    uint8_t want[TSDB_FILE_HEADER], have[TSDB_FILE_HEADER];
+    encode_file_header(want, columns, count);
+    if (st.st_size < TSDB_FILE_HEADER) {
+        /* new, or torn while being created */
+        if (ftruncate(w->fd, 0) != 0 ||
+            pwrite(w->fd, want, sizeof(want), 0) != (ssize_t)sizeof(want))
+            goto fail;
+        w->end = TSDB_FILE_HEADER;
+        return 0;
+    }
+    if (pread(w->fd, have, sizeof(have), 0) != (ssize_t)sizeof(have)) goto fail;
+    if (memcmp(want, have, sizeof(want)) != 0) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (recover(w, (uint64_t)st.st_size) != 0) goto fail;
+    memset(w->buf, 0, 2 * streams);
+    return 0;
+
+fail:;
+    int err = errno;
+    if (w->fd >= 0) close(w->fd);
+    free(w->buf);
+    w->fd = -1;
+    w->buf = NULL;
+    errno = err;
+    return -1;
+}
+
+int tsdb_writer_seal(tsdb_writer_t* w) {
+    if (w->rows == 0) return 0;
+
+    size_t hdr = block_header_bytes(w->columns);
+    size_t streams = TIME_STREAM_BYTES + w->columns * VALUE_STREAM_BYTES;
+    uint8_t* block = w->buf + streams;
+    size_t len = hdr;
+    for (unsigned i = 0; i <= w->columns; i++) {
+        size_t bytes = (w->bits[i] + 7) / 8;
+        put_le32(block + TSDB_BLOCK_FIXED + 4 * i, (uint32_t)bytes);
+        memcpy(block + len, w->stream[i], bytes);
+        memset(w->stream[i], 0, bytes);
+        len += bytes;
+        w->bits[i] = 0;
+    }
+    while (len % 8) block[len++] = 0;
+
+    put_le32(block, TSDB_BLOCK_MAGIC);
+    put_le32(block + 4, (uint32_t)len);
+    put_le32(block + 8, w->rows);
+    put_le64(block + 16, w->t_first);
+    put_le64(block + 24, w->t_last);
+    put_le32(block + 12, block_crc(block, len));
+    w->rows = 0;
+
+    if (pwrite(w->fd, block, len, (off_t)w->end) != (ssize_t)len) {
+        /* leave the tail as it was: a partial block would be cut off on
+         * the next open anyway */
+        w->stats.write_errors++;
+        return -1;
+    }
+    w->end += len;
+    w->stats.blocks++;
+    w->stats.bytes += len;
+    return 0;
+}
+
+int tsdb_writer_append(tsdb_writer_t* w, uint64_t t_ms, const uint16_t* raw) {
+    int rc = 0;
+    if (t_ms < w->t_last) t_ms = w->t_last;
+    if (w->rows && (w->rows == TSDB_BLOCK_MAX_ROWS || t_ms - w->t_first >= w->block_ms))
+        rc = tsdb_writer_seal(w);
+
+    if (w->rows == 0) {
+        w->t_first = t_ms;
+        w->prev_delta = 0;
+        for (unsigned i = 0; i < w->columns; i++)
+            put_bits(w->stream[i + 1], &w->bits[i + 1], raw[i], 16);
+    } else {
+        int64_t delta = (int64_t)(t_ms - w->t_last);
+        put_time(w->stream[0], &w->bits[0], (int32_t)(delta - w->prev_delta));
+        w->prev_delta = delta;
+        for (unsigned i = 0; i < w->columns; i++)
+            put_value(w->stream[i + 1], &w->bits[i + 1], raw[i], w->prev[i]);
+    }
+    memcpy(w->prev, raw, w->columns * sizeof(raw[0]));
+    w->t_last = t_ms;
+    w->rows++;
+    w->stats.rows++;
+    return rc;
+}
+
+void tsdb_writer_close(tsdb_writer_t* w) {
+    if (w->fd < 0) return;
+    tsdb_writer_seal(w);
+    fdatasync(w->fd);
+    close(w->fd);
+    free(w->buf);
+    w->fd = -1;
+    w->buf = NULL;
+}
+
+/* ---------- Reader ---------- */
+
+int tsdb_reader_open(tsdb_reader_t* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    r->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (r->fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(r->fd, &st) != 0) goto fail;
+    if (st.st_size < TSDB_FILE_HEADER) {
+        errno = EINVAL;
+        goto fail;
+    }
+    r->size = (size_t)st.st_size;
+    void* map = mmap(NULL, r->size, PROT_READ, MAP_SHARED, r->fd, 0);
+    if (map == MAP_FAILED) goto fail;
+    r->map = map;
+
+    const uint8_t* h = r->map;
+    r->columns = get_le16(h + 6);
+    if (get_le32(h) != TSDB_MAGIC || get_le16(h + 4) != TSDB_VERSION ||
+        r->columns == 0 || r->columns > TSDB_MAX_COLUMNS) {
+        errno = EINVAL;
+        goto fail;
+    }
+    for (unsigned i = 0; i < r->columns; i++) {
+        const uint8_t* c = h + 8 + i * TSDB_COLUMN_BYTES;
+        memcpy(r->column[i].field, c, TSDB_FIELD_MAX - 1);
+        r->column[i].scale = get_le16(c + TSDB_FIELD_MAX);
+        r->column[i].decimals = c[TSDB_FIELD_MAX + 2];
+        r->column[i].flags = c[TSDB_FIELD_MAX + 3];
+    }
+
+    /* Index the blocks, stepping over damaged ones; the writer may be
+     * part-way through the last one */
+    uint32_t cap = 0;
+    for (size_t pos = TSDB_FILE_HEADER; pos < r->size;) {
+        uint32_t len = block_len(r->map, pos, r->size, r->columns);
+        if (len == 0) {
+            uint64_t next = resync(r->map, pos, r->size, r->columns);
+            if (next == r->size) break;
+            r->damaged += next - pos;
+            pos = next;
+            continue;
+        }
+        if (r->blocks == cap) {
+            cap = cap ? cap * 2 : 256;
+            uint64_t* grown = realloc(r->offset, cap * sizeof(*grown));
+            if (!grown) goto fail;
+            r->offset = grown;
+        }
+        r->offset[r->blocks++] = pos;
+        pos += len;
+    }
+
+    r->scratch = malloc(TSDB_BLOCK_MAX_ROWS * sizeof(*r->scratch));
+    r->values = malloc((size_t)r->columns * TSDB_BLOCK_MAX_ROWS * sizeof(*r->values));
+    if (!r->scratch || !r->values) goto fail;
+    return 0;
+
+fail:;
+    int err = errno;
+    tsdb_reader_close(r);
+    errno = err;
+    return -1;
+}
+
+void tsdb_reader_close(tsdb_reader_t* r) {
+    if (r->map) munmap((void*)r->map, r->size);
+    if (r->fd >= 0) close(r->fd);
+    free(r->offset);
+    free(r->scratch);
+    free(r->values);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+int tsdb_reader_column(const tsdb_reader_t* r, const char* field) {
+    for (unsigned i = 0; i < r->columns; i++) {
+        if (strcmp(r->column[i].field, field) == 0) return (int)i;
+    }
+    return -1;
+}
+
+static const uint8_t* block_at(const tsdb_reader_t* r, uint32_t i) {
+    return r->map + r->offset[i];
+}
+
+void tsdb_reader_range(const tsdb_reader_t* r, uint64_t* first_ms,
+                       uint64_t* last_ms) {
+    *first_ms = r->blocks ? get_le64(block_at(r, 0) + 16) : 0;
+    *last_ms = r->blocks ? get_le64(block_at(r, r->blocks - 1) + 24) : 0;
+}
+
+uint64_t tsdb_reader_rows(const tsdb_reader_t* r) {
+    uint64_t rows = 0;
+    for (uint32_t i = 0; i < r->blocks; i++) rows += get_le32(block_at(r, i) + 8);
+    return rows;
+}
+
+/* Decode the time stream and the masked value streams of block b.
+ * Returns the row count, 0 if the block is corrupt. */
+static uint32_t decode_block(tsdb_reader_t* r, const uint8_t* b, uint32_t mask) {
+    uint32_t len = get_le32(b + 4);
+    uint32_t rows = get_le32(b + 8);
+    if (block_crc(b, len) != get_le32(b + 12)) return 0;
+
+    const uint8_t* s = b + block_header_bytes(r->columns);
+    const uint8_t* end = b + len;
+    for (unsigned c = 0; c <= r->columns; c++) {
+        uint32_t bytes = get_le32(b + TSDB_BLOCK_FIXED + 4 * c);
+        if (bytes > (size_t)(end - s)) return 0;
+        bit_reader_t in = {s, bytes, 0};
+        s += bytes;
+
+        if (c == 0) {
+            uint64_t t = get_le64(b + 16);
+            int64_t delta = 0;
+            r->scratch[0] = t;
+            for (uint32_t i = 1; i < rows; i++) {
+                delta += get_time(&in);
+                t += (uint64_t)delta;
+                r->scratch[i] = t;
+            }
+        } else if (mask & (1u << (c - 1))) {
+            uint16_t* v = r->values + (size_t)(c - 1) * TSDB_BLOCK_MAX_ROWS;
+            v[0] = (uint16_t)get_bits(&in, 16);
+            for (uint32_t i = 1; i < rows; i++) v[i] = get_value(&in, v[i - 1]);
+        } else {
+            continue;
+        }
+        if (in.pos > (size_t)bytes * 8) return 0;
+    }
+    return rows;
+}
+
+uint64_t tsdb_reader_scan(tsdb_reader_t* r, uint64_t from_ms, uint64_t to_ms,
+                          uint32_t mask, tsdb_row_fn fn, void* ctx) {
+    uint16_t row[TSDB_MAX_COLUMNS] = {0};
+    uint64_t count = 0;
+
+    /* first block that ends at or after from_ms */
+    uint32_t lo = 0, hi = r->blocks;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (get_le64(block_at(r, mid) + 24) < from_ms) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (uint32_t i = lo; i < r->blocks; i++) {
+        const uint8_t* b = block_at(r, i);
+        if (get_le64(b + 16) > to_ms) break;
+        uint32_t rows = decode_block(r, b, mask);
+        if (rows == 0) {
+            r->corrupt++;
+            continue;
+        }
+        for (uint32_t j = 0; j < rows; j++) {
+            uint64_t t = r->scratch[j];
+            if (t < from_ms) continue;
+            if (t > to_ms) break;
+            for (unsigned c = 0; c < r->columns; c++) {
+                if (mask & (1u << c)) row[c] = r->values[(size_t)c * TSDB_BLOCK_MAX_ROWS + j];
+            }
+            fn(ctx, t, row);
+            count++;
+        }
+    }
+    return count;
+}
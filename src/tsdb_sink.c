@@ -0,0 +1,122 @@
+#include "tsdb_sink.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+int tsdb_sink_start(tsdb_sink_t* s, const tsdb_sink_config_t* cfg) {
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    if (mkdir(cfg->dir, 0755) != 0 && errno != EEXIST) {
+        perror("tsdb mkdir failed");
+        return -1;
+    }
+    return 0;
+}
+
+/* Rows the sensor's rings hold that the file does not, oldest first. A
+ * crash loses the open block, but with a ring file (ring_file.h) the
+ * rings came back with those samples. The newest row is the sample
+ * being published and is left to the caller; rows of failed reads were
+ * never published. ts_ms is that sample's Unix time, which dates the
+ * HAL stamps in the rings. */
+static void backfill(tsdb_writer_t* w, const sensor_ticks_t* t, uint64_t ts_ms) {
+    const sample_ring_t* first = &sensor_ticks_channel(t, 0)->ring;
+    int64_t offset_ms = (int64_t)ts_ms - (int64_t)(t->t_usec / 1000);
+    uint64_t rows = 0;
+
+    for (uint64_t seq = sample_ring_oldest(first); seq + 1 < first->head; seq++) {
+        uint32_t k = (uint32_t)seq & first->mask;
+        uint64_t wall = first->t_ms[k] + (uint64_t)offset_ms;
+        if (wall <= w->t_last || (first->status[k] & SAMPLE_READ_ERROR)) continue;
+
+        uint16_t raw[TSDB_MAX_COLUMNS];
+        for (unsigned i = 0; i < w->columns; i++) raw[i] = sensor_ticks_channel(t, i)->ring.raw[k];
+        tsdb_writer_append(w, wall, raw);
+        rows++;
+    }
+    if (rows) printf("tsdb: %s: %llu rows filled in from the sample history\n", t->name,
+                     (unsigned long long)rows);
+}
+
+/* The sensor's slot, opening its file on the first sample and filling
+ * in what it missed; NULL if the file could not be opened. */
+static tsdb_writer_t* writer_of(tsdb_sink_t* s, const sensor_ticks_t* t,
+                                uint64_t ts_ms) {
+    for (unsigned i = 0; i < s->count; i++) {
+        if (s->sensors[i].ticks == t) return s->sensors[i].ok ? &s->sensors[i].writer : NULL;
+    }
+    if (s->count == TSDB_SINK_MAX_SENSORS) return NULL;
+
+    unsigned i = s->count++;
+    s->sensors[i].ticks = t;
+
+    tsdb_column_t columns[TSDB_MAX_COLUMNS];
+    unsigned count = t->count < TSDB_MAX_COLUMNS ? t->count : TSDB_MAX_COLUMNS;
+    memset(columns, 0, sizeof(columns));
+    for (unsigned c = 0; c < count; c++) {
+        const sample_channel_t* ch = sensor_ticks_channel(t, c);
+        snprintf(columns[c].field, sizeof(columns[c].field), "%s", ch->field);
+        columns[c].scale = ch->scale;
+        columns[c].decimals = ch->decimals;
+        columns[c].flags = ch->flags;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.tsdb", s->cfg.dir, t->name);
+    if (tsdb_writer_open(&s->sensors[i].writer, path, columns, count,
+                         s->cfg.block_ms) != 0) {
+        if (errno == EINVAL)
+            fprintf(stderr, "%s: written with other channels; move it away to start a new one\n",
+                    path);
+        else
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if (s->sensors[i].writer.damaged)
+        fprintf(stderr, "%s: %llu damaged bytes left in place and skipped\n", path,
+                (unsigned long long)s->sensors[i].writer.damaged);
+    s->sensors[i].ok = 1;
+    backfill(&s->sensors[i].writer, t, ts_ms);
+    return &s->sensors[i].writer;
+}
+
+static void tsdb_sample(sample_sink_t* sink, const sensor_ticks_t* t,
+                        uint64_t ts_ms) {
+    tsdb_sink_t* s = sink->state;
+    tsdb_writer_t* w = writer_of(s, t, ts_ms);
+    if (!w) return;
+
+    uint16_t raw[TSDB_MAX_COLUMNS];
+    for (unsigned i = 0; i < w->columns; i++) raw[i] = sensor_ticks_raw(t, i);
+    if (tsdb_writer_append(w, ts_ms, raw) != 0)
+        fprintf(stderr, "tsdb: %s: block write failed: %s\n", t->name, strerror(errno));
+}
+
+static void tsdb_stop(sample_sink_t* sink) {
+    tsdb_sink_t* s = sink->state;
+    tsdb_stats_t total = {0};
+
+    for (unsigned i = 0; i < s->count; i++) {
+        if (!s->sensors[i].ok) continue;
+        tsdb_writer_t* w = &s->sensors[i].writer;
+        tsdb_writer_close(w);
+        total.rows += w->stats.rows;
+        total.blocks += w->stats.blocks;
+        total.bytes += w->stats.bytes;
+        total.write_errors += w->stats.write_errors;
+        s->sensors[i].ok = 0;
+    }
+    printf("Store: %llu rows in %llu blocks, %llu bytes (%.1f per row), %llu lost\n",
+           (unsigned long long)total.rows, (unsigned long long)total.blocks,
+           (unsigned long long)total.bytes,
+           total.rows ? (double)total.bytes / (double)total.rows : 0.0,
+           (unsigned long long)total.write_errors);
+}
+
+const sample_sink_ops_t tsdb_sink_ops = {
+    .name = "tsdb",
+    .sample = tsdb_sample,
+    .stop = tsdb_stop,
+};